@@ -0,0 +1,794 @@
+/**
+ * @file    benchmark.ino
+ * @brief   Measures the throughput of the trng library on Arduino UNO R4.
+ *
+ * Each benchmark runs once from setup() and prints its results to Serial.
+ */
+#include <trng.h>
+#include <trng_delay.h>
+#include <trng_fast.h>
+#include <trng_mask.h>
+#include <trng_prime.h>
+#include <trng_random_device.h>
+#define TRNG_REPLACE_RANDOM
+#include <trng_random.h>
+
+/**
+ * @brief  Print a rate in units per second from a count and elapsed time.
+ */
+static void printRate(const char *label, uint32_t count, uint32_t us, const char *unit) {
+    Serial.print(label);
+    Serial.print(" : ");
+    Serial.print(((float)count * 1000000.0F) / (float)us, 0);
+    Serial.print(' ');
+    Serial.println(unit);
+}
+
+/**
+ * @brief  Bernoulli bit masks: fillBernoulli() versus one randomRange() per bit.
+ */
+static void benchBernoulli() {
+    static const float probs[] = { 0.5F, 0.25F, 0.1F, 0.01F, 0.001F };
+    uint32_t mask[64U];
+    uint32_t start;
+    uint32_t us;
+
+    Serial.println("Bernoulli masks");
+
+    for (size_t k = 0U; k < (sizeof(probs) / sizeof(probs[0U])); k++) {
+        uint32_t p = TRNG_PROBABILITY(probs[k]);
+        start = micros();
+        for (uint32_t n = 0U; n < 16U; n++) {
+            (void)TRNG.fillBernoulli(mask, 64U, p);
+        }
+        us = micros() - start;
+        Serial.print("  p = ");
+        Serial.print(probs[k], 3);
+        printRate("  fillBernoulli", 16U * 64U * 32U, us, "bits/s");
+    }
+
+    /* Baseline: one bounded draw per bit (p = 0.01). */
+    uint32_t hits = 0U;
+    start = micros();
+    for (uint32_t n = 0U; n < 2048U; n++) {
+        uint32_t v;
+        if (TRNG.randomRange(&v, 0U, 99U) && (v == 0U)) {
+            hits++;
+        }
+    }
+    us = micros() - start;
+    printRate("  randomRange per bit", 2048U, us, "bits/s");
+    (void)hits;
+    Serial.println();
+}
+
+/**
+ * @brief  UUID generation and formatting: batched API versus read128() + sprintf().
+ */
+static void benchUuid() {
+    uint8_t uuids[16U * TRNG_UUID_SIZE];
+    char text[16U * TRNG_UUID_STR_SIZE];
+    uint32_t start;
+    uint32_t us;
+
+    Serial.println("UUIDs");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 16U; n++) {
+        (void)TRNG.uuid4(uuids, 16U);
+        (void)TRNG.uuidToString(text, uuids, 16U);
+    }
+    us = micros() - start;
+    printRate("  uuid4 + uuidToString", 256U, us, "UUIDs/s");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 16U; n++) {
+        (void)TRNG.uuid7(uuids, 16U, (uint64_t)millis());
+        (void)TRNG.uuidToString(text, uuids, 16U);
+    }
+    us = micros() - start;
+    printRate("  uuid7 + uuidToString", 256U, us, "UUIDs/s");
+
+    /* Baseline: one hardware read and one sprintf per UUID. */
+    start = micros();
+    for (uint32_t n = 0U; n < 256U; n++) {
+        uint32_t r[4U];
+        if (TRNG.read128(r)) {
+            r[1U] = (r[1U] & 0xFFFF0FFFUL) | 0x00004000UL;
+            r[2U] = (r[2U] & 0x3FFFFFFFUL) | 0x80000000UL;
+            sprintf(text, "%08lx-%04lx-%04lx-%04lx-%04lx%08lx",
+                (unsigned long)r[0U], (unsigned long)(r[1U] >> 16U),
+                (unsigned long)(r[1U] & 0xFFFFU), (unsigned long)(r[2U] >> 16U),
+                (unsigned long)(r[2U] & 0xFFFFU), (unsigned long)r[3U]);
+        }
+    }
+    us = micros() - start;
+    printRate("  read128 + sprintf", 256U, us, "UUIDs/s");
+    Serial.print("  sample : ");
+    Serial.println(text);
+    Serial.println();
+}
+
+/**
+ * @brief  Tokens: randomString() versus one randomRange() per character.
+ */
+static void benchString() {
+    static const char base62[] =
+        "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    static const char base64url[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    char token[65U];
+    uint32_t start;
+    uint32_t us;
+
+    Serial.println("Random strings");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 64U; n++) {
+        (void)TRNG.randomString(token, 64U, base64url, 64U);
+    }
+    us = micros() - start;
+    printRate("  randomString base64url", 64U * 64U, us, "chars/s");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 64U; n++) {
+        (void)TRNG.randomString(token, 64U, base62, 62U);
+    }
+    us = micros() - start;
+    printRate("  randomString base62", 64U * 64U, us, "chars/s");
+
+    /* Baseline: one bounded draw per character. */
+    start = micros();
+    for (uint32_t n = 0U; n < 64U; n++) {
+        for (size_t i = 0U; i < 64U; i++) {
+            uint32_t v = 0U;
+            (void)TRNG.randomRange(&v, 0U, 61U);
+            token[i] = base62[v];
+        }
+        token[64U] = '\0';
+    }
+    us = micros() - start;
+    printRate("  randomRange per char", 64U * 64U, us, "chars/s");
+    Serial.println();
+}
+
+/**
+ * @brief  Hex and base64 encoding: fillHex()/fillBase64() versus
+ *         fillRandom() + sprintf("%02X") per byte.
+ */
+static void benchEncode() {
+    uint8_t key[32U];
+    char hex[TRNG_HEX_LEN(32U)];
+    char b64[TRNG_BASE64_LEN(32U)];
+    uint32_t start;
+    uint32_t us;
+
+    Serial.println("Hex / base64 encoding");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 64U; n++) {
+        (void)TRNG.fillHex(hex, sizeof(key));
+    }
+    us = micros() - start;
+    printRate("  fillHex", 64U * 32U, us, "bytes/s");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 64U; n++) {
+        (void)TRNG.fillBase64(b64, sizeof(key));
+    }
+    us = micros() - start;
+    printRate("  fillBase64", 64U * 32U, us, "bytes/s");
+
+    /* Baseline: the pattern used by the random example. */
+    start = micros();
+    for (uint32_t n = 0U; n < 64U; n++) {
+        if (TRNG.fillRandom(key, sizeof(key))) {
+            for (size_t i = 0U; i < sizeof(key); i++) {
+                sprintf(&hex[2U * i], "%02X", key[i]);
+            }
+        }
+    }
+    us = micros() - start;
+    printRate("  fillRandom + sprintf", 64U * 32U, us, "bytes/s");
+    Serial.println();
+}
+
+/**
+ * @brief  Print sink that discards its input, to time the producer side only.
+ */
+class NullPrint : public Print {
+public:
+    size_t write(uint8_t) override { return 1U; }
+    size_t write(const uint8_t *, size_t size) override { return size; }
+};
+
+/**
+ * @brief  Packet fields: fillRandomV() versus one fillRandom() per field.
+ */
+static void benchFillV() {
+    uint8_t nonce[12U];
+    uint8_t iv[16U];
+    uint8_t pad[5U];
+    uint8_t salt[8U];
+    const trng_iovec fields[] = {
+        { nonce, sizeof(nonce) }, { iv, sizeof(iv) }, { pad, sizeof(pad) }, { salt, sizeof(salt) },
+    };
+    const size_t count = sizeof(fields) / sizeof(fields[0]);
+    size_t total = 0U;
+    uint32_t seqReads = 0U;
+    uint32_t start;
+    uint32_t us;
+
+    for (size_t k = 0U; k < count; k++) {
+        total += fields[k].len;
+        seqReads += (uint32_t)((fields[k].len + 15U) / 16U);
+    }
+
+    Serial.println("Scatter-gather packet fill (12+16+5+8 bytes)");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 1024U; n++) {
+        (void)TRNG.fillRandomV(fields, count);
+    }
+    us = micros() - start;
+    printRate("  fillRandomV", 1024U, us, "packets/s");
+    Serial.print("    hardware reads/packet : ");
+    Serial.println((float)total / 16.0F, 2);
+
+    /* Baseline: one call, and one partly wasted block, per field. */
+    start = micros();
+    for (uint32_t n = 0U; n < 1024U; n++) {
+        for (size_t k = 0U; k < count; k++) {
+            (void)TRNG.fillRandom((uint8_t *)fields[k].base, fields[k].len);
+        }
+    }
+    us = micros() - start;
+    printRate("  fillRandom per field", 1024U, us, "packets/s");
+    Serial.print("    hardware reads/packet : ");
+    Serial.println(seqReads);
+    Serial.println();
+}
+
+/**
+ * @brief  In-place masking: xorRandom() / xorInto() versus a fill into a
+ *         temporary buffer and a second XOR loop.
+ */
+static void benchXor() {
+    static uint8_t buf[1024U];
+    static uint8_t tmp[1024U];
+    trngXoshiro xoshiro;
+    uint32_t start;
+    uint32_t us;
+
+    Serial.println("XOR masking (1 KiB buffers)");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 16U; n++) {
+        (void)TRNG.xorRandom(buf, sizeof(buf));
+    }
+    us = micros() - start;
+    printRate("  xorRandom", 16U * sizeof(buf), us, "bytes/s");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 16U; n++) {
+        if (TRNG.fillRandom(tmp, sizeof(tmp))) {
+            for (size_t k = 0U; k < sizeof(buf); k++) {
+                buf[k] ^= tmp[k];
+            }
+        }
+    }
+    us = micros() - start;
+    printRate("  fillRandom + XOR loop", 16U * sizeof(buf), us, "bytes/s");
+
+    if (xoshiro.begin()) {
+        start = micros();
+        for (uint32_t n = 0U; n < 64U; n++) {
+            xoshiro.xorInto(buf, sizeof(buf));
+        }
+        us = micros() - start;
+        printRate("  xoshiro256** xorInto", 64U * sizeof(buf), us, "bytes/s");
+
+        start = micros();
+        for (uint32_t n = 0U; n < 64U; n++) {
+            xoshiro.fill(tmp, sizeof(tmp));
+            for (size_t k = 0U; k < sizeof(buf); k++) {
+                buf[k] ^= tmp[k];
+            }
+        }
+        us = micros() - start;
+        printRate("  xoshiro256** fill + XOR loop", 64U * sizeof(buf), us, "bytes/s");
+    }
+    Serial.println();
+}
+
+/**
+ * @brief  Masks: trng_maskNext() from a prefilled ring versus random32().
+ */
+static void benchMask() {
+    static uint32_t ring[256U];
+    trng_mask masks;
+    uint32_t sum = 0U;
+    uint32_t start;
+    uint32_t us;
+
+    Serial.println("Mask stream (ring of 256 words)");
+    if (trng_maskInit(&masks, ring, 256U, 64U) != 0U) {
+        Serial.println("  init failed");
+        return;
+    }
+
+    /* Refill between batches, as loop() would, outside the timed part. */
+    us = 0U;
+    for (uint32_t batch = 0U; batch < 64U; batch++) {
+        (void)trng_maskRefill(&masks, 0U);
+        start = micros();
+        for (uint32_t n = 0U; n < 192U; n++) {
+            uint32_t m;
+            if (trng_maskNext(&masks, &m) == 0U) {
+                sum += m;
+            }
+        }
+        us += micros() - start;
+    }
+    printRate("  trng_maskNext", 64U * 192U, us, "masks/s");
+
+    start = micros();
+    for (uint32_t n = 0U; n < (64U * 192U); n++) {
+        uint32_t v;
+        if (TRNG.random32(&v)) {
+            sum += v;
+        }
+    }
+    us = micros() - start;
+    printRate("  TRNG random32", 64U * 192U, us, "masks/s");
+    Serial.print("  underflows : ");
+    Serial.println(masks.underflows);
+    trng_maskFree(&masks);
+    (void)sum;
+    Serial.println();
+}
+
+/**
+ * @brief  Print min / mean / max of per-call DWT cycle counts.
+ */
+static void printCycles(const char *label, uint32_t minC, uint32_t sum, uint32_t maxC, uint32_t n) {
+    Serial.print(label);
+    Serial.print(" : min ");
+    Serial.print(minC);
+    Serial.print(" / mean ");
+    Serial.print(sum / n);
+    Serial.print(" / max ");
+    Serial.print(maxC);
+    Serial.println(" cycles");
+}
+
+/**
+ * @brief  Random delays: sampler overhead in DWT cycles versus random32(),
+ *         and the cost of one trng_delaySpin() iteration.
+ */
+static void benchDelay() {
+    trng_delay jitter;
+    uint32_t minC = 0xFFFFFFFFU;
+    uint32_t maxC = 0U;
+    uint32_t sum = 0U;
+    uint32_t sink = 0U;
+
+    Serial.println("Random delays (DWT cycles per call)");
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0U;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    if (trng_delayInit(&jitter, 6U, TRNG_DELAY_TRIANGLE) != 0U) {
+        Serial.println("  init failed");
+        return;
+    }
+
+    for (uint32_t n = 0U; n < 4096U; n++) {
+        uint32_t v = 0U;
+        uint32_t c0 = DWT->CYCCNT;
+        (void)trng_delaySample(&jitter, &v);
+        uint32_t c = DWT->CYCCNT - c0;
+        sink += v;
+        sum += c;
+        minC = (c < minC) ? c : minC;
+        maxC = (c > maxC) ? c : maxC;
+    }
+    printCycles("  trng_delaySample", minC, sum, maxC, 4096U);
+
+    /* Same draws after a refill: no hardware read inside the section. */
+    minC = 0xFFFFFFFFU;
+    maxC = 0U;
+    sum = 0U;
+    for (uint32_t batch = 0U; batch < 512U; batch++) {
+        (void)trng_delayRefill(&jitter);
+        for (uint32_t n = 0U; n < 8U; n++) {
+            uint32_t v = 0U;
+            uint32_t c0 = DWT->CYCCNT;
+            (void)trng_delaySample(&jitter, &v);
+            uint32_t c = DWT->CYCCNT - c0;
+            sink += v;
+            sum += c;
+            minC = (c < minC) ? c : minC;
+            maxC = (c > maxC) ? c : maxC;
+        }
+    }
+    printCycles("  after trng_delayRefill", minC, sum, maxC, 4096U);
+
+    minC = 0xFFFFFFFFU;
+    maxC = 0U;
+    sum = 0U;
+    for (uint32_t n = 0U; n < 4096U; n++) {
+        uint32_t v = 0U;
+        uint32_t c0 = DWT->CYCCNT;
+        (void)TRNG.random32(&v);
+        uint32_t c = DWT->CYCCNT - c0;
+        sink += v & 63U;
+        sum += c;
+        minC = (c < minC) ? c : minC;
+        maxC = (c > maxC) ? c : maxC;
+    }
+    printCycles("  TRNG random32", minC, sum, maxC, 4096U);
+
+    uint32_t c0 = DWT->CYCCNT;
+    trng_delaySpin(0U);
+    uint32_t spin0 = DWT->CYCCNT - c0;
+    c0 = DWT->CYCCNT;
+    trng_delaySpin(1024U);
+    uint32_t spin1024 = DWT->CYCCNT - c0;
+    Serial.print("  trng_delaySpin : ");
+    Serial.print((float)(spin1024 - spin0) / 1024.0F, 2);
+    Serial.println(" cycles/iteration");
+    (void)sink;
+    Serial.println();
+}
+
+/**
+ * @brief  true if 0 < x < order, both TRNG_SCALAR_WORDS words.
+ */
+static bool belowOrder(const uint32_t *x, const uint32_t *order) {
+    bool below = false;
+    bool any = false;
+    bool decided = false;
+
+    for (size_t i = TRNG_SCALAR_WORDS; i > 0U; i--) {
+        if (!decided && (x[i - 1U] != order[i - 1U])) {
+            below = (x[i - 1U] < order[i - 1U]);
+            decided = true;
+        }
+        any = any || (x[i - 1U] != 0U);
+    }
+    return below && any;
+}
+
+/**
+ * @brief  ECC scalars: randomScalar*() versus fillRandom() and a full
+ *         compare, rereading all 32 bytes on each rejection.
+ */
+static void benchBelow() {
+    uint32_t k[TRNG_SCALAR_WORDS];
+    uint32_t start;
+    uint32_t us;
+
+    Serial.println("ECC scalars below the group order");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 1024U; n++) {
+        (void)TRNG.randomScalarP256(k);
+    }
+    us = micros() - start;
+    printRate("  randomScalarP256", 1024U, us, "keys/s");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 1024U; n++) {
+        do {
+            (void)TRNG.fillRandom((uint8_t *)k, sizeof(k));
+        } while (!belowOrder(k, trng_orderP256));
+    }
+    us = micros() - start;
+    printRate("  P-256 fill + compare", 1024U, us, "keys/s");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 1024U; n++) {
+        (void)TRNG.randomScalarCurve25519(k);
+    }
+    us = micros() - start;
+    printRate("  randomScalarCurve25519", 1024U, us, "keys/s");
+
+    /* l is just above 2^252: about 15 in 16 full draws are rejected. */
+    start = micros();
+    for (uint32_t n = 0U; n < 1024U; n++) {
+        do {
+            (void)TRNG.fillRandom((uint8_t *)k, sizeof(k));
+        } while (!belowOrder(k, trng_orderCurve25519));
+    }
+    us = micros() - start;
+    printRate("  Curve25519 fill + compare", 1024U, us, "keys/s");
+    Serial.println();
+}
+
+/**
+ * @brief  micros() as the trng_prime phase clock.
+ */
+static uint32_t primeClock() {
+    return micros();
+}
+
+/**
+ * @brief  Primes: time per 256-bit prime with and without the incremental
+ *         sieve, and where the time goes.
+ */
+static void benchPrime() {
+    static trng_prime gen;
+    static const uint16_t sieves[] = { 0U, TRNG_PRIME_SIEVE };
+    uint32_t p[8];
+
+    Serial.println("256-bit probable primes");
+    for (size_t s = 0U; s < (sizeof(sieves) / sizeof(sieves[0])); s++) {
+        (void)trng_primeInit(&gen, sieves[s], primeClock);
+        uint32_t start = micros();
+        for (uint32_t n = 0U; n < 8U; n++) {
+            (void)trng_primeGenerate(&gen, p, 256U, 0U);
+        }
+        uint32_t us = micros() - start;
+        uint32_t total = gen.stats.timeDraw + gen.stats.timeSieve + gen.stats.timeTest;
+        Serial.print("  sieve ");
+        Serial.print(sieves[s]);
+        Serial.print(" : ");
+        Serial.print(us / 8000U);
+        Serial.print(" ms/prime, ");
+        Serial.print(gen.stats.tested / 8U);
+        Serial.print(" tested, draw ");
+        Serial.print((100U * gen.stats.timeDraw) / total);
+        Serial.print("% / sieve ");
+        Serial.print((100U * gen.stats.timeSieve) / total);
+        Serial.print("% / Miller-Rabin ");
+        Serial.print((100U * gen.stats.timeTest) / total);
+        Serial.println("%");
+    }
+    trng_primeWipe(&gen);
+    for (size_t i = 0U; i < 8U; i++) {
+        p[i] = 0U;
+    }
+    Serial.println();
+}
+
+/**
+ * @brief  Streaming: writeTo() versus fillRandom() into a buffer + write().
+ */
+static void benchWriteTo() {
+    NullPrint sink;
+    uint8_t buf[64U];
+    uint32_t start;
+    uint32_t us;
+
+    Serial.println("Streaming to a Print sink");
+
+    start = micros();
+    size_t sent = TRNG.writeTo(sink, 16384U);
+    us = micros() - start;
+    printRate("  writeTo", (uint32_t)sent, us, "bytes/s");
+
+    /* Baseline: stage through a user buffer. */
+    start = micros();
+    for (uint32_t n = 0U; n < (16384U / sizeof(buf)); n++) {
+        if (TRNG.fillRandom(buf, sizeof(buf))) {
+            (void)sink.write(buf, sizeof(buf));
+        }
+    }
+    us = micros() - start;
+    printRate("  fillRandom + write", 16384U, us, "bytes/s");
+    Serial.println();
+}
+
+/**
+ * @brief  Philox4x32-10 keyed by the TRNG: sequential fill, random access,
+ *         and fillRandom() for the same amount of data.
+ */
+static void benchPhilox() {
+    static uint32_t words[256U];
+    trng_philox p;
+    uint32_t sum = 0U;
+    uint32_t start;
+    uint32_t us;
+
+    Serial.println("Philox4x32-10");
+    if (!TRNG.philoxSeed(&p)) {
+        Serial.println("  philoxSeed failed");
+        return;
+    }
+
+    start = micros();
+    for (uint32_t n = 0U; n < 16U; n++) {
+        trng_philoxFill(&p, (uint64_t)n * 256U, words, 256U);
+    }
+    us = micros() - start;
+    printRate("  philoxFill", (uint32_t)(16U * sizeof(words)), us, "bytes/s");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 1024U; n++) {
+        sum += trng_philoxAt(&p, (uint64_t)n * 7919U);
+    }
+    us = micros() - start;
+    printRate("  philoxAt (random access)", 1024U, us, "words/s");
+
+    /* Baseline: the same amount of data straight from the TRNG. */
+    start = micros();
+    for (uint32_t n = 0U; n < 16U; n++) {
+        (void)TRNG.fillRandom(reinterpret_cast<uint8_t *>(words), sizeof(words));
+    }
+    us = micros() - start;
+    printRate("  fillRandom", (uint32_t)(16U * sizeof(words)), us, "bytes/s");
+    (void)sum;
+    Serial.println();
+}
+
+/**
+ * @brief  Fast tier: xoshiro256** and PCG32 versus random32() from the TRNG.
+ */
+static void benchFast() {
+    static uint8_t buf[1024U];
+    trngXoshiro xoshiro;
+    trngPcg pcg;
+    uint32_t sum = 0U;
+    uint32_t start;
+    uint32_t us;
+
+    Serial.println("Fast tier (not cryptographic)");
+    if (!xoshiro.begin() || !pcg.begin()) {
+        Serial.println("  seeding failed");
+        return;
+    }
+
+    start = micros();
+    for (uint32_t n = 0U; n < 16384U; n++) {
+        sum += xoshiro.next32();
+    }
+    us = micros() - start;
+    printRate("  xoshiro256** next32", 16384U, us, "words/s");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 16384U; n++) {
+        sum += pcg.next32();
+    }
+    us = micros() - start;
+    printRate("  pcg32 next32", 16384U, us, "words/s");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 16U; n++) {
+        xoshiro.fill(buf, sizeof(buf));
+    }
+    us = micros() - start;
+    printRate("  xoshiro256** fill", (uint32_t)(16U * sizeof(buf)), us, "bytes/s");
+
+    /* Baseline: one hardware read per word. */
+    start = micros();
+    for (uint32_t n = 0U; n < 1024U; n++) {
+        uint32_t v;
+        if (TRNG.random32(&v)) {
+            sum += v;
+        }
+    }
+    us = micros() - start;
+    printRate("  TRNG random32", 1024U, us, "words/s");
+    (void)sum;
+    Serial.println();
+}
+
+/**
+ * @brief  Arduino random() through trng_random.h versus the core generator.
+ *
+ * The sketch replaces random(), so the core's random(max) is reproduced
+ * with rand(), which runs the same C library generator.
+ */
+static void benchRandom() {
+    static const long ranges[] = { 6L, 1000L, 100000L };
+    uint32_t sum = 0U;
+    uint32_t start;
+    uint32_t us;
+
+    Serial.println("Arduino random()");
+
+    for (size_t k = 0U; k < (sizeof(ranges) / sizeof(ranges[0U])); k++) {
+        Serial.print("  max = ");
+        Serial.println(ranges[k]);
+
+        start = micros();
+        for (uint32_t n = 0U; n < 16384U; n++) {
+            sum += (uint32_t)random(ranges[k]);
+        }
+        us = micros() - start;
+        printRate("    TRNG random(max)", 16384U, us, "values/s");
+
+        start = micros();
+        for (uint32_t n = 0U; n < 16384U; n++) {
+            sum += (uint32_t)(rand() % ranges[k]);
+        }
+        us = micros() - start;
+        printRate("    core random(max)", 16384U, us, "values/s");
+    }
+
+    start = micros();
+    for (uint32_t n = 0U; n < 16384U; n++) {
+        sum += (uint32_t)random(-50L, 50L);
+    }
+    us = micros() - start;
+    printRate("  TRNG random(min, max)", 16384U, us, "values/s");
+    (void)sum;
+    Serial.println();
+}
+
+/**
+ * @brief  trng::random_device (prefetch buffer) versus random32() per value.
+ */
+static void benchRandomDevice() {
+    trng::random_device rd;
+    uint32_t sum = 0U;
+    uint32_t start;
+    uint32_t us;
+
+    Serial.println("trng::random_device");
+
+    start = micros();
+    for (uint32_t n = 0U; n < 16384U; n++) {
+        sum += rd();
+    }
+    us = micros() - start;
+    printRate("  random_device()", 16384U, us, "words/s");
+
+    /* Baseline: one hardware read per word. */
+    start = micros();
+    for (uint32_t n = 0U; n < 16384U; n++) {
+        uint32_t v;
+        if (TRNG.random32(&v)) {
+            sum += v;
+        }
+    }
+    us = micros() - start;
+    printRate("  TRNG random32", 16384U, us, "words/s");
+
+    /* Fill one estimation window, then report. */
+    for (uint32_t n = 0U; n < (TRNG_DEVICE_WINDOW / 4U); n++) {
+        sum += rd();
+    }
+    Serial.print("  entropy() : ");
+    Serial.print(rd.entropy(), 2);
+    Serial.println(" bits/word");
+    (void)sum;
+    Serial.println();
+}
+
+/**
+ * @brief  Initialize serial and TRNG hardware, then run every benchmark.
+ */
+void setup() {
+    Serial.begin(115200UL);
+    while (!Serial);
+
+    if (!TRNG.begin()) {
+        Serial.println("TRNG init failed!");
+        while (1U);
+    }
+
+    Serial.println("TRNG benchmark\n");
+    benchBernoulli();
+    benchUuid();
+    benchString();
+    benchEncode();
+    benchFillV();
+    benchXor();
+    benchMask();
+    benchDelay();
+    benchBelow();
+    benchPrime();
+    benchWriteTo();
+    benchPhilox();
+    benchFast();
+    benchRandom();
+    benchRandomDevice();
+    Serial.println("Done.");
+}
+
+/**
+ * @brief  Nothing to do: all benchmarks run once from setup().
+ */
+void loop() {
+}
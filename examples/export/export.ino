@@ -0,0 +1,40 @@
+/**
+ * @file    export.ino
+ * @brief   Streams framed TRNG output over Serial for a host receiver.
+ *
+ * Run extras/host/trng_recv on the host to verify the frames and write the
+ * entropy to a file, e.g. `trng_recv -o entropy.bin /dev/ttyACM0`, or
+ * extras/host/trng_capture to record a capture file for analysis.
+ *
+ * A device information frame is sent every INFO_EVERY entropy frames.
+ */
+#include <trng.h>
+
+/** @brief Entropy frames between two device information frames. */
+#define INFO_EVERY  1024U
+
+/** @brief Entropy frames sent since the last information frame. */
+static uint32_t sent = INFO_EVERY;
+
+/**
+ * @brief  Initialize serial and TRNG hardware; halts on failure.
+ */
+void setup() {
+    Serial.begin(115200UL);
+    while (!Serial);
+
+    if (!TRNG.begin()) {
+        while (1U);
+    }
+}
+
+/**
+ * @brief  Send frames continuously.
+ */
+void loop() {
+    if (sent >= INFO_EVERY) {
+        (void)TRNG.writeInfoFrame(Serial, millis());
+        sent = 0U;
+    }
+    sent += (uint32_t)TRNG.writeFrames(Serial, 16U);
+}
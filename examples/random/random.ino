@@ -26,12 +26,8 @@ void setup() {
 void loop() {
 	
     /* 128-bit hex string */
-    uint32_t rnd[4U];
-    if (TRNG.read128(rnd)) {
-        char s[33U] = {0};
-        sprintf(s, "%08lX%08lX%08lX%08lX",
-            (unsigned long)rnd[0U], (unsigned long)rnd[1U],
-            (unsigned long)rnd[2U], (unsigned long)rnd[3U]);
+    char s[TRNG_HEX_LEN(16U)];
+    if (TRNG.fillHex(s, 16U)) {
         Serial.print("128-bit : ");
         Serial.println(s);
     }
@@ -68,13 +64,21 @@ void loop() {
     if (TRNG.fillRandom(key, sizeof(key))) {
         Serial.print("Key     : ");
         for (size_t i = 0U; i < sizeof(key); i++) {
-            char hex[3U];
-            sprintf(hex, "%02X", key[i]);
-            Serial.print(hex);
+            if (key[i] < 0x10U) {
+                Serial.print('0');
+            }
+            Serial.print(key[i], HEX);
         }
         Serial.println();
     }
 	
+    /* Base64 token */
+    char b64[TRNG_BASE64_LEN(24U)];
+    if (TRNG.fillBase64(b64, 24U)) {
+        Serial.print("Base64  : ");
+        Serial.println(b64);
+    }
+	
     Serial.println();
     delay(1000UL);
 }
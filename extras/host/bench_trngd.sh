@@ -0,0 +1,26 @@
+#!/bin/sh
+# Aggregate trngd throughput as the number of simulated boards grows.
+#
+# Usage: bench_trngd.sh [rate_per_board_bytes_per_s] [board counts...]
+# Expects trng_sim, trngd and trng_client built in the current directory.
+set -e
+
+RATE=${1:-1000000}
+shift 2>/dev/null || true
+COUNTS=${*:-"1 2 4 8 16 32"}
+SOCK=/tmp/trngd_bench.$$.sock
+
+for N in $COUNTS; do
+    ./trng_sim -n "$N" -r "$RATE" > /tmp/trngd_bench.$$.ptys &
+    SIM=$!
+    sleep 0.3
+    # shellcheck disable=SC2046
+    ./trngd -s "$SOCK" $(cat /tmp/trngd_bench.$$.ptys) 2>/dev/null &
+    DAEMON=$!
+    sleep 0.3
+    printf '%3d boards: ' "$N"
+    ./trng_client -s "$SOCK" -n $((N * RATE * 3)) -r 65536 -q 2>&1 | sed 's/^trng_client: //'
+    kill "$DAEMON" "$SIM"
+    wait "$DAEMON" "$SIM" 2>/dev/null || true
+done
+rm -f /tmp/trngd_bench.$$.ptys
@@ -0,0 +1,21 @@
+/*******************************************************************************
+ * @file    bsp_api.h
+ * @brief   Host stand-in for the FSP header of the same name.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef BSP_API_H
+#define BSP_API_H
+
+#include <stdint.h>
+
+/** @brief 128-bit MCU unique ID. */
+typedef union {
+    uint32_t unique_id_words[4];
+    uint8_t  unique_id_bytes[16];
+} bsp_unique_id_t;
+
+/** @brief The MCU unique ID. */
+bsp_unique_id_t const *R_BSP_UniqueIdGet(void);
+
+#endif /* BSP_API_H */
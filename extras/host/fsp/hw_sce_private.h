@@ -0,0 +1,27 @@
+/*******************************************************************************
+ * @file    hw_sce_private.h
+ * @brief   Host stand-in for the FSP header of the same name.
+ *
+ * Declares only what src/trng.c uses, so that the library builds on a
+ * host with the SCE5 functions supplied by the tool that links it.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef HW_SCE_PRIVATE_H
+#define HW_SCE_PRIVATE_H
+
+#include <stdint.h>
+
+/** @brief FSP status code. */
+typedef int fsp_err_t;
+
+/** @brief Success status. */
+#define FSP_SUCCESS 0
+
+/** @brief Power the SCE5 on. */
+void HW_SCE_PowerOn(void);
+
+/** @brief Initialize the SCE5. */
+fsp_err_t HW_SCE_McuSpecificInit(void);
+
+#endif /* HW_SCE_PRIVATE_H */
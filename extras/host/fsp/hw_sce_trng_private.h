@@ -0,0 +1,15 @@
+/*******************************************************************************
+ * @file    hw_sce_trng_private.h
+ * @brief   Host stand-in for the FSP header of the same name.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef HW_SCE_TRNG_PRIVATE_H
+#define HW_SCE_TRNG_PRIVATE_H
+
+#include "hw_sce_private.h"
+
+/** @brief Read 128 conditioned bits into @p out (4 words). */
+fsp_err_t HW_SCE_RNG_Read(uint32_t *out);
+
+#endif /* HW_SCE_TRNG_PRIVATE_H */
@@ -0,0 +1,89 @@
+#!/bin/sh
+# End-to-end test of the frame export over a pseudo-terminal pair.
+#
+# trng_sim plays a board on a pty and sends a fixed number of frames with
+# every n-th frame dropped, corrupted or truncated, after a first run cut
+# short by a simulated reset at sequence number reset_at (0: no reset);
+# trng_recv decodes the other end. The expected frame, lost, resync and
+# output counts are derived from the same schedule and compared with what
+# trng_recv reports.
+#
+# Usage: test_recv.sh [frames] [payload] [reset_at]
+# Expects trng_sim and trng_recv built in the current directory.
+set -e
+
+FRAMES=${1:-5000}
+PAYLOAD=${2:-256}
+RESET=${3:-$((FRAMES * 2 / 5))}
+DROP=97
+CORRUPT=89
+TRUNCATE=83
+TMP=/tmp/test_recv.$$
+
+# Replay the trng_sim schedule: info every 1025th frame, then drop,
+# truncate, corrupt in that order of precedence.
+set -- $(awk -v f="$FRAMES" -v r="$RESET" -v d=$DROP -v x=$CORRUPT -v t=$TRUNCATE '
+function kind(s) {
+    if (s % 1025 == 0) { return "info" }
+    if (s % d == 0) { return "drop" }
+    if (s % t == 0 || s % x == 0) { return "crc" }
+    return "good"
+}
+# Count the frames of one run up to its last frame that trng_recv decodes:
+# bad frames after it are not lost, the numbering restarts or the stream
+# ends there.
+function run(count, goodOnly,   s, last) {
+    last = -1
+    for (s = 0; s < count; s++) {
+        if (kind(s) == "good" || (!goodOnly && kind(s) == "info")) { last = s }
+    }
+    for (s = 0; s <= last; s++) {
+        n[kind(s)]++
+    }
+}
+BEGIN {
+    if (r > 0) { run(r, 0) }
+    # trng_recv stops after the last good frame: later frames are unseen.
+    run(f, 1)
+    print n["good"] + 0, n["info"] + 0, n["drop"] + n["crc"], n["crc"] + 0, (r > 0) ? 1 : 0
+}')
+GOOD=$1 INFO=$2 LOST=$3 CRC=$4 RESYNCS=$5
+BYTES=$((GOOD * PAYLOAD))
+
+./trng_sim -w -f "$FRAMES" -p "$PAYLOAD" -d $DROP -x $CORRUPT -t $TRUNCATE -R "$RESET" > "$TMP.pty" &
+SIM=$!
+trap 'kill $SIM 2>/dev/null; rm -f "$TMP.pty" "$TMP.out" "$TMP.log"' EXIT
+sleep 0.3
+timeout 20 ./trng_recv -n "$BYTES" -o "$TMP.out" "$(cat "$TMP.pty")" 2> "$TMP.log" &
+RECV=$!
+sleep 0.3
+kill -USR1 $SIM
+STATUS=0
+wait $RECV || STATUS=$?
+cat "$TMP.log"
+
+# trng_recv: F frames, B bytes written, C CRC errors, L lost frames, G flagged frames, I info frames, R resyncs, ...
+set -- $(sed -n 's/^trng_recv: \([0-9]*\) frames, \([0-9]*\) bytes written, \([0-9]*\) CRC errors, \([0-9]*\) lost frames, \([0-9]*\) flagged frames, \([0-9]*\) info frames, \([0-9]*\) resyncs.*/\1 \2 \3 \4 \5 \6 \7/p' "$TMP.log")
+FAIL=0
+check() {
+    if [ "$2" != "$3" ]; then
+        echo "FAIL: $1 is $2, expected $3"
+        FAIL=1
+    fi
+}
+check "exit status" "$STATUS" 0
+check "frames" "${1:-}" $((GOOD + INFO))
+check "bytes written" "${2:-}" "$BYTES"
+check "output size" "$(wc -c < "$TMP.out" 2>/dev/null | tr -d ' ')" "$BYTES"
+check "lost frames" "${4:-}" "$LOST"
+check "flagged frames" "${5:-}" 0
+check "info frames" "${6:-}" "$INFO"
+check "resyncs" "${7:-}" "$RESYNCS"
+# A corrupted or truncated frame costs at least one CRC error; random
+# payload bytes that look like a header can add more.
+if [ "${3:-0}" -lt "$CRC" ]; then
+    echo "FAIL: CRC errors is ${3:-0}, expected at least $CRC"
+    FAIL=1
+fi
+[ $FAIL -eq 0 ] && echo "test_recv: ok ($GOOD good, $INFO info, $LOST lost frames, $RESYNCS resyncs)"
+exit $FAIL
@@ -0,0 +1,930 @@
+/*******************************************************************************
+ * @file    trng_90b.c
+ * @brief   NIST SP 800-90B non-IID min-entropy estimators (section 6.3).
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_90b.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** @brief Two-sided 99% normal quantile used by all confidence bounds. */
+#define Z_99            2.576
+/** @brief Minimum count of the most common tuple (6.3.5). */
+#define TUPLE_CUTOFF    35U
+/** @brief Maximum context length of MultiMMC and LZ78Y. */
+#define MAX_CTX         16U
+/** @brief MultiMMC: maximum (context, value) pairs per order. */
+#define MMC_MAX_ENTRIES 100000U
+/** @brief LZ78Y: maximum dictionary size. */
+#define LZ_MAX_DICT     65536U
+/** @brief Lag prediction: number of lags. */
+#define LAG_D           128U
+
+/**
+ * @brief  Upper 99% confidence bound of a proportion (6.3.1 step 2).
+ */
+static double upperBound(double p, size_t len) {
+    double pu = p + (Z_99 * sqrt((p * (1.0 - p)) / (double)(len - 1U)));
+    return (pu < 1.0) ? pu : 1.0;
+}
+
+double trng_90bMcv(const uint8_t *s, size_t len) {
+    size_t count[256];
+    size_t max = 0U;
+    size_t i;
+
+    if (len < 2U) {
+        return TRNG_90B_NA;
+    }
+    (void)memset(count, 0, sizeof(count));
+    for (i = 0U; i < len; i++) {
+        count[s[i]]++;
+    }
+    for (i = 0U; i < 256U; i++) {
+        if (count[i] > max) {
+            max = count[i];
+        }
+    }
+    return -log2(upperBound((double)max / (double)len, len));
+}
+
+double trng_90bCollision(const uint8_t *s, size_t len) {
+    double sum = 0.0;
+    double sum2 = 0.0;
+    double mean;
+    double sigma;
+    double xp;
+    size_t v = 0U;
+    size_t i = 0U;
+
+    /* In a bitstring the first repeat is at the second or third sample. */
+    while ((i + 2U) <= len) {
+        double t;
+        if (s[i] == s[i + 1U]) {
+            t = 2.0;
+        } else if ((i + 3U) <= len) {
+            t = 3.0;
+        } else {
+            break;
+        }
+        sum += t;
+        sum2 += t * t;
+        v++;
+        i += (size_t)t;
+    }
+    if (v < 2U) {
+        return TRNG_90B_NA;
+    }
+    mean = sum / (double)v;
+    sigma = sqrt((sum2 - ((double)v * mean * mean)) / (double)(v - 1U));
+    xp = mean - ((Z_99 * sigma) / sqrt((double)v));
+
+    /* Solve 2 + 2p(1 - p) = xp for p in [0.5, 1]. */
+    if (xp >= 2.5) {
+        return 1.0;
+    }
+    if (xp <= 2.0) {
+        return 0.0;
+    }
+    return -log2((1.0 + sqrt(5.0 - (2.0 * xp))) / 2.0);
+}
+
+double trng_90bMarkov(const uint8_t *s, size_t len) {
+    double c[2][2] = { { 0.0, 0.0 }, { 0.0, 0.0 } };
+    double t[2][2];
+    double p0;
+    double p1;
+    double lp[6];
+    double best;
+    size_t ones = 0U;
+    size_t i;
+    int a;
+
+    if (len < 2U) {
+        return TRNG_90B_NA;
+    }
+    for (i = 0U; i < len; i++) {
+        ones += s[i];
+    }
+    for (i = 1U; i < len; i++) {
+        c[s[i - 1U]][s[i]] += 1.0;
+    }
+    p1 = (double)ones / (double)len;
+    p0 = 1.0 - p1;
+    for (a = 0; a < 2; a++) {
+        double n = c[a][0] + c[a][1];
+        t[a][0] = (n > 0.0) ? (c[a][0] / n) : 0.0;
+        t[a][1] = (n > 0.0) ? (c[a][1] / n) : 0.0;
+    }
+
+    /* Log2 probabilities of the six most likely 128-bit sequences. */
+    lp[0] = log2(p0) + (127.0 * log2(t[0][0]));
+    lp[1] = log2(p0) + (64.0 * log2(t[0][1])) + (63.0 * log2(t[1][0]));
+    lp[2] = log2(p0) + log2(t[0][1]) + (126.0 * log2(t[1][1]));
+    lp[3] = log2(p1) + log2(t[1][0]) + (126.0 * log2(t[0][0]));
+    lp[4] = log2(p1) + (64.0 * log2(t[1][0])) + (63.0 * log2(t[0][1]));
+    lp[5] = log2(p1) + (127.0 * log2(t[1][1]));
+    best = -INFINITY;
+    for (a = 0; a < 6; a++) {
+        if (!isnan(lp[a]) && (lp[a] > best)) {
+            best = lp[a];
+        }
+    }
+    best = -best / 128.0;
+    return (best < 1.0) ? best : 1.0;
+}
+
+/**
+ * @brief  G(z) of 6.3.4 step 6, summed in O(L') by counting how often each
+ *         distance u occurs in the double sum.
+ */
+static double compressionG(double z, size_t d, size_t v) {
+    size_t blocks = d + v;
+    double sum = 0.0;
+    double pw = 1.0;    /* (1 - z)^(u - 1) */
+    size_t u;
+
+    for (u = 1U; u <= blocks; u++) {
+        double lu = log2((double)u);
+        if (u < blocks) {
+            size_t cnt = (u <= d) ? v : (blocks - u);
+            sum += lu * z * z * pw * (double)cnt;
+        }
+        if (u > d) {
+            sum += lu * z * pw;
+        }
+        pw *= 1.0 - z;
+        if (pw < 1e-300) {
+            break;
+        }
+    }
+    return sum / (double)v;
+}
+
+/**
+ * @brief  Expected mean log2 distance for most likely block probability p.
+ */
+static double compressionExpect(double p, size_t d, size_t v) {
+    double q = (1.0 - p) / 63.0;
+    return compressionG(p, d, v) + (63.0 * compressionG(q, d, v));
+}
+
+double trng_90bCompression(const uint8_t *s, size_t len) {
+    const size_t b = 6U;
+    const size_t d = 1000U;
+    size_t dict[64];
+    size_t blocks = len / b;
+    size_t v;
+    double sum = 0.0;
+    double sum2 = 0.0;
+    double mean;
+    double sigma;
+    double xp;
+    double lo;
+    double hi;
+    size_t i;
+    int it;
+
+    if (blocks <= (d + 1U)) {
+        return TRNG_90B_NA;
+    }
+    v = blocks - d;
+    (void)memset(dict, 0, sizeof(dict));
+    for (i = 1U; i <= blocks; i++) {
+        const uint8_t *p = &s[(i - 1U) * b];
+        unsigned sym = ((unsigned)p[0] << 5) | ((unsigned)p[1] << 4) | ((unsigned)p[2] << 3) |
+                       ((unsigned)p[3] << 2) | ((unsigned)p[4] << 1) | (unsigned)p[5];
+        if (i > d) {
+            double l = log2((double)((dict[sym] != 0U) ? (i - dict[sym]) : i));
+            sum += l;
+            sum2 += l * l;
+        }
+        dict[sym] = i;
+    }
+    mean = sum / (double)v;
+    sigma = 0.5907 * sqrt((sum2 / (double)(v - 1U)) - (mean * mean));
+    xp = mean - ((Z_99 * sigma) / sqrt((double)v));
+
+    lo = 1.0 / 64.0;
+    hi = 1.0;
+    if (xp >= compressionExpect(lo, d, v)) {
+        return 1.0;
+    }
+    for (it = 0; it < 40; it++) {
+        double mid = (lo + hi) / 2.0;
+        if (compressionExpect(mid, d, v) > xp) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return -log2(lo) / (double)b;
+}
+
+/**
+ * @brief  Build the suffix array of @p s by prefix doubling.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int suffixArray(const uint8_t *s, uint32_t n, uint32_t *sa, uint32_t *rank) {
+    uint32_t *tmp = malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *cnt = malloc(((size_t)n + 256U) * sizeof(uint32_t));
+    uint32_t classes;
+    uint32_t h;
+    uint32_t i;
+
+    if ((tmp == NULL) || (cnt == NULL)) {
+        free(tmp);
+        free(cnt);
+        return -1;
+    }
+
+    (void)memset(cnt, 0, 256U * sizeof(uint32_t));
+    for (i = 0U; i < n; i++) {
+        cnt[s[i]]++;
+    }
+    for (i = 1U; i < 256U; i++) {
+        cnt[i] += cnt[i - 1U];
+    }
+    for (i = n; i > 0U; i--) {
+        sa[--cnt[s[i - 1U]]] = i - 1U;
+    }
+    rank[sa[0]] = 0U;
+    classes = 1U;
+    for (i = 1U; i < n; i++) {
+        if (s[sa[i]] != s[sa[i - 1U]]) {
+            classes++;
+        }
+        rank[sa[i]] = classes - 1U;
+    }
+
+    for (h = 1U; (classes < n) && (h < n); h *= 2U) {
+        uint32_t j = 0U;
+        /* Order by the second key: suffixes shorter than h come first. */
+        for (i = n - h; i < n; i++) {
+            tmp[j++] = i;
+        }
+        for (i = 0U; i < n; i++) {
+            if (sa[i] >= h) {
+                tmp[j++] = sa[i] - h;
+            }
+        }
+        /* Stable counting sort by the first key. */
+        (void)memset(cnt, 0, (size_t)classes * sizeof(uint32_t));
+        for (i = 0U; i < n; i++) {
+            cnt[rank[i]]++;
+        }
+        for (i = 1U; i < classes; i++) {
+            cnt[i] += cnt[i - 1U];
+        }
+        for (i = n; i > 0U; i--) {
+            sa[--cnt[rank[tmp[i - 1U]]]] = tmp[i - 1U];
+        }
+        /* New classes from (first key, second key). */
+        tmp[sa[0]] = 0U;
+        classes = 1U;
+        for (i = 1U; i < n; i++) {
+            uint32_t a = sa[i - 1U];
+            uint32_t c = sa[i];
+            uint32_t ra = ((a + h) < n) ? (rank[a + h] + 1U) : 0U;
+            uint32_t rc = ((c + h) < n) ? (rank[c + h] + 1U) : 0U;
+            if ((rank[a] != rank[c]) || (ra != rc)) {
+                classes++;
+            }
+            tmp[c] = classes - 1U;
+        }
+        (void)memcpy(rank, tmp, (size_t)n * sizeof(uint32_t));
+    }
+
+    free(tmp);
+    free(cnt);
+    return 0;
+}
+
+int trng_90bTupleLrs(const uint8_t *s, size_t len, double *tTuple, double *lrs) {
+    uint32_t n = (uint32_t)len;
+    uint32_t *sa;
+    uint32_t *rank;
+    uint32_t *lcp;
+    uint32_t maxLcp = 0U;
+    uint32_t t = 0U;
+    uint32_t h = 0U;
+    uint32_t i;
+    uint32_t w;
+    double pTuple = 0.0;
+    double pLrs = 0.0;
+
+    *tTuple = TRNG_90B_NA;
+    *lrs = TRNG_90B_NA;
+    if ((len < 2U) || (len > (size_t)INT32_MAX)) {
+        return 0;
+    }
+    sa = malloc(len * sizeof(uint32_t));
+    rank = malloc(len * sizeof(uint32_t));
+    if ((sa == NULL) || (rank == NULL) || (suffixArray(s, n, sa, rank) != 0)) {
+        free(sa);
+        free(rank);
+        return -1;
+    }
+
+    /* Kasai: lcp[i] is the longest common prefix of sa[i - 1] and sa[i]. */
+    lcp = sa;
+    sa = malloc(len * sizeof(uint32_t));
+    if (sa == NULL) {
+        free(lcp);
+        free(rank);
+        return -1;
+    }
+    (void)memcpy(sa, lcp, len * sizeof(uint32_t));
+    for (i = 0U; i < n; i++) {
+        if (rank[i] == 0U) {
+            h = 0U;
+            lcp[0] = 0U;
+            continue;
+        }
+        {
+            uint32_t j = sa[rank[i] - 1U];
+            while (((i + h) < n) && ((j + h) < n) && (s[i + h] == s[j + h])) {
+                h++;
+            }
+            lcp[rank[i]] = h;
+            if (h > maxLcp) {
+                maxLcp = h;
+            }
+            if (h > 0U) {
+                h--;
+            }
+        }
+    }
+    free(sa);
+    free(rank);
+
+    /*
+     * Suffixes sharing a W-tuple are adjacent in the suffix array, so a run
+     * of r consecutive lcp >= W is a W-tuple that occurs r + 1 times.
+     */
+    for (w = 1U; w <= maxLcp; w++) {
+        uint64_t run = 0U;
+        uint64_t maxRun = 0U;
+        double pairs = 0.0;
+        for (i = 1U; i < n; i++) {
+            if (lcp[i] >= w) {
+                run++;
+                pairs += (double)run;
+                if (run > maxRun) {
+                    maxRun = run;
+                }
+            } else {
+                run = 0U;
+            }
+        }
+        if (((maxRun + 1U) >= TUPLE_CUTOFF) && (w == (t + 1U))) {
+            double p = pow((double)(maxRun + 1U) / (double)(len - w + 1U), 1.0 / (double)w);
+            t = w;
+            if (p > pTuple) {
+                pTuple = p;
+            }
+        } else {
+            double total = ((double)(len - w + 1U) * (double)(len - w)) / 2.0;
+            double p = pow(pairs / total, 1.0 / (double)w);
+            if (p > pLrs) {
+                pLrs = p;
+            }
+        }
+    }
+    free(lcp);
+
+    if (t != 0U) {
+        *tTuple = -log2(upperBound(pTuple, len));
+    }
+    if ((t + 1U) <= maxLcp) {
+        *lrs = -log2(upperBound(pLrs, len));
+    }
+    return 0;
+}
+
+/**
+ * @brief  Natural log of the probability that N trials with success
+ *         probability p contain no run of r successes (6.3.7 step 9).
+ */
+static double logNoRun(double p, double r, double n) {
+    double q = 1.0 - p;
+    double x = 1.0;
+    int i;
+
+    for (i = 0; i < 10; i++) {
+        x = 1.0 + (q * pow(p, r) * pow(x, r + 1.0));
+    }
+    return log(1.0 - (p * x)) - log(((r + 1.0) - (r * x)) * q) - ((n + 1.0) * log(x));
+}
+
+/**
+ * @brief  Min-entropy from a predictor's results (6.3.7 steps 5 to 10).
+ * @param  correct  Number of correct predictions.
+ * @param  n        Number of predictions.
+ * @param  run      Longest run of correct predictions.
+ * @param  k        Alphabet size.
+ */
+static double predictionEntropy(size_t correct, size_t n, size_t run, unsigned k) {
+    double pg = (double)correct / (double)n;
+    double lo = 0.0;
+    double hi = 1.0;
+    double p;
+    int it;
+
+    if (correct == 0U) {
+        pg = 1.0 - pow(0.01, 1.0 / (double)n);
+    } else {
+        pg = upperBound(pg, n);
+    }
+
+    for (it = 0; it < 60; it++) {
+        double mid = (lo + hi) / 2.0;
+        double f = logNoRun(mid, (double)run + 1.0, (double)n);
+        if (isnan(f) || (f < log(0.99))) {
+            hi = mid;
+        } else {
+            lo = mid;
+        }
+    }
+
+    p = (pg > lo) ? pg : lo;
+    if (p < (1.0 / (double)k)) {
+        p = 1.0 / (double)k;
+    }
+    return -log2(p);
+}
+
+/** @brief Running statistics of a predictor. */
+typedef struct {
+    size_t correct;
+    size_t n;
+    size_t run;
+    size_t maxRun;
+} predict_t;
+
+/**
+ * @brief  Record one prediction.
+ */
+static void predictRecord(predict_t *st, int hit) {
+    st->n++;
+    if (hit != 0) {
+        st->correct++;
+        st->run++;
+        if (st->run > st->maxRun) {
+            st->maxRun = st->run;
+        }
+    } else {
+        st->run = 0U;
+    }
+}
+
+double trng_90bMultiMcw(const uint8_t *s, size_t len, unsigned k) {
+    static const size_t w[4] = { 63U, 255U, 1023U, 4095U };
+    uint32_t (*cnt)[256] = calloc(4U, sizeof(*cnt));
+    size_t (*last)[256] = calloc(4U, sizeof(*last));
+    uint32_t modeCount[4] = { 0U, 0U, 0U, 0U };
+    int mode[4] = { -1, -1, -1, -1 };
+    size_t score[4] = { 0U, 0U, 0U, 0U };
+    size_t winner = 0U;
+    predict_t st = { 0U, 0U, 0U, 0U };
+    size_t i;
+    size_t j;
+
+    if ((cnt == NULL) || (last == NULL) || (len <= (w[0] + 1U))) {
+        free(cnt);
+        free(last);
+        return TRNG_90B_NA;
+    }
+
+    for (i = 0U; i < len; i++) {
+        unsigned x = s[i];
+        if (i >= w[0]) {
+            int sub[4];
+            for (j = 0U; j < 4U; j++) {
+                sub[j] = (i >= w[j]) ? mode[j] : -1;
+            }
+            predictRecord(&st, sub[winner] == (int)x);
+            for (j = 0U; j < 4U; j++) {
+                if (sub[j] == (int)x) {
+                    score[j]++;
+                    if (score[j] >= score[winner]) {
+                        winner = j;
+                    }
+                }
+            }
+        }
+        for (j = 0U; j < 4U; j++) {
+            /* Add the new sample; ties go to the most recent value. */
+            cnt[j][x]++;
+            last[j][x] = i;
+            if (cnt[j][x] >= modeCount[j]) {
+                mode[j] = (int)x;
+                modeCount[j] = cnt[j][x];
+            }
+            if (i >= w[j]) {
+                unsigned old = s[i - w[j]];
+                cnt[j][old]--;
+                if ((int)old == mode[j]) {
+                    unsigned y;
+                    modeCount[j] = 0U;
+                    for (y = 0U; y < k; y++) {
+                        if ((cnt[j][y] > modeCount[j]) ||
+                            ((cnt[j][y] == modeCount[j]) && (cnt[j][y] != 0U) &&
+                             (last[j][y] > last[j][mode[j]]))) {
+                            mode[j] = (int)y;
+                            modeCount[j] = cnt[j][y];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    free(cnt);
+    free(last);
+    return predictionEntropy(st.correct, st.n, st.maxRun, k);
+}
+
+double trng_90bLag(const uint8_t *s, size_t len, unsigned k) {
+    size_t score[LAG_D + 1U];
+    size_t winner = 1U;
+    predict_t st = { 0U, 0U, 0U, 0U };
+    size_t i;
+
+    if (len < 3U) {
+        return TRNG_90B_NA;
+    }
+    (void)memset(score, 0, sizeof(score));
+    for (i = 1U; i < len; i++) {
+        size_t dmax = (i < LAG_D) ? i : LAG_D;
+        size_t d;
+        predictRecord(&st, (winner <= i) && (s[i - winner] == s[i]));
+        for (d = 1U; d <= dmax; d++) {
+            if (s[i - d] == s[i]) {
+                score[d]++;
+                if (score[d] >= score[winner]) {
+                    winner = d;
+                }
+            }
+        }
+    }
+    return predictionEntropy(st.correct, st.n, st.maxRun, k);
+}
+
+/** @brief Context table slot. */
+typedef struct {
+    uint64_t a;         /**< Context symbols 0..7, most recent first. */
+    uint64_t b;         /**< Context symbols 8..15. */
+    uint32_t id;        /**< Dense context number. */
+    uint32_t bestCount; /**< Count of the most frequent follower. */
+    uint8_t  len;       /**< Context length, 0 for an empty slot. */
+    uint8_t  best;      /**< Most frequent follower. */
+} ctx_slot;
+
+/**
+ * @brief  Contexts with follower counts.
+ *
+ * For byte samples, contexts live in an open-addressing table and follower
+ * counts in a second table keyed by (context id, value). For bitstrings,
+ * every context of up to 16 bits has a fixed slot, (1 << len) | bits, and
+ * follower counts are a flat array.
+ */
+typedef struct {
+    ctx_slot *slots;    /**< Context slots. */
+    size_t    mask;     /**< Slot table size - 1 (hashed mode). */
+    size_t    used;     /**< Contexts stored. */
+    uint64_t *fKeys;    /**< Follower keys, (id << 8 | value) + 1, 0 = empty. */
+    uint32_t *fCounts;  /**< Follower counts. */
+    size_t    fMask;    /**< Follower table size - 1 (hashed mode). */
+    size_t    fUsed;    /**< Followers stored (hashed mode). */
+    int       dense;    /**< 1 for bitstrings. */
+} ctx_map;
+
+/** @brief Packed context key. */
+typedef struct {
+    uint64_t a;
+    uint64_t b;
+    uint8_t  len;
+} ctx_key;
+
+/**
+ * @brief  Append the next older symbol to a key.
+ */
+static void keyExtend(const ctx_map *m, ctx_key *k, uint8_t sym) {
+    if (m->dense != 0) {
+        k->a |= (uint64_t)sym << k->len;
+    } else if (k->len < 8U) {
+        k->a |= (uint64_t)sym << (8U * k->len);
+    } else {
+        k->b |= (uint64_t)sym << (8U * (k->len - 8U));
+    }
+    k->len++;
+}
+
+/**
+ * @brief  64-bit mix function.
+ */
+static uint64_t mix64(uint64_t h) {
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+/**
+ * @brief  Find the slot of a key, or the empty slot where it belongs.
+ */
+static ctx_slot *mapSlot(const ctx_map *m, const ctx_key *k) {
+    size_t i;
+
+    if (m->dense != 0) {
+        return &m->slots[((size_t)1U << k->len) | (size_t)k->a];
+    }
+    i = (size_t)mix64((k->a * 0x9E3779B97F4A7C15ULL) ^ (k->b * 0xC2B2AE3D27D4EB4FULL) ^ k->len) & m->mask;
+    for (;;) {
+        ctx_slot *sl = &m->slots[i];
+        if ((sl->len == 0U) || ((sl->len == k->len) && (sl->a == k->a) && (sl->b == k->b))) {
+            return sl;
+        }
+        i = (i + 1U) & m->mask;
+    }
+}
+
+/**
+ * @brief  Look up a context.
+ * @return Slot, or NULL if absent.
+ */
+static ctx_slot *mapFind(const ctx_map *m, const ctx_key *k) {
+    ctx_slot *sl = mapSlot(m, k);
+    return (sl->len != 0U) ? sl : NULL;
+}
+
+/**
+ * @brief  Initialize a table for alphabet size @p k.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int mapInit(ctx_map *m, unsigned k) {
+    size_t n;
+
+    (void)memset(m, 0, sizeof(*m));
+    m->dense = (k == 2U) ? 1 : 0;
+    if (m->dense != 0) {
+        n = (size_t)2U << MAX_CTX;
+        m->slots = calloc(n, sizeof(ctx_slot));
+        m->fCounts = calloc(n * 2U, sizeof(uint32_t));
+    } else {
+        m->mask = 4095U;
+        m->fMask = 4095U;
+        m->slots = calloc(m->mask + 1U, sizeof(ctx_slot));
+        m->fKeys = calloc(m->fMask + 1U, sizeof(uint64_t));
+        m->fCounts = calloc(m->fMask + 1U, sizeof(uint32_t));
+    }
+    return ((m->slots != NULL) && (m->fCounts != NULL) && ((m->dense != 0) || (m->fKeys != NULL))) ? 0 : -1;
+}
+
+/**
+ * @brief  Free a table.
+ */
+static void mapFree(ctx_map *m) {
+    free(m->slots);
+    free(m->fKeys);
+    free(m->fCounts);
+}
+
+/**
+ * @brief  Insert a context (must be absent).
+ * @return Slot, or NULL on allocation failure.
+ */
+static ctx_slot *mapInsert(ctx_map *m, const ctx_key *k) {
+    ctx_slot *sl;
+
+    if ((m->dense == 0) && (((m->used + 1U) * 2U) > (m->mask + 1U))) {
+        ctx_map grown = *m;
+        size_t i;
+        grown.mask = (m->mask * 2U) + 1U;
+        grown.slots = calloc(grown.mask + 1U, sizeof(ctx_slot));
+        if (grown.slots == NULL) {
+            return NULL;
+        }
+        for (i = 0U; i <= m->mask; i++) {
+            if (m->slots[i].len != 0U) {
+                ctx_key old = { m->slots[i].a, m->slots[i].b, m->slots[i].len };
+                *mapSlot(&grown, &old) = m->slots[i];
+            }
+        }
+        free(m->slots);
+        *m = grown;
+    }
+    sl = mapSlot(m, k);
+    sl->a = k->a;
+    sl->b = k->b;
+    sl->len = k->len;
+    sl->id = (m->dense != 0) ? (uint32_t)(sl - m->slots) : (uint32_t)m->used;
+    sl->bestCount = 0U;
+    sl->best = 0U;
+    m->used++;
+    return sl;
+}
+
+/**
+ * @brief  Follower count cell of (@p id, @p sym) in hashed mode.
+ * @param  create  Non-zero to insert a zero count if absent.
+ * @return Count cell, NULL if absent (or on allocation failure with create).
+ */
+static uint32_t *followerCell(ctx_map *m, uint32_t id, uint8_t sym, int create) {
+    uint64_t key = (((uint64_t)id << 8) | sym) + 1U;
+    size_t i;
+
+    if ((create != 0) && (((m->fUsed + 1U) * 2U) > (m->fMask + 1U))) {
+        size_t mask = (m->fMask * 2U) + 1U;
+        uint64_t *keys = calloc(mask + 1U, sizeof(uint64_t));
+        uint32_t *counts = calloc(mask + 1U, sizeof(uint32_t));
+        if ((keys == NULL) || (counts == NULL)) {
+            free(keys);
+            free(counts);
+            return NULL;
+        }
+        for (i = 0U; i <= m->fMask; i++) {
+            if (m->fKeys[i] != 0U) {
+                size_t j = (size_t)mix64(m->fKeys[i] * 0x9E3779B97F4A7C15ULL) & mask;
+                while (keys[j] != 0U) {
+                    j = (j + 1U) & mask;
+                }
+                keys[j] = m->fKeys[i];
+                counts[j] = m->fCounts[i];
+            }
+        }
+        free(m->fKeys);
+        free(m->fCounts);
+        m->fKeys = keys;
+        m->fCounts = counts;
+        m->fMask = mask;
+    }
+
+    i = (size_t)mix64(key * 0x9E3779B97F4A7C15ULL) & m->fMask;
+    while ((m->fKeys[i] != 0U) && (m->fKeys[i] != key)) {
+        i = (i + 1U) & m->fMask;
+    }
+    if (m->fKeys[i] == 0U) {
+        if (create == 0) {
+            return NULL;
+        }
+        m->fKeys[i] = key;
+        m->fUsed++;
+    }
+    return &m->fCounts[i];
+}
+
+/**
+ * @brief  Increment the count of @p sym after a context.
+ * @param  create  0 to only increment an existing follower.
+ * @return 1 if a follower was created, 0 if incremented or not created,
+ *         -1 on allocation failure.
+ */
+static int mapBump(ctx_map *m, ctx_slot *sl, uint8_t sym, int create) {
+    uint32_t *c;
+
+    if (m->dense != 0) {
+        c = &m->fCounts[((size_t)sl->id * 2U) + sym];
+        if ((*c == 0U) && (create == 0)) {
+            return 0;
+        }
+    } else {
+        c = followerCell(m, sl->id, sym, create);
+        if (c == NULL) {
+            return (create != 0) ? -1 : 0;
+        }
+    }
+    (*c)++;
+    if (*c > sl->bestCount) {
+        sl->bestCount = *c;
+        sl->best = sym;
+    }
+    return (*c == 1U) ? 1 : 0;
+}
+
+double trng_90bMultiMmc(const uint8_t *s, size_t len, unsigned k) {
+    ctx_map m;
+    size_t entries[MAX_CTX + 1U];
+    size_t score[MAX_CTX + 1U];
+    int sub[MAX_CTX + 1U];
+    size_t winner = 1U;
+    predict_t st = { 0U, 0U, 0U, 0U };
+    size_t i;
+    int failed = 0;
+
+    if ((len < 3U) || (mapInit(&m, k) != 0)) {
+        return TRNG_90B_NA;
+    }
+    (void)memset(entries, 0, sizeof(entries));
+    (void)memset(score, 0, sizeof(score));
+
+    for (i = 2U; (i < len) && (failed == 0); i++) {
+        ctx_key key = { 0U, 0U, 0U };
+        size_t d;
+
+        /* Count s[i - 1] after the contexts ending at s[i - 2]. */
+        for (d = 1U; (d <= MAX_CTX) && (d < i); d++) {
+            ctx_slot *sl;
+            keyExtend(&m, &key, s[i - d - 1U]);
+            sl = mapFind(&m, &key);
+            if ((sl == NULL) && (entries[d] < MMC_MAX_ENTRIES)) {
+                sl = mapInsert(&m, &key);
+                failed = (sl == NULL) ? 1 : 0;
+            }
+            if (sl != NULL) {
+                int rc = mapBump(&m, sl, s[i - 1U], entries[d] < MMC_MAX_ENTRIES);
+                if (rc < 0) {
+                    failed = 1;
+                } else {
+                    entries[d] += (size_t)rc;
+                }
+            }
+        }
+
+        /* Predict s[i] from the contexts ending at s[i - 1]. */
+        key.a = 0U;
+        key.b = 0U;
+        key.len = 0U;
+        for (d = 1U; d <= MAX_CTX; d++) {
+            const ctx_slot *sl = NULL;
+            if (d <= i) {
+                keyExtend(&m, &key, s[i - d]);
+                sl = mapFind(&m, &key);
+            }
+            sub[d] = ((sl != NULL) && (sl->bestCount != 0U)) ? (int)sl->best : -1;
+        }
+        predictRecord(&st, sub[winner] == (int)s[i]);
+        for (d = 1U; d <= MAX_CTX; d++) {
+            if (sub[d] == (int)s[i]) {
+                score[d]++;
+                if (score[d] >= score[winner]) {
+                    winner = d;
+                }
+            }
+        }
+    }
+
+    mapFree(&m);
+    return (failed != 0) ? TRNG_90B_NA : predictionEntropy(st.correct, st.n, st.maxRun, k);
+}
+
+double trng_90bLz78y(const uint8_t *s, size_t len, unsigned k) {
+    ctx_map m;
+    size_t dictSize = 0U;
+    predict_t st = { 0U, 0U, 0U, 0U };
+    size_t i;
+    int failed = 0;
+
+    if ((len <= (MAX_CTX + 2U)) || (mapInit(&m, k) != 0)) {
+        return TRNG_90B_NA;
+    }
+
+    for (i = MAX_CTX + 1U; (i < len) && (failed == 0); i++) {
+        ctx_key keys[MAX_CTX + 1U];
+        ctx_key key = { 0U, 0U, 0U };
+        size_t j;
+        uint32_t maxCount = 0U;
+        int prediction = -1;
+
+        /* Update the contexts ending at s[i - 2], longest first. */
+        for (j = 1U; j <= MAX_CTX; j++) {
+            keyExtend(&m, &key, s[i - j - 1U]);
+            keys[j] = key;
+        }
+        for (j = MAX_CTX; j >= 1U; j--) {
+            ctx_slot *sl = mapFind(&m, &keys[j]);
+            if ((sl == NULL) && (dictSize < LZ_MAX_DICT)) {
+                sl = mapInsert(&m, &keys[j]);
+                dictSize++;
+                failed = (sl == NULL) ? 1 : 0;
+            }
+            if ((sl != NULL) && (mapBump(&m, sl, s[i - 1U], 1) < 0)) {
+                failed = 1;
+            }
+        }
+
+        /* Predict s[i]; longer contexts win ties. */
+        key.a = 0U;
+        key.b = 0U;
+        key.len = 0U;
+        for (j = 1U; j <= MAX_CTX; j++) {
+            keyExtend(&m, &key, s[i - j]);
+            keys[j] = key;
+        }
+        for (j = MAX_CTX; j >= 1U; j--) {
+            const ctx_slot *sl = mapFind(&m, &keys[j]);
+            if ((sl != NULL) && (sl->bestCount > maxCount)) {
+                maxCount = sl->bestCount;
+                prediction = (int)sl->best;
+            }
+        }
+        predictRecord(&st, prediction == (int)s[i]);
+    }
+
+    mapFree(&m);
+    return (failed != 0) ? TRNG_90B_NA : predictionEntropy(st.correct, st.n, st.maxRun, k);
+}
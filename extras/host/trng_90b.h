@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * @file    trng_90b.h
+ * @brief   NIST SP 800-90B non-IID min-entropy estimators (section 6.3).
+ *
+ * Every estimator takes a sequence of @p len samples, one per byte, with
+ * values below @p k (2 for a bitstring, 256 for byte samples), and returns
+ * its min-entropy estimate in bits per sample. The binary-only estimators
+ * (collision, Markov, compression) take a bitstring with values 0 and 1.
+ *
+ * The estimators follow the formulas of SP 800-90B (January 2018),
+ * sections 6.3.1 to 6.3.10, with the parameters given there. The collision
+ * estimate uses the exact expected collision time of a binary source,
+ * 2 + 2p(1 - p), which has a closed-form inverse.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_90B_H
+#define TRNG_90B_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Estimate not applicable to this data (e.g. no repeated tuple). */
+#define TRNG_90B_NA     (-1.0)
+
+/** @brief 6.3.1 Most common value estimate. */
+double trng_90bMcv(const uint8_t *s, size_t len);
+
+/** @brief 6.3.2 Collision estimate (bitstring only). */
+double trng_90bCollision(const uint8_t *s, size_t len);
+
+/** @brief 6.3.3 Markov estimate (bitstring only). */
+double trng_90bMarkov(const uint8_t *s, size_t len);
+
+/** @brief 6.3.4 Compression estimate (bitstring only). */
+double trng_90bCompression(const uint8_t *s, size_t len);
+
+/**
+ * @brief   6.3.5 t-Tuple and 6.3.6 longest repeated substring estimates.
+ *
+ * Both are computed from one suffix array and LCP array of the input.
+ *
+ * @param[out] tTuple  t-Tuple estimate.
+ * @param[out] lrs     LRS estimate, TRNG_90B_NA if not applicable.
+ *
+ * @return  0 on success, -1 on allocation failure.
+ */
+int trng_90bTupleLrs(const uint8_t *s, size_t len, double *tTuple, double *lrs);
+
+/** @brief 6.3.7 Multi most common in window prediction estimate. */
+double trng_90bMultiMcw(const uint8_t *s, size_t len, unsigned k);
+
+/** @brief 6.3.8 Lag prediction estimate. */
+double trng_90bLag(const uint8_t *s, size_t len, unsigned k);
+
+/** @brief 6.3.9 Multi Markov model with counting prediction estimate. */
+double trng_90bMultiMmc(const uint8_t *s, size_t len, unsigned k);
+
+/** @brief 6.3.10 LZ78Y prediction estimate. */
+double trng_90bLz78y(const uint8_t *s, size_t len, unsigned k);
+
+#endif /* TRNG_90B_H */
@@ -0,0 +1,358 @@
+/*******************************************************************************
+ * @file    trng_assess.c
+ * @brief   Parallel SP 800-90B non-IID entropy assessment of capture files.
+ *
+ * Memory-maps capture files (see trng_capfile.h), splits each into blocks
+ * of -l samples (1,000,000 by default, the minimum dataset size of
+ * SP 800-90B section 3.1.1) and runs the ten non-IID estimators of
+ * section 6.3 (see trng_90b.h) on every block:
+ * - on the 8-bit samples: most common value, t-tuple, LRS, MultiMCW,
+ *   lag, MultiMMC and LZ78Y (H_original);
+ * - on the bitstring of each block, most significant bit first: all ten
+ *   estimators (H_bitstring).
+ *
+ * The estimate of a block is min(H_original, 8 * H_bitstring) as in
+ * section 3.1.3, and the estimate of a file is the minimum over its
+ * blocks. Each (block, estimator) pair is an independent task on a
+ * work-stealing thread pool, so all cores stay busy until the last block.
+ *
+ * The restart tests (3.1.4) and the IID tests (section 5) are not run.
+ *
+ * Build (Linux):
+ * @code
+ *   cc -O2 -pthread -I../../src -o trng_assess trng_assess.c trng_90b.c trng_pool.c trng_capfile.c trng_host.c ../../src/trng_frame.c -lm
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_assess [-t threads] [-l samples] [-r] [-v] file...
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_90b.h"
+#include "trng_capfile.h"
+#include "trng_host.h"
+#include "trng_pool.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/** @brief Estimators, in report order. */
+enum {
+    EST_MCV,
+    EST_COLLISION,
+    EST_MARKOV,
+    EST_COMPRESSION,
+    EST_TUPLE,          /**< Also computes EST_LRS. */
+    EST_LRS,
+    EST_MCW,
+    EST_LAG,
+    EST_MMC,
+    EST_LZ78Y,
+    EST_COUNT
+};
+
+/** @brief Estimator names. */
+static const char *const _names[EST_COUNT] = {
+    "Most common value", "Collision", "Markov", "Compression", "t-Tuple",
+    "LRS", "MultiMCW prediction", "Lag prediction", "MultiMMC prediction",
+    "LZ78Y prediction"
+};
+
+/** @brief One block of samples and its results. */
+typedef struct {
+    const uint8_t *data;            /**< Samples. */
+    size_t         len;             /**< Number of samples. */
+    uint8_t       *bits;            /**< Bitstring, len * 8 entries. */
+    atomic_int     refs;            /**< Tasks still using bits. */
+    double         sym[EST_COUNT];  /**< Estimates on 8-bit samples. */
+    double         bit[EST_COUNT];  /**< Estimates on the bitstring. */
+} block_t;
+
+/** @brief One estimator task. */
+typedef struct {
+    block_t *b;
+    int      est;
+    int      binary;
+} job_t;
+
+/** @brief An input file. */
+typedef struct {
+    const char *path;
+    trng_cap    cap;
+    int         raw;                /**< 1 if mapped without a header. */
+    block_t    *blocks;
+    job_t      *jobs;
+    size_t      nBlocks;
+} input_t;
+
+/** @brief Pool shared by all tasks. */
+static trng_pool *_pool = NULL;
+
+/**
+ * @brief  Print usage to stderr.
+ */
+static void usage(void) {
+    fprintf(stderr,
+        "usage: trng_assess [-t threads] [-l samples] [-r] [-v] file...\n"
+        "  -t threads  worker threads (default: one per CPU)\n"
+        "  -l samples  samples per assessed block, 0 for whole files (default 1000000)\n"
+        "  -r          inputs are raw sample files without a capture header\n"
+        "  -v          print the estimates of every block\n");
+}
+
+/**
+ * @brief  Estimator task.
+ */
+static void runJob(void *arg) {
+    job_t *j = arg;
+    block_t *b = j->b;
+    const uint8_t *s = (j->binary != 0) ? b->bits : b->data;
+    size_t len = (j->binary != 0) ? (b->len * 8U) : b->len;
+    unsigned k = (j->binary != 0) ? 2U : 256U;
+    double *out = (j->binary != 0) ? b->bit : b->sym;
+
+    switch (j->est) {
+    case EST_MCV:         out[EST_MCV] = trng_90bMcv(s, len); break;
+    case EST_COLLISION:   out[EST_COLLISION] = trng_90bCollision(s, len); break;
+    case EST_MARKOV:      out[EST_MARKOV] = trng_90bMarkov(s, len); break;
+    case EST_COMPRESSION: out[EST_COMPRESSION] = trng_90bCompression(s, len); break;
+    case EST_TUPLE:
+        if (trng_90bTupleLrs(s, len, &out[EST_TUPLE], &out[EST_LRS]) != 0) {
+            fprintf(stderr, "trng_assess: out of memory in t-tuple / LRS\n");
+        }
+        break;
+    case EST_MCW:         out[EST_MCW] = trng_90bMultiMcw(s, len, k); break;
+    case EST_LAG:         out[EST_LAG] = trng_90bLag(s, len, k); break;
+    case EST_MMC:         out[EST_MMC] = trng_90bMultiMmc(s, len, k); break;
+    default:              out[EST_LZ78Y] = trng_90bLz78y(s, len, k); break;
+    }
+
+    if ((j->binary != 0) && (atomic_fetch_sub(&b->refs, 1) == 1)) {
+        free(b->bits);
+        b->bits = NULL;
+    }
+}
+
+/**
+ * @brief  Block task: expand the bitstring, then queue the estimators.
+ *
+ * The estimator tasks go to this worker's deque, so it processes its own
+ * block while idle workers steal the remaining ones.
+ */
+static void runBlock(void *arg) {
+    job_t *jobs = arg;
+    block_t *b = jobs[0].b;
+    size_t i;
+    int n = 0;
+    int e;
+
+    b->bits = malloc(b->len * 8U);
+    if (b->bits == NULL) {
+        fprintf(stderr, "trng_assess: out of memory\n");
+    } else {
+        for (i = 0U; i < b->len; i++) {
+            unsigned bit;
+            for (bit = 0U; bit < 8U; bit++) {
+                b->bits[(i * 8U) + bit] = (uint8_t)((b->data[i] >> (7U - bit)) & 1U);
+            }
+        }
+        atomic_store(&b->refs, EST_COUNT - 1);
+        for (e = 0; e < EST_COUNT; e++) {
+            if (e != EST_LRS) {
+                jobs[n] = (job_t){ b, e, 1 };
+                trng_poolSubmit(_pool, runJob, &jobs[n]);
+                n++;
+            }
+        }
+    }
+    /* Estimators that are defined only for bitstrings are skipped here. */
+    for (e = 0; e < EST_COUNT; e++) {
+        if ((e != EST_COLLISION) && (e != EST_MARKOV) && (e != EST_COMPRESSION) && (e != EST_LRS)) {
+            jobs[n] = (job_t){ b, e, 0 };
+            trng_poolSubmit(_pool, runJob, &jobs[n]);
+            n++;
+        }
+    }
+}
+
+/**
+ * @brief  Minimum of the valid estimates in @p est.
+ */
+static double minEstimate(const double *est, int binary) {
+    double h = INFINITY;
+    int e;
+
+    for (e = 0; e < EST_COUNT; e++) {
+        int applies = (binary != 0) ||
+            ((e != EST_COLLISION) && (e != EST_MARKOV) && (e != EST_COMPRESSION));
+        if ((applies != 0) && (est[e] >= 0.0) && (est[e] < h)) {
+            h = est[e];
+        }
+    }
+    return h;
+}
+
+/**
+ * @brief  Print the results of one file.
+ * @return Final estimate in bits per sample.
+ */
+static double report(const input_t *in, int verbose) {
+    double symMin[EST_COUNT];
+    double bitMin[EST_COUNT];
+    double final = INFINITY;
+    size_t worst = 0U;
+    size_t i;
+    int e;
+
+    for (e = 0; e < EST_COUNT; e++) {
+        symMin[e] = INFINITY;
+        bitMin[e] = INFINITY;
+    }
+    for (i = 0U; i < in->nBlocks; i++) {
+        const block_t *b = &in->blocks[i];
+        double hOrig = minEstimate(b->sym, 0);
+        double hBit = minEstimate(b->bit, 1);
+        double h = (hOrig < (8.0 * hBit)) ? hOrig : (8.0 * hBit);
+        for (e = 0; e < EST_COUNT; e++) {
+            if ((b->sym[e] >= 0.0) && (b->sym[e] < symMin[e])) {
+                symMin[e] = b->sym[e];
+            }
+            if ((b->bit[e] >= 0.0) && (b->bit[e] < bitMin[e])) {
+                bitMin[e] = b->bit[e];
+            }
+        }
+        if (h < final) {
+            final = h;
+            worst = i;
+        }
+        if (verbose != 0) {
+            printf("  block %zu: H_original %.6f, H_bitstring %.6f, H %.6f\n", i, hOrig, hBit, h);
+        }
+    }
+
+    printf("%s: %zu samples in %zu blocks", in->path, in->cap.len, in->nBlocks);
+    if (in->raw == 0) {
+        printf(", device ");
+        for (i = 0U; i < sizeof(in->cap.hdr.deviceId); i++) {
+            printf("%02x", in->cap.hdr.deviceId[i]);
+        }
+    }
+    printf("\n  %-22s %12s %12s\n", "estimator (minimum)", "8-bit", "bitstring");
+    for (e = 0; e < EST_COUNT; e++) {
+        printf("  %-22s", _names[e]);
+        if (isinf(symMin[e]) != 0) {
+            printf(" %12s", "-");
+        } else {
+            printf(" %12.6f", symMin[e]);
+        }
+        if (isinf(bitMin[e]) != 0) {
+            printf(" %12s\n", "-");
+        } else {
+            printf(" %12.6f\n", bitMin[e]);
+        }
+    }
+    printf("  min-entropy: %.6f bits per sample (block %zu)\n", final, worst);
+    return final;
+}
+
+int main(int argc, char **argv) {
+    input_t *inputs;
+    size_t blockLen = 1000000U;
+    unsigned threads = 0U;
+    int raw = 0;
+    int verbose = 0;
+    int status = 0;
+    int nInputs;
+    double start;
+    int opt;
+    int f;
+
+    while ((opt = getopt(argc, argv, "t:l:rvh")) != -1) {
+        switch (opt) {
+        case 't': threads = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'l': blockLen = (size_t)strtoull(optarg, NULL, 10); break;
+        case 'r': raw = 1; break;
+        case 'v': verbose = 1; break;
+        default:  usage(); return 2;
+        }
+    }
+    nInputs = argc - optind;
+    if (nInputs < 1) {
+        usage();
+        return 2;
+    }
+
+    _pool = trng_poolCreate(threads);
+    inputs = calloc((size_t)nInputs, sizeof(*inputs));
+    if ((_pool == NULL) || (inputs == NULL)) {
+        fprintf(stderr, "trng_assess: cannot start thread pool\n");
+        return 1;
+    }
+
+    start = trng_hostNow();
+    for (f = 0; f < nInputs; f++) {
+        input_t *in = &inputs[f];
+        size_t len;
+        size_t i;
+
+        in->path = argv[optind + f];
+        in->raw = raw;
+        if (((raw != 0) ? trng_capMapRaw(&in->cap, in->path) : trng_capMap(&in->cap, in->path)) != 0) {
+            status = 1;
+            continue;
+        }
+        len = ((blockLen == 0U) || (blockLen > in->cap.len)) ? in->cap.len : blockLen;
+        in->nBlocks = in->cap.len / len;
+        if (in->nBlocks == 0U) {
+            fprintf(stderr, "%s: no data\n", in->path);
+            status = 1;
+            continue;
+        }
+        if ((in->cap.len % len) != 0U) {
+            fprintf(stderr, "%s: last %zu samples (partial block) not assessed\n", in->path,
+                    in->cap.len % len);
+        }
+        in->blocks = calloc(in->nBlocks, sizeof(block_t));
+        in->jobs = calloc(in->nBlocks * EST_COUNT * 2U, sizeof(job_t));
+        if ((in->blocks == NULL) || (in->jobs == NULL)) {
+            fprintf(stderr, "%s: out of memory\n", in->path);
+            status = 1;
+            in->nBlocks = 0U;
+            continue;
+        }
+        for (i = 0U; i < in->nBlocks; i++) {
+            block_t *b = &in->blocks[i];
+            int e;
+            b->data = &in->cap.data[i * len];
+            b->len = len;
+            for (e = 0; e < EST_COUNT; e++) {
+                b->sym[e] = TRNG_90B_NA;
+                b->bit[e] = TRNG_90B_NA;
+            }
+            in->jobs[i * EST_COUNT * 2U].b = b;
+            trng_poolSubmit(_pool, runBlock, &in->jobs[i * EST_COUNT * 2U]);
+        }
+    }
+    trng_poolWait(_pool);
+
+    for (f = 0; f < nInputs; f++) {
+        if (inputs[f].nBlocks != 0U) {
+            (void)report(&inputs[f], verbose);
+        }
+        trng_capUnmap(&inputs[f].cap);
+        free(inputs[f].blocks);
+        free(inputs[f].jobs);
+    }
+    fprintf(stderr, "trng_assess: %.1f s on %u threads\n", trng_hostNow() - start,
+            trng_poolThreads(_pool));
+
+    trng_poolDestroy(_pool);
+    free(inputs);
+    return status;
+}
@@ -0,0 +1,415 @@
+/*******************************************************************************
+ * @file    trng_battery.c
+ * @brief   Parallel NIST SP 800-22 battery with a per-device report.
+ *
+ * Memory-maps capture files (see trng_capfile.h), cuts them into sequences
+ * of -n bits (1,000,000 by default) and runs the fifteen SP 800-22 tests
+ * of trng_sts.h on every sequence. Each (sequence, test) pair is a task
+ * on the work-stealing thread pool of trng_pool.h.
+ *
+ * Capture files of the same device (same unique ID in the header) are
+ * pooled, so several short captures of one board form one sample. For
+ * each of the 188 P-values the second-level analysis of SP 800-22
+ * section 4.2 is applied over all sequences of the device:
+ * - proportion: the fraction of P-values >= 0.01 must be at least
+ *   0.99 - 3 * sqrt(0.99 * 0.01 / m) for m sequences;
+ * - uniformity: the chi-square P-value of the ten-bin histogram must be
+ *   >= 0.0001; only assessed from 55 sequences on.
+ *
+ * With 188 checks a good device is expected to fail a few of them, the
+ * more so for small m where the proportion bound is coarse. The device
+ * verdict therefore counts the failing P-values and compares the count
+ * with its distribution for an ideal source (the exact chance of each
+ * check failing, combined over the checks): the device fails when the
+ * count would occur with probability below 0.001. The exit status is 1
+ * when a device fails or an input cannot be read.
+ *
+ * Build (Linux; -march=native turns the popcounts of trng_sts.c into the
+ * hardware instruction, without it x86-64 GCC calls a libgcc routine):
+ * @code
+ *   cc -O2 -march=native -pthread -I../../src -o trng_battery trng_battery.c trng_sts.c trng_pool.c trng_capfile.c trng_host.c ../../src/trng_frame.c -lm
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_battery [-t threads] [-n bits] [-N sequences] [-r] [-v] file...
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_capfile.h"
+#include "trng_host.h"
+#include "trng_pool.h"
+#include "trng_sts.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/** @brief Significance level of a single test. */
+#define ALPHA           0.01
+/** @brief Uniformity threshold on the P-value of the P-values. */
+#define UNIFORMITY_MIN  0.0001
+/** @brief Minimum number of sequences for the uniformity check. */
+#define UNIFORMITY_SEQ  55U
+/** @brief Significance level of the device verdict. */
+#define VERDICT_ALPHA   0.001
+
+/** @brief One sequence and its P-values. */
+typedef struct {
+    const uint8_t *data;                /**< First byte. */
+    size_t         bits;                /**< Sequence length. */
+    uint64_t      *w;                   /**< Packed bits while tests run. */
+    atomic_int     refs;                /**< Tests still using w. */
+    double         p[TRNG_STS_PVALUES]; /**< Results. */
+} seq_t;
+
+/** @brief One test task. */
+typedef struct {
+    seq_t   *s;
+    unsigned test;
+} job_t;
+
+/** @brief An input file. */
+typedef struct {
+    const char *path;
+    trng_cap    cap;
+    seq_t      *seqs;
+    job_t      *jobs;
+    size_t      nSeqs;
+    int         device;     /**< Index of the first input of its device. */
+} input_t;
+
+/** @brief Pool shared by all tasks. */
+static trng_pool *_pool = NULL;
+
+/**
+ * @brief  Print usage to stderr.
+ */
+static void usage(void) {
+    fprintf(stderr,
+        "usage: trng_battery [-t threads] [-n bits] [-N sequences] [-r] [-v] file...\n"
+        "  -t threads    worker threads (default: one per CPU)\n"
+        "  -n bits       bits per sequence (default 1000000)\n"
+        "  -N sequences  maximum sequences per file (default: all)\n"
+        "  -r            inputs are raw files of independent devices, no capture header\n"
+        "  -v            print the result of every P-value\n");
+}
+
+/**
+ * @brief  Test task.
+ */
+static void runJob(void *arg) {
+    job_t *j = arg;
+    seq_t *s = j->s;
+    trng_sts_seq seq = { s->w, s->bits };
+    const trng_sts_test *t = &trng_stsTests[j->test];
+
+    t->run(&seq, &s->p[t->first]);
+    if (atomic_fetch_sub(&s->refs, 1) == 1) {
+        free(s->w);
+        s->w = NULL;
+    }
+}
+
+/**
+ * @brief  Sequence task: pack the bits, then queue the tests.
+ */
+static void runSeq(void *arg) {
+    job_t *jobs = arg;
+    seq_t *s = jobs[0].s;
+    size_t words = (s->bits + 63U) / 64U;
+    size_t i;
+    unsigned t;
+
+    s->w = calloc(words, sizeof(uint64_t));
+    if (s->w == NULL) {
+        fprintf(stderr, "trng_battery: out of memory\n");
+        return;
+    }
+    for (i = 0U; i < ((s->bits + 7U) / 8U); i++) {
+        s->w[i / 8U] |= (uint64_t)s->data[i] << (56U - (8U * (i % 8U)));
+    }
+    if ((s->bits % 8U) != 0U) {
+        s->w[(s->bits - 1U) / 64U] &= ~(UINT64_MAX >> ((s->bits - 1U) % 64U) >> 1);
+    }
+    atomic_store(&s->refs, (int)TRNG_STS_TESTS);
+    for (t = 0U; t < TRNG_STS_TESTS; t++) {
+        jobs[t] = (job_t){ s, t };
+        trng_poolSubmit(_pool, runJob, &jobs[t]);
+    }
+}
+
+/**
+ * @brief  Second-level analysis of one P-value over the sequences of a device.
+ * @param  pass        Sequences with P >= ALPHA.
+ * @param  m           Sequences where the test applies.
+ * @param  uniformity  P-value of the uniformity check, NAN if not assessed.
+ * @param  chance      Probability that an ideal source fails the checks.
+ * @return 1 if both checks pass or nothing was assessed, 0 otherwise.
+ */
+static int analyse(const input_t *inputs, int nInputs, int device, unsigned col,
+                   size_t *pass, size_t *m, double *uniformity, double *chance) {
+    size_t bins[10] = { 0U };
+    double chi = 0.0;
+    double bound;
+    double term;
+    size_t need;
+    int f;
+    size_t i;
+    unsigned b;
+
+    *pass = 0U;
+    *m = 0U;
+    *uniformity = NAN;
+    *chance = 0.0;
+    for (f = 0; f < nInputs; f++) {
+        if (inputs[f].device != device) {
+            continue;
+        }
+        for (i = 0U; i < inputs[f].nSeqs; i++) {
+            double p = inputs[f].seqs[i].p[col];
+            if (isnan(p) == 0) {
+                (*m)++;
+                *pass += (p >= ALPHA) ? 1U : 0U;
+                b = (unsigned)(p * 10.0);
+                bins[(b < 10U) ? b : 9U]++;
+            }
+        }
+    }
+    if (*m == 0U) {
+        return 1;
+    }
+    if (*m >= UNIFORMITY_SEQ) {
+        for (b = 0U; b < 10U; b++) {
+            double e = (double)*m / 10.0;
+            chi += (((double)bins[b] - e) * ((double)bins[b] - e)) / e;
+        }
+        *uniformity = trng_stsIgamc(9.0 / 2.0, chi / 2.0);
+    }
+    bound = (1.0 - ALPHA) - (3.0 * sqrt(((1.0 - ALPHA) * ALPHA) / (double)*m));
+    need = (size_t)ceil(bound * (double)*m);
+    /* P(more than m - need rejections), binomial(m, ALPHA). */
+    term = pow(1.0 - ALPHA, (double)*m);
+    for (i = 0U; i <= (*m - need); i++) {
+        *chance += term;
+        term *= ((double)(*m - i) / (double)(i + 1U)) * (ALPHA / (1.0 - ALPHA));
+    }
+    *chance = 1.0 - *chance;
+    if (isnan(*uniformity) == 0) {
+        *chance += UNIFORMITY_MIN * (1.0 - *chance);
+    }
+    return (((double)*pass >= (bound * (double)*m)) &&
+            ((isnan(*uniformity) != 0) || (*uniformity >= UNIFORMITY_MIN))) ? 1 : 0;
+}
+
+/**
+ * @brief  Print the results of one device.
+ * @return 1 if the device passes, 0 otherwise.
+ */
+static int report(const input_t *inputs, int nInputs, int device, int verbose) {
+    const input_t *first = &inputs[device];
+    /* Distribution of the number of failing P-values for an ideal source. */
+    double dist[TRNG_STS_PVALUES + 1U];
+    unsigned checks = 0U;
+    unsigned failures = 0U;
+    unsigned allowed;
+    double tail;
+    size_t seqs = 0U;
+    unsigned t;
+    unsigned k;
+    int f;
+
+    (void)memset(dist, 0, sizeof(dist));
+    dist[0] = 1.0;
+    for (f = device; f < nInputs; f++) {
+        if (inputs[f].device == device) {
+            seqs += inputs[f].nSeqs;
+        }
+    }
+    if (first->cap.hdr.dataLen != 0U) {
+        printf("device ");
+        for (k = 0U; k < sizeof(first->cap.hdr.deviceId); k++) {
+            printf("%02x", first->cap.hdr.deviceId[k]);
+        }
+    } else {
+        printf("%s", first->path);
+    }
+    printf(": %zu sequences of %zu bits\n", seqs, (seqs != 0U) ? first->seqs[0].bits : 0U);
+    printf("  %-24s %6s %12s %12s  %s\n", "test", "values", "proportion", "uniformity", "result");
+
+    for (t = 0U; t < TRNG_STS_TESTS; t++) {
+        const trng_sts_test *test = &trng_stsTests[t];
+        size_t minPass = 0U;
+        size_t minM = 0U;
+        double minU = NAN;
+        unsigned failed = 0U;
+        unsigned assessed = 0U;
+
+        for (k = 0U; k < test->count; k++) {
+            size_t pass;
+            size_t m;
+            double u;
+            double q;
+            unsigned c;
+            int good = analyse(inputs, nInputs, device, test->first + k, &pass, &m, &u, &q);
+            if (m == 0U) {
+                continue;
+            }
+            assessed++;
+            failed += (good != 0) ? 0U : 1U;
+            checks++;
+            for (c = checks; c > 0U; c--) {
+                dist[c] = (dist[c] * (1.0 - q)) + (dist[c - 1U] * q);
+            }
+            dist[0] *= 1.0 - q;
+            /* Keep the worst proportion and the smallest uniformity P-value. */
+            if ((minM == 0U) || (((double)pass / (double)m) < ((double)minPass / (double)minM))) {
+                minPass = pass;
+                minM = m;
+            }
+            if ((isnan(u) == 0) && ((isnan(minU) != 0) || (u < minU))) {
+                minU = u;
+            }
+            if (verbose != 0) {
+                printf("    %s[%u]: %zu/%zu, uniformity %.6f%s\n", test->name, k, pass, m, u,
+                       (good != 0) ? "" : " FAIL");
+            }
+        }
+        printf("  %-24s %6u", test->name, test->count);
+        if (assessed == 0U) {
+            printf(" %12s %12s  n/a\n", "-", "-");
+            continue;
+        }
+        printf(" %5zu/%-6zu", minPass, minM);
+        if (isnan(minU) != 0) {
+            printf(" %12s", "-");
+        } else {
+            printf(" %12.6f", minU);
+        }
+        if (failed == 0U) {
+            printf("  pass\n");
+        } else {
+            printf("  FAIL (%u of %u)\n", failed, assessed);
+            failures += failed;
+        }
+    }
+    tail = 1.0;
+    for (allowed = 0U; allowed < checks; allowed++) {
+        tail -= dist[allowed];
+        if (tail < VERDICT_ALPHA) {
+            break;
+        }
+    }
+    printf("  %s: %u of %u P-values fail, up to %u expected by chance\n",
+           (failures <= allowed) ? "PASS" : "FAIL", failures, checks, allowed);
+    return (failures <= allowed) ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    input_t *inputs;
+    size_t bits = 1000000U;
+    size_t maxSeqs = SIZE_MAX;
+    unsigned threads = 0U;
+    int raw = 0;
+    int verbose = 0;
+    int status = 0;
+    int nInputs;
+    double start;
+    int opt;
+    int f;
+
+    while ((opt = getopt(argc, argv, "t:n:N:rvh")) != -1) {
+        switch (opt) {
+        case 't': threads = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'n': bits = (size_t)strtoull(optarg, NULL, 10); break;
+        case 'N': maxSeqs = (size_t)strtoull(optarg, NULL, 10); break;
+        case 'r': raw = 1; break;
+        case 'v': verbose = 1; break;
+        default:  usage(); return 2;
+        }
+    }
+    nInputs = argc - optind;
+    if ((nInputs < 1) || (bits < 1000U)) {
+        usage();
+        return 2;
+    }
+
+    _pool = trng_poolCreate(threads);
+    inputs = calloc((size_t)nInputs, sizeof(*inputs));
+    if ((_pool == NULL) || (inputs == NULL)) {
+        fprintf(stderr, "trng_battery: cannot start thread pool\n");
+        return 1;
+    }
+
+    start = trng_hostNow();
+    for (f = 0; f < nInputs; f++) {
+        input_t *in = &inputs[f];
+        size_t i;
+        int g;
+
+        in->path = argv[optind + f];
+        in->device = f;
+        if (((raw != 0) ? trng_capMapRaw(&in->cap, in->path) : trng_capMap(&in->cap, in->path)) != 0) {
+            status = 1;
+            continue;
+        }
+        for (g = 0; (raw == 0) && (g < f); g++) {
+            if ((inputs[g].nSeqs != 0U) &&
+                (memcmp(inputs[g].cap.hdr.deviceId, in->cap.hdr.deviceId,
+                        sizeof(in->cap.hdr.deviceId)) == 0)) {
+                in->device = inputs[g].device;
+                break;
+            }
+        }
+        in->nSeqs = in->cap.len / ((bits + 7U) / 8U);
+        in->nSeqs = (in->nSeqs < maxSeqs) ? in->nSeqs : maxSeqs;
+        if (in->nSeqs == 0U) {
+            fprintf(stderr, "%s: shorter than one sequence\n", in->path);
+            status = 1;
+            continue;
+        }
+        in->seqs = calloc(in->nSeqs, sizeof(seq_t));
+        in->jobs = calloc(in->nSeqs * TRNG_STS_TESTS, sizeof(job_t));
+        if ((in->seqs == NULL) || (in->jobs == NULL)) {
+            fprintf(stderr, "%s: out of memory\n", in->path);
+            status = 1;
+            in->nSeqs = 0U;
+            continue;
+        }
+        for (i = 0U; i < in->nSeqs; i++) {
+            seq_t *s = &in->seqs[i];
+            unsigned k;
+            /* Sequences start on byte boundaries; a partial byte is skipped. */
+            s->data = &in->cap.data[i * ((bits + 7U) / 8U)];
+            s->bits = bits;
+            for (k = 0U; k < TRNG_STS_PVALUES; k++) {
+                s->p[k] = NAN;
+            }
+            in->jobs[i * TRNG_STS_TESTS].s = s;
+            trng_poolSubmit(_pool, runSeq, &in->jobs[i * TRNG_STS_TESTS]);
+        }
+    }
+    trng_poolWait(_pool);
+
+    for (f = 0; f < nInputs; f++) {
+        if ((inputs[f].device == f) && (inputs[f].nSeqs != 0U) &&
+            (report(inputs, nInputs, f, verbose) == 0)) {
+            status = 1;
+        }
+    }
+    for (f = 0; f < nInputs; f++) {
+        trng_capUnmap(&inputs[f].cap);
+        free(inputs[f].seqs);
+        free(inputs[f].jobs);
+    }
+    fprintf(stderr, "trng_battery: %.1f s on %u threads\n", trng_hostNow() - start,
+            trng_poolThreads(_pool));
+
+    trng_poolDestroy(_pool);
+    free(inputs);
+    return status;
+}
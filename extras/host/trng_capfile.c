@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * @file    trng_capfile.c
+ * @brief   Capture file format for recorded TRNG output.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_capfile.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** @brief File magic. */
+static const uint8_t _magic[8] = { 'T', 'R', 'N', 'G', 'C', 'A', 'P', '1' };
+
+/**
+ * @brief  Write a little-endian value of @p n bytes.
+ */
+static void putLe(uint8_t *p, uint64_t v, size_t n) {
+    size_t i;
+    for (i = 0U; i < n; i++) {
+        p[i] = (uint8_t)(v >> (8U * i));
+    }
+}
+
+/**
+ * @brief  Read a little-endian value of @p n bytes.
+ */
+static uint64_t getLe(const uint8_t *p, size_t n) {
+    uint64_t v = 0U;
+    size_t i;
+    for (i = 0U; i < n; i++) {
+        v |= (uint64_t)p[i] << (8U * i);
+    }
+    return v;
+}
+
+void trng_capEncode(uint8_t *out, const trng_cap_header *hdr) {
+    (void)memset(out, 0, TRNG_CAP_HEADER_SIZE);
+    (void)memcpy(out, _magic, sizeof(_magic));
+    putLe(&out[8], TRNG_CAP_HEADER_SIZE, 4U);
+    putLe(&out[12], TRNG_CAP_VERSION, 2U);
+    out[14] = hdr->source;
+    (void)memcpy(&out[16], hdr->deviceId, sizeof(hdr->deviceId));
+    putLe(&out[32], hdr->startMs, 8U);
+    putLe(&out[40], hdr->uptimeMs, 4U);
+    putLe(&out[44], hdr->payloadSize, 2U);
+    putLe(&out[48], hdr->dataLen, 8U);
+    putLe(&out[56], hdr->lostFrames, 4U);
+    putLe(&out[60], trng_crc32(0U, out, 60U), 4U);
+}
+
+int trng_capDecode(trng_cap_header *hdr, const uint8_t *in) {
+    if ((memcmp(in, _magic, sizeof(_magic)) != 0) ||
+        (getLe(&in[8], 4U) != TRNG_CAP_HEADER_SIZE) ||
+        (getLe(&in[12], 2U) != TRNG_CAP_VERSION) ||
+        (getLe(&in[60], 4U) != trng_crc32(0U, in, 60U))) {
+        return -1;
+    }
+    hdr->source = in[14];
+    (void)memcpy(hdr->deviceId, &in[16], sizeof(hdr->deviceId));
+    hdr->startMs = getLe(&in[32], 8U);
+    hdr->uptimeMs = (uint32_t)getLe(&in[40], 4U);
+    hdr->payloadSize = (uint16_t)getLe(&in[44], 2U);
+    hdr->dataLen = getLe(&in[48], 8U);
+    hdr->lostFrames = (uint32_t)getLe(&in[56], 4U);
+    return 0;
+}
+
+int trng_capMap(trng_cap *cap, const char *path) {
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    (void)memset(cap, 0, sizeof(*cap));
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    if (fstat(fd, &st) != 0) {
+        perror(path);
+        (void)close(fd);
+        return -1;
+    }
+    if ((size_t)st.st_size < TRNG_CAP_HEADER_SIZE) {
+        fprintf(stderr, "%s: not a capture file\n", path);
+        (void)close(fd);
+        return -1;
+    }
+    cap->mapSize = (size_t)st.st_size;
+    cap->map = mmap(NULL, cap->mapSize, PROT_READ, MAP_SHARED, fd, 0);
+    (void)close(fd);
+    if (cap->map == MAP_FAILED) {
+        perror(path);
+        cap->map = NULL;
+        return -1;
+    }
+    if (trng_capDecode(&cap->hdr, (const uint8_t *)cap->map) != 0) {
+        fprintf(stderr, "%s: bad capture header\n", path);
+        trng_capUnmap(cap);
+        return -1;
+    }
+    if (cap->hdr.dataLen != (uint64_t)(cap->mapSize - TRNG_CAP_HEADER_SIZE)) {
+        fprintf(stderr, "%s: data length %llu does not match file size\n", path,
+                (unsigned long long)cap->hdr.dataLen);
+        trng_capUnmap(cap);
+        return -1;
+    }
+    cap->data = (const uint8_t *)cap->map + TRNG_CAP_HEADER_SIZE;
+    cap->len = (size_t)cap->hdr.dataLen;
+    (void)madvise(cap->map, cap->mapSize, MADV_SEQUENTIAL);
+    return 0;
+}
+
+int trng_capMapRaw(trng_cap *cap, const char *path) {
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    (void)memset(cap, 0, sizeof(*cap));
+    if ((fd < 0) || (fstat(fd, &st) != 0)) {
+        perror(path);
+        if (fd >= 0) {
+            (void)close(fd);
+        }
+        return -1;
+    }
+    cap->mapSize = (size_t)st.st_size;
+    if (cap->mapSize == 0U) {
+        (void)close(fd);
+        fprintf(stderr, "%s: empty file\n", path);
+        return -1;
+    }
+    cap->map = mmap(NULL, cap->mapSize, PROT_READ, MAP_SHARED, fd, 0);
+    (void)close(fd);
+    if (cap->map == MAP_FAILED) {
+        perror(path);
+        cap->map = NULL;
+        return -1;
+    }
+    cap->data = cap->map;
+    cap->len = cap->mapSize;
+    (void)madvise(cap->map, cap->mapSize, MADV_SEQUENTIAL);
+    return 0;
+}
+
+void trng_capUnmap(trng_cap *cap) {
+    if (cap->map != NULL) {
+        (void)munmap(cap->map, cap->mapSize);
+        cap->map = NULL;
+    }
+}
@@ -0,0 +1,97 @@
+/*******************************************************************************
+ * @file    trng_capfile.h
+ * @brief   Capture file format for recorded TRNG output.
+ *
+ * A capture file is a 64-byte header followed by the recorded samples as
+ * one contiguous byte array, so analysis tools can memory-map it and run
+ * directly over the data. All header fields are little-endian:
+ *
+ * | Offset | Size | Field                                              |
+ * |-------:|-----:|----------------------------------------------------|
+ * |      0 |    8 | Magic "TRNGCAP1"                                   |
+ * |      8 |    4 | Header size (64)                                   |
+ * |     12 |    2 | Format version (1)                                 |
+ * |     14 |    1 | Source: TRNG_SOURCE_RAW or TRNG_SOURCE_CONDITIONED |
+ * |     15 |    1 | Reserved (0)                                       |
+ * |     16 |   16 | Device unique ID                                   |
+ * |     32 |    8 | Capture start, Unix time in milliseconds           |
+ * |     40 |    4 | Device uptime at start, milliseconds               |
+ * |     44 |    2 | Frame payload size configured on the device        |
+ * |     46 |    2 | Reserved (0)                                       |
+ * |     48 |    8 | Data length in bytes                               |
+ * |     56 |    4 | Frames lost during capture (0 for a gap-free file) |
+ * |     60 |    4 | CRC-32 of bytes 0..59                              |
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_CAPFILE_H
+#define TRNG_CAPFILE_H
+
+#include "trng_frame.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Size of the capture file header. */
+#define TRNG_CAP_HEADER_SIZE    64U
+/** @brief Capture format version. */
+#define TRNG_CAP_VERSION        1U
+
+/** @brief Decoded capture header. */
+typedef struct {
+    uint8_t  source;        /**< TRNG_SOURCE_*. */
+    uint8_t  deviceId[16];  /**< Device unique ID. */
+    uint64_t startMs;       /**< Capture start, Unix milliseconds. */
+    uint32_t uptimeMs;      /**< Device uptime at start. */
+    uint16_t payloadSize;   /**< Frame payload size on the device. */
+    uint64_t dataLen;       /**< Data length in bytes. */
+    uint32_t lostFrames;    /**< Frames lost during capture. */
+} trng_cap_header;
+
+/** @brief Read-only mapping of a capture file. */
+typedef struct {
+    trng_cap_header hdr;    /**< Decoded header. */
+    const uint8_t  *data;   /**< First sample byte. */
+    size_t          len;    /**< Number of sample bytes. */
+    void           *map;    /**< Start of the mapping. */
+    size_t          mapSize;/**< Size of the mapping. */
+} trng_cap;
+
+/**
+ * @brief   Encode a capture header, including its CRC.
+ *
+ * @param[out] out  TRNG_CAP_HEADER_SIZE bytes.
+ */
+void trng_capEncode(uint8_t *out, const trng_cap_header *hdr);
+
+/**
+ * @brief   Decode and validate a capture header.
+ *
+ * @return  0 on success, -1 on bad magic, version, size or CRC.
+ */
+int trng_capDecode(trng_cap_header *hdr, const uint8_t *in);
+
+/**
+ * @brief   Map a capture file read-only and validate it.
+ *
+ * The data length in the header must match the file size.
+ *
+ * @return  0 on success, -1 on error (reported on stderr).
+ */
+int trng_capMap(trng_cap *cap, const char *path);
+
+/**
+ * @brief   Map a raw sample file (no header) read-only.
+ *
+ * The header fields are zero and the whole file is the data.
+ *
+ * @return  0 on success, -1 on error or empty file (reported on stderr).
+ */
+int trng_capMapRaw(trng_cap *cap, const char *path);
+
+/**
+ * @brief   Unmap a capture file.
+ */
+void trng_capUnmap(trng_cap *cap);
+
+#endif /* TRNG_CAPFILE_H */
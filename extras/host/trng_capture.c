@@ -0,0 +1,340 @@
+/*******************************************************************************
+ * @file    trng_capture.c
+ * @brief   Record TRNG output into capture files and inspect them.
+ *
+ * `record` reads the frame export (see trng_frame.h) from a board running
+ * the export example, waits for a device information frame, then appends
+ * every entropy payload to a capture file (see trng_capfile.h), including
+ * payloads of frames that failed the on-board health tests. Any lost frame
+ * or sequence restart aborts the capture, so a finished file is a
+ * gap-free sample stream; -g records the number of lost frames in the
+ * header and continues.
+ *
+ * `info` memory-maps capture files, validates them and prints the header
+ * and basic byte statistics.
+ *
+ * Build (Linux):
+ * @code
+ *   cc -O2 -I../../src -o trng_capture trng_capture.c trng_capfile.c trng_host.c ../../src/trng_frame.c -lm
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_capture record [-b baud] [-n bytes] [-g] -o file device
+ *   trng_capture info file...
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_capfile.h"
+#include "trng_frame.h"
+#include "trng_host.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/** @brief Size of the read buffer. */
+#define CAP_READ_SIZE   65536U
+/** @brief Size of the write buffer. */
+#define CAP_WRITE_SIZE  (1U << 20)
+
+/** @brief Set from the signal handler to stop recording. */
+static volatile sig_atomic_t _stop = 0;
+
+/**
+ * @brief  Signal handler for SIGINT / SIGTERM.
+ */
+static void onSignal(int sig) {
+    (void)sig;
+    _stop = 1;
+}
+
+/**
+ * @brief  Print usage to stderr.
+ */
+static void usage(void) {
+    fprintf(stderr,
+        "usage: trng_capture record [-b baud] [-n bytes] [-g] -o file device\n"
+        "       trng_capture info file...\n"
+        "  -b baud   serial speed when device is a tty (default 115200)\n"
+        "  -n bytes  stop after recording this many bytes\n"
+        "  -g        keep recording across lost frames\n"
+        "  -o file   capture file to write\n");
+}
+
+/**
+ * @brief  Wall-clock time in Unix milliseconds.
+ */
+static uint64_t unixMs(void) {
+    struct timeval tv;
+    (void)gettimeofday(&tv, NULL);
+    return ((uint64_t)tv.tv_sec * 1000U) + ((uint64_t)tv.tv_usec / 1000U);
+}
+
+/**
+ * @brief  Print a device ID as hex.
+ */
+static void printId(const uint8_t *id) {
+    size_t i;
+    for (i = 0U; i < 16U; i++) {
+        printf("%02x", id[i]);
+    }
+}
+
+/**
+ * @brief  Record mode.
+ * @return Process exit status.
+ */
+static int record(int argc, char **argv) {
+    static uint8_t in[CAP_READ_SIZE];
+    static uint8_t out[CAP_WRITE_SIZE];
+    static trng_frame_decoder dec;
+    uint8_t hdrBytes[TRNG_CAP_HEADER_SIZE];
+    trng_cap_header hdr;
+    trng_info info;
+    long baud = 115200L;
+    const char *outPath = NULL;
+    unsigned long long limit = 0ULL;
+    int allowGaps = 0;
+    int started = 0;
+    uint32_t lostAtStart = 0U;
+    uint32_t resyncsAtStart = 0U;
+    size_t outFill = 0U;
+    int inFd;
+    int outFd;
+    int status = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:n:go:h")) != -1) {
+        switch (opt) {
+        case 'b': baud = strtol(optarg, NULL, 10); break;
+        case 'n': limit = strtoull(optarg, NULL, 10); break;
+        case 'g': allowGaps = 1; break;
+        case 'o': outPath = optarg; break;
+        default:  usage(); return 2;
+        }
+    }
+    if ((outPath == NULL) || (optind != (argc - 1))) {
+        usage();
+        return 2;
+    }
+
+    inFd = trng_hostOpenInput(argv[optind], baud, 0);
+    if (inFd < 0) {
+        return 1;
+    }
+    outFd = open(outPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (outFd < 0) {
+        perror(outPath);
+        return 1;
+    }
+
+    (void)signal(SIGINT, onSignal);
+    (void)signal(SIGTERM, onSignal);
+    (void)memset(&hdr, 0, sizeof(hdr));
+    trng_frameDecoderInit(&dec);
+
+    while ((_stop == 0) && ((limit == 0ULL) || (hdr.dataLen < limit))) {
+        ssize_t got = read(inFd, in, sizeof(in));
+        size_t pos = 0U;
+
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("trng_capture: read");
+            status = 1;
+            break;
+        }
+        if (got == 0) {
+            break;
+        }
+
+        while ((_stop == 0) && ((pos < (size_t)got) || (dec.payload != NULL))) {
+            uint8_t ready = 0U;
+            pos += trng_frameFeed(&dec, &in[pos], (size_t)got - pos, &ready);
+            if (ready == 0U) {
+                break;
+            }
+
+            if ((dec.flags & TRNG_FRAME_FLAG_INFO) != 0U) {
+                if (trng_infoDecode(&info, dec.payload, dec.payloadLen) != 0U) {
+                    continue;
+                }
+                if (started == 0) {
+                    hdr.source = info.source;
+                    (void)memcpy(hdr.deviceId, info.deviceId, sizeof(hdr.deviceId));
+                    hdr.startMs = unixMs();
+                    hdr.uptimeMs = info.uptimeMs;
+                    hdr.payloadSize = info.payloadSize;
+                    lostAtStart = dec.lostFrames;
+                    resyncsAtStart = dec.resyncs;
+                    trng_capEncode(hdrBytes, &hdr);
+                    if (trng_hostWriteAll(outFd, hdrBytes, sizeof(hdrBytes)) != 0) {
+                        perror(outPath);
+                        status = 1;
+                        _stop = 1;
+                    }
+                    started = 1;
+                } else if (memcmp(hdr.deviceId, info.deviceId, sizeof(hdr.deviceId)) != 0) {
+                    fprintf(stderr, "trng_capture: device changed during capture\n");
+                    status = 1;
+                    _stop = 1;
+                }
+                continue;
+            }
+            if (started == 0) {
+                continue;
+            }
+
+            hdr.lostFrames = dec.lostFrames - lostAtStart;
+            if ((dec.resyncs != resyncsAtStart) && (allowGaps == 0)) {
+                /* The board restarted: the frames missed are unknown. */
+                fprintf(stderr, "trng_capture: sequence restarted, capture aborted\n");
+                status = 1;
+                _stop = 1;
+                continue;
+            }
+            if ((hdr.lostFrames != 0U) && (allowGaps == 0)) {
+                fprintf(stderr, "trng_capture: %lu frames lost, capture aborted\n",
+                        (unsigned long)hdr.lostFrames);
+                status = 1;
+                _stop = 1;
+                continue;
+            }
+
+            {
+                size_t len = dec.payloadLen;
+                if ((limit != 0ULL) && ((limit - hdr.dataLen) < len)) {
+                    len = (size_t)(limit - hdr.dataLen);
+                }
+                if ((outFill + len) > sizeof(out)) {
+                    if (trng_hostWriteAll(outFd, out, outFill) != 0) {
+                        perror(outPath);
+                        status = 1;
+                        _stop = 1;
+                        continue;
+                    }
+                    outFill = 0U;
+                }
+                (void)memcpy(&out[outFill], dec.payload, len);
+                outFill += len;
+                hdr.dataLen += len;
+                if ((limit != 0ULL) && (hdr.dataLen >= limit)) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if ((outFill != 0U) && (trng_hostWriteAll(outFd, out, outFill) != 0)) {
+        perror(outPath);
+        status = 1;
+    }
+    if (started != 0) {
+        /* Rewrite the header with the final length and gap count. */
+        trng_capEncode(hdrBytes, &hdr);
+        if ((pwrite(outFd, hdrBytes, sizeof(hdrBytes), 0) != (ssize_t)sizeof(hdrBytes)) ||
+            (fsync(outFd) != 0)) {
+            perror(outPath);
+            status = 1;
+        }
+    } else {
+        fprintf(stderr, "trng_capture: no device information frame received\n");
+        status = 1;
+    }
+    (void)close(outFd);
+
+    fprintf(stderr,
+        "trng_capture: %llu bytes recorded, %lu frames, %lu CRC errors, "
+        "%lu lost frames, %lu flagged frames\n",
+        (unsigned long long)hdr.dataLen, (unsigned long)dec.frames,
+        (unsigned long)dec.crcErrors, (unsigned long)hdr.lostFrames,
+        (unsigned long)dec.flagged);
+
+    return status;
+}
+
+/**
+ * @brief  Info mode.
+ * @return Process exit status.
+ */
+static int info(int argc, char **argv) {
+    int status = 0;
+    int i;
+
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    for (i = 1; i < argc; i++) {
+        trng_cap cap;
+        uint64_t hist[256];
+        double mean = 0.0;
+        double chi2 = 0.0;
+        double shannon = 0.0;
+        double expect;
+        size_t k;
+
+        if (trng_capMap(&cap, argv[i]) != 0) {
+            status = 1;
+            continue;
+        }
+        (void)memset(hist, 0, sizeof(hist));
+        for (k = 0U; k < cap.len; k++) {
+            hist[cap.data[k]]++;
+        }
+        expect = (double)cap.len / 256.0;
+        for (k = 0U; k < 256U; k++) {
+            double n = (double)hist[k];
+            mean += (double)k * n;
+            if (expect > 0.0) {
+                chi2 += ((n - expect) * (n - expect)) / expect;
+            }
+            if (hist[k] != 0U) {
+                shannon -= (n / (double)cap.len) * log2(n / (double)cap.len);
+            }
+        }
+        if (cap.len != 0U) {
+            mean /= (double)cap.len;
+        }
+
+        printf("%s\n  device   ", argv[i]);
+        printId(cap.hdr.deviceId);
+        printf("\n  source   %s\n",
+               (cap.hdr.source == TRNG_SOURCE_RAW) ? "raw" :
+               (cap.hdr.source == TRNG_SOURCE_CONDITIONED) ? "conditioned" : "unknown");
+        printf("  start    %llu ms (uptime %lu ms)\n",
+               (unsigned long long)cap.hdr.startMs, (unsigned long)cap.hdr.uptimeMs);
+        printf("  payload  %u bytes per frame\n", (unsigned)cap.hdr.payloadSize);
+        printf("  data     %zu bytes, %lu lost frames\n", cap.len,
+               (unsigned long)cap.hdr.lostFrames);
+        printf("  mean     %.4f (127.5 expected)\n", mean);
+        printf("  chi2     %.1f (255 degrees of freedom)\n", chi2);
+        printf("  entropy  %.6f bits per byte (Shannon)\n", shannon);
+        trng_capUnmap(&cap);
+    }
+
+    return status;
+}
+
+int main(int argc, char **argv) {
+    int status = 2;
+
+    if ((argc >= 2) && (strcmp(argv[1], "record") == 0)) {
+        status = record(argc - 1, &argv[1]);
+    } else if ((argc >= 2) && (strcmp(argv[1], "info") == 0)) {
+        status = info(argc - 1, &argv[1]);
+    } else {
+        usage();
+    }
+
+    return status;
+}
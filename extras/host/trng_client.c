@@ -0,0 +1,111 @@
+/*******************************************************************************
+ * @file    trng_client.c
+ * @brief   Client for trngd: fetches entropy or measures throughput.
+ *
+ * Sends batches of requests to the daemon socket, keeping up to -d requests
+ * in flight, and writes the received bytes to stdout (or discards them with
+ * -q). The achieved rate is printed to stderr.
+ *
+ * Build (Linux):
+ * @code
+ *   cc -O2 -o trng_client trng_client.c trng_host.c
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_client [-s socket] [-n bytes] [-r request] [-d depth] [-q]
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_host.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+int main(int argc, char **argv) {
+    static uint8_t buf[1U << 20];
+    struct sockaddr_un addr;
+    const char *sockPath = "/tmp/trngd.sock";
+    unsigned long long total = 1ULL << 20;
+    unsigned long long asked = 0ULL;
+    unsigned long long got = 0ULL;
+    unsigned long request = 4096UL;
+    unsigned long depth = 8UL;
+    int quiet = 0;
+    double start;
+    double secs;
+    int fd;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:n:r:d:qh")) != -1) {
+        switch (opt) {
+        case 's': sockPath = optarg; break;
+        case 'n': total = strtoull(optarg, NULL, 10); break;
+        case 'r': request = strtoul(optarg, NULL, 10); break;
+        case 'd': depth = strtoul(optarg, NULL, 10); break;
+        case 'q': quiet = 1; break;
+        default:
+            fprintf(stderr, "usage: trng_client [-s socket] [-n bytes] [-r request] [-d depth] [-q]\n");
+            return 2;
+        }
+    }
+    if ((request == 0UL) || (request > (1UL << 20)) || (depth == 0UL)) {
+        fprintf(stderr, "trng_client: invalid arguments\n");
+        return 2;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    (void)memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    (void)strncpy(addr.sun_path, sockPath, sizeof(addr.sun_path) - 1U);
+    if ((fd < 0) || (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)) {
+        perror(sockPath);
+        return 1;
+    }
+
+    start = trng_hostNow();
+    while (got < total) {
+        /* Keep up to depth requests in flight, sent in a single write. */
+        uint8_t reqs[64U * 4U];
+        size_t nreq = 0U;
+        while (((asked - got) < (depth * request)) && (asked < total) && (nreq < 64U)) {
+            unsigned long len = ((total - asked) < request) ? (unsigned long)(total - asked) : request;
+            reqs[nreq * 4U] = (uint8_t)(len & 0xFFU);
+            reqs[(nreq * 4U) + 1U] = (uint8_t)((len >> 8) & 0xFFU);
+            reqs[(nreq * 4U) + 2U] = (uint8_t)((len >> 16) & 0xFFU);
+            reqs[(nreq * 4U) + 3U] = (uint8_t)(len >> 24);
+            nreq++;
+            asked += len;
+        }
+        if ((nreq != 0U) && (trng_hostWriteAll(fd, reqs, nreq * 4U) != 0)) {
+            perror("trng_client: send");
+            return 1;
+        }
+
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+            if ((n < 0) && (errno == EINTR)) {
+                continue;
+            }
+            fprintf(stderr, "trng_client: connection closed\n");
+            return 1;
+        }
+        got += (unsigned long long)n;
+        if ((quiet == 0) && (trng_hostWriteAll(STDOUT_FILENO, buf, (size_t)n) != 0)) {
+            perror("trng_client: write");
+            return 1;
+        }
+    }
+    secs = trng_hostNow() - start;
+
+    fprintf(stderr, "trng_client: %llu bytes in %.3f s (%.2f MB/s)\n",
+            got, secs, ((double)got / secs) / 1e6);
+    (void)close(fd);
+    return 0;
+}
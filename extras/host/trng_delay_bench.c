@@ -0,0 +1,189 @@
+/*******************************************************************************
+ * @file    trng_delay_bench.c
+ * @brief   Distribution check and sampler overhead of the random delays.
+ *
+ * Builds src/trng_delay.c unchanged, with trng_read128() supplied by
+ * getrandom(). For both shapes at -b bits:
+ * - compares the histogram of -n delays with the exact distribution
+ *   (chi-square, mean and variance);
+ * - times trng_delaySample() per call in timestamp-counter ticks (x86) or
+ *   nanoseconds, next to drawing each delay from its own trng_read128()
+ *   call, the trng_random32() pattern;
+ * - prints the hardware reads per delay.
+ * Finally it times trng_delaySpin() to show its fixed cost per iteration.
+ *
+ * Build (Linux):
+ * @code
+ *   cc -O2 -I../../src -o trng_delay_bench trng_delay_bench.c trng_host.c ../../src/trng_delay.c -lm
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_delay_bench [-n delays] [-b bits]
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "trng_delay.h"
+#include "trng_host.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/random.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief  Host stand-in for the SCE5 read.
+ */
+uint8_t trng_read128(uint32_t *out) {
+    return (uint8_t)((getrandom(out, 16U, 0) == 16) ? TRNG_OK : TRNG_NOK);
+}
+
+/**
+ * @brief  Fine-grained timestamp: TSC ticks on x86, else nanoseconds.
+ */
+static uint64_t ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/** @brief qsort() comparator for tick counts. */
+static int cmpU64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief  Sort and print per-call costs.
+ */
+static void report(const char *label, uint64_t *t, unsigned long n) {
+    qsort(t, n, sizeof(uint64_t), cmpU64);
+    printf("  %-22s p50 %6llu  p99 %6llu  p99.9 %7llu  max %8llu ticks\n", label,
+           (unsigned long long)t[n / 2U], (unsigned long long)t[(n * 99U) / 100U],
+           (unsigned long long)t[(n * 999U) / 1000U], (unsigned long long)t[n - 1U]);
+}
+
+/**
+ * @brief  Check and time one shape.
+ * @return 0 if the chi-square statistic is plausible.
+ */
+static int run(const char *name, uint8_t bits, uint8_t shape, unsigned long n, uint64_t *t) {
+    uint32_t range = (shape == TRNG_DELAY_TRIANGLE) ? ((1UL << bits) - 1U) : (1UL << bits);
+    uint32_t half = 1UL << (bits - 1U);
+    unsigned long *hist = calloc(range, sizeof(unsigned long));
+    double mean = 0.0;
+    double var = 0.0;
+    double emean;
+    double evar;
+    double chi = 0.0;
+    uint32_t sink = 0U;
+    trng_delay d;
+    unsigned long i;
+    uint32_t k;
+    int fail;
+
+    if ((hist == NULL) || (trng_delayInit(&d, bits, shape) != TRNG_OK)) {
+        fprintf(stderr, "trng_delay_bench: bad bound or out of memory\n");
+        free(hist);
+        return 1;
+    }
+    for (i = 0UL; i < n; i++) {
+        uint32_t v = 0U;
+        uint64_t t0 = ticks();
+        (void)trng_delaySample(&d, &v);
+        t[i] = ticks() - t0;
+        hist[v]++;
+        mean += (double)v;
+        var += (double)v * (double)v;
+    }
+    mean /= (double)n;
+    var = (var / (double)n) - (mean * mean);
+    for (k = 0U; k < range; k++) {
+        /* Uniform: 1/range; triangular: (half - |k - (half - 1)|) / half^2. */
+        double p = (shape == TRNG_DELAY_TRIANGLE)
+            ? ((double)half - abs((int)k - (int)(half - 1U))) / ((double)half * (double)half)
+            : 1.0 / (double)range;
+        double e = p * (double)n;
+        chi += (((double)hist[k] - e) * ((double)hist[k] - e)) / e;
+    }
+    emean = (shape == TRNG_DELAY_TRIANGLE) ? (double)(half - 1U) : ((double)range - 1.0) / 2.0;
+    evar = (shape == TRNG_DELAY_TRIANGLE) ? (2.0 * (((double)half * half) - 1.0) / 12.0)
+                                          : (((double)range * range) - 1.0) / 12.0;
+    /* Mean of chi-square is range - 1 with sd sqrt(2 (range - 1)); allow 5 sd. */
+    fail = (chi > ((double)(range - 1U) + (5.0 * sqrt(2.0 * (double)(range - 1U))))) ? 1 : 0;
+    printf("%s, %u bits: mean %.3f (exact %.3f), variance %.2f (exact %.2f), chi-square %.1f on %u df%s\n",
+           name, (unsigned)bits, mean, emean, var, evar, chi, (unsigned)(range - 1U), (fail != 0) ? "  FAIL" : "");
+    printf("  %.4f hardware reads per delay\n", (double)d.hwReads / (double)n);
+    report("trng_delaySample", t, n);
+
+    for (i = 0UL; i < n; i++) {
+        uint32_t block[4];
+        uint64_t t0 = ticks();
+        (void)trng_read128(block);
+        sink ^= block[0] & (range - 1U);
+        t[i] = ticks() - t0;
+    }
+    report("read128 per delay", t, n);
+    free(hist);
+    return fail + ((sink == 0x5A5A5A5AU) ? 1 : 0);
+}
+
+int main(int argc, char **argv) {
+    unsigned long n = 1000000UL;
+    unsigned bits = 6U;
+    static const uint32_t spins[] = { 0U, 64U, 256U, 1024U };
+    uint64_t *t;
+    size_t k;
+    int rc = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:b:h")) != -1) {
+        switch (opt) {
+        case 'n': n = strtoul(optarg, NULL, 10); break;
+        case 'b': bits = (unsigned)strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: trng_delay_bench [-n delays] [-b bits]\n");
+            return 2;
+        }
+    }
+    if ((bits < 2U) || (bits > TRNG_DELAY_MAX_BITS)) {
+        fprintf(stderr, "trng_delay_bench: bits must be 2 to %u\n", (unsigned)TRNG_DELAY_MAX_BITS);
+        return 2;
+    }
+    if (n == 0UL) {
+        n = 1UL;
+    }
+    t = malloc(n * sizeof(uint64_t));
+    if (t == NULL) {
+        perror("trng_delay_bench");
+        return 1;
+    }
+
+    rc |= run("uniform", (uint8_t)bits, TRNG_DELAY_UNIFORM, n, t);
+    rc |= run("triangle", (uint8_t)bits, TRNG_DELAY_TRIANGLE, n, t);
+
+    printf("trng_delaySpin:");
+    for (k = 0U; k < (sizeof(spins) / sizeof(spins[0])); k++) {
+        double t0 = trng_hostNow();
+        unsigned r;
+        for (r = 0U; r < 1000U; r++) {
+            trng_delaySpin(spins[k]);
+        }
+        printf("  %u: %.1f ns", (unsigned)spins[k], ((trng_hostNow() - t0) / 1000.0) * 1e9);
+    }
+    printf("\n");
+    free(t);
+    return rc;
+}
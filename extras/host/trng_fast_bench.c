@@ -0,0 +1,242 @@
+/*******************************************************************************
+ * @file    trng_fast_bench.c
+ * @brief   Known-answer check and throughput of the fast tier on the host.
+ *
+ * Builds src/trng_fast.c unchanged, with trng_read128() supplied by
+ * getrandom(). Checks xoshiro256** and PCG32 against their reference
+ * outputs, xoshiro jump against a precomputed state and PCG advance
+ * against stepping, and the XOR functions against fill plus XOR. Then
+ * measures 32-bit output and buffer fills of both generators next to
+ * getrandom() itself, and in-place masking with trng_xoshiroXor() and
+ * trng_pcgXor() against the two-pass fill into a temporary buffer and
+ * XOR loop.
+ *
+ * Build (Linux):
+ * @code
+ *   cc -O2 -I../../src -o trng_fast_bench trng_fast_bench.c trng_host.c ../../src/trng_fast.c
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_fast_bench [-n outputs]
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "trng.h"
+#include "trng_fast.h"
+#include "trng_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+#include <unistd.h>
+
+/**
+ * @brief  Host stand-in for the SCE5 read.
+ */
+uint8_t trng_read128(uint32_t *out) {
+    return (uint8_t)((getrandom(out, 16U, 0) == 16) ? TRNG_OK : TRNG_NOK);
+}
+
+/**
+ * @brief  Reference output checks.
+ * @return Number of failures.
+ */
+static int check(void) {
+    static const uint64_t xoshiro[4] = { 11520U, 0U, 1509978240U, 1215971899390074240ULL };
+    static const uint32_t pcg[6] = {
+        0xa15c02b7U, 0x7b47f409U, 0xba1d3330U, 0x83d2f293U, 0xbfa4784bU, 0xcbed606eU
+    };
+    /* jump() of the state { 1, 2, 3, 4 }, from the transition matrix raised to 2^128. */
+    static const uint64_t jumped[4] = {
+        0x8c7a153956b5f3d1ULL, 0x701f1a713401d85eULL, 0x6527f66a65469085ULL, 0x8386b786c4408050ULL
+    };
+    trng_xoshiro x = { { 1U, 2U, 3U, 4U }, 0U, 0U };
+    trng_xoshiro y = x;
+    trng_pcg p = { 0U, (54U << 1) | 1U, 0U, 0U };
+    trng_pcg q;
+    int fails = 0;
+    unsigned i;
+
+    for (i = 0U; i < 4U; i++) {
+        if (trng_xoshiroNext64(&x) != xoshiro[i]) {
+            fprintf(stderr, "xoshiro256** output %u differs\n", i);
+            fails++;
+        }
+    }
+    trng_xoshiroJump(&y);
+    for (i = 0U; i < 4U; i++) {
+        if (y.s[i] != jumped[i]) {
+            fprintf(stderr, "xoshiro256** jump differs\n");
+            fails++;
+            break;
+        }
+    }
+    /* pcg32_srandom_r(42, 54) of the reference demo. */
+    (void)trng_pcgNext32(&p);
+    p.state += 42U;
+    (void)trng_pcgNext32(&p);
+    q = p;
+    for (i = 0U; i < 6U; i++) {
+        if (trng_pcgNext32(&p) != pcg[i]) {
+            fprintf(stderr, "pcg32 output %u differs\n", i);
+            fails++;
+        }
+    }
+    for (i = 0U; i < 100000U; i++) {
+        (void)trng_pcgNext32(&p);
+    }
+    trng_pcgAdvance(&q, 6U);
+    trng_pcgAdvance(&q, 100000U);
+    if (p.state != q.state) {
+        fprintf(stderr, "pcg32 advance differs from stepping\n");
+        fails++;
+    }
+    return fails;
+}
+
+/**
+ * @brief  Check that XOR masking equals fill plus XOR, at every length and
+ *         offset up to 40 bytes.
+ * @return Number of failures.
+ */
+static int checkXor(void) {
+    trng_xoshiro x = { { 1U, 2U, 3U, 4U }, 0U, 0U };
+    trng_pcg p = { 42U, (54U << 1) | 1U, 0U, 0U };
+    uint8_t data[48];
+    uint8_t mask[48];
+    uint8_t ref[48];
+    int fails = 0;
+    size_t off;
+    size_t len;
+    size_t i;
+
+    for (off = 0U; off < 8U; off++) {
+        for (len = 0U; len <= 40U; len++) {
+            trng_xoshiro x2 = x;
+            trng_pcg p2 = p;
+            for (i = 0U; i < sizeof(data); i++) {
+                data[i] = (uint8_t)(i * 37U);
+            }
+            memcpy(ref, data, sizeof(ref));
+            trng_xoshiroFill(&x2, mask, len);
+            for (i = 0U; i < len; i++) {
+                ref[off + i] ^= mask[i];
+            }
+            trng_pcgFill(&p2, mask, len);
+            for (i = 0U; i < len; i++) {
+                ref[off + i] ^= mask[i];
+            }
+            trng_xoshiroXor(&x, &data[off], len);
+            trng_pcgXor(&p, &data[off], len);
+            if (memcmp(data, ref, sizeof(data)) != 0) {
+                fprintf(stderr, "XOR of %zu bytes at offset %zu differs from fill\n", len, off);
+                fails++;
+            }
+        }
+    }
+    return fails;
+}
+
+int main(int argc, char **argv) {
+    unsigned long n = 1UL << 26;
+    static uint8_t buf[1U << 16];
+    static uint8_t tmp[1U << 16];
+    trng_xoshiro x;
+    trng_pcg p;
+    uint32_t sink = 0U;
+    unsigned long i;
+    double t0;
+    double secs;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:h")) != -1) {
+        switch (opt) {
+        case 'n': n = strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: trng_fast_bench [-n outputs]\n");
+            return 2;
+        }
+    }
+    if ((check() != 0) || (checkXor() != 0)) {
+        return 1;
+    }
+    printf("reference outputs and XOR: ok\n");
+    if ((trng_xoshiroSeed(&x, TRNG_FAST_RESEED) != TRNG_OK) ||
+        (trng_pcgSeed(&p, TRNG_FAST_RESEED) != TRNG_OK)) {
+        fprintf(stderr, "trng_fast_bench: seeding failed\n");
+        return 1;
+    }
+
+    t0 = trng_hostNow();
+    for (i = 0UL; i < n; i++) {
+        sink ^= trng_xoshiroNext32(&x);
+    }
+    secs = trng_hostNow() - t0;
+    printf("xoshiro256** next32  %8.1f M/s\n", ((double)n / secs) / 1e6);
+    t0 = trng_hostNow();
+    for (i = 0UL; i < n; i++) {
+        sink ^= trng_pcgNext32(&p);
+    }
+    secs = trng_hostNow() - t0;
+    printf("pcg32        next32  %8.1f M/s\n", ((double)n / secs) / 1e6);
+    t0 = trng_hostNow();
+    for (i = 0UL; i < (n / 64U); i++) {
+        uint32_t block[4];
+        (void)trng_read128(block);
+        sink ^= block[0];
+    }
+    secs = trng_hostNow() - t0;
+    printf("getrandom    read128 %8.1f M/s (32-bit words)\n", ((double)(n / 64U) * 4.0 / secs) / 1e6);
+
+    t0 = trng_hostNow();
+    for (i = 0UL; i < (n * 4U); i += sizeof(buf)) {
+        trng_xoshiroFill(&x, buf, sizeof(buf));
+    }
+    secs = trng_hostNow() - t0;
+    printf("xoshiro256** fill    %8.1f MB/s\n", ((double)(n * 4U) / secs) / 1e6);
+    t0 = trng_hostNow();
+    for (i = 0UL; i < (n * 4U); i += sizeof(buf)) {
+        trng_pcgFill(&p, buf, sizeof(buf));
+    }
+    secs = trng_hostNow() - t0;
+    printf("pcg32        fill    %8.1f MB/s\n", ((double)(n * 4U) / secs) / 1e6);
+
+    t0 = trng_hostNow();
+    for (i = 0UL; i < (n * 4U); i += sizeof(buf)) {
+        trng_xoshiroXor(&x, buf, sizeof(buf));
+    }
+    secs = trng_hostNow() - t0;
+    printf("xoshiro256** xor     %8.1f MB/s\n", ((double)(n * 4U) / secs) / 1e6);
+    t0 = trng_hostNow();
+    for (i = 0UL; i < (n * 4U); i += sizeof(buf)) {
+        size_t k;
+        trng_xoshiroFill(&x, tmp, sizeof(tmp));
+        for (k = 0U; k < sizeof(buf); k++) {
+            buf[k] ^= tmp[k];
+        }
+    }
+    secs = trng_hostNow() - t0;
+    printf("xoshiro256** 2-pass  %8.1f MB/s\n", ((double)(n * 4U) / secs) / 1e6);
+    t0 = trng_hostNow();
+    for (i = 0UL; i < (n * 4U); i += sizeof(buf)) {
+        trng_pcgXor(&p, buf, sizeof(buf));
+    }
+    secs = trng_hostNow() - t0;
+    printf("pcg32        xor     %8.1f MB/s\n", ((double)(n * 4U) / secs) / 1e6);
+    t0 = trng_hostNow();
+    for (i = 0UL; i < (n * 4U); i += sizeof(buf)) {
+        size_t k;
+        trng_pcgFill(&p, tmp, sizeof(tmp));
+        for (k = 0U; k < sizeof(buf); k++) {
+            buf[k] ^= tmp[k];
+        }
+    }
+    secs = trng_hostNow() - t0;
+    printf("pcg32        2-pass  %8.1f MB/s\n", ((double)(n * 4U) / secs) / 1e6);
+    sink ^= buf[0];
+    return (sink == 0x5A5A5A5AU) ? 3 : 0;
+}
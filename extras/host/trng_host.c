@@ -0,0 +1,114 @@
+/*******************************************************************************
+ * @file    trng_host.c
+ * @brief   Helpers shared by the host-side tools in extras/host.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_host.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief  Map a numeric baud rate to a termios speed constant.
+ * @return Speed constant, or B0 if unsupported.
+ */
+static speed_t baudToSpeed(long baud) {
+    switch (baud) {
+    case 9600L:    return B9600;
+    case 19200L:   return B19200;
+    case 38400L:   return B38400;
+    case 57600L:   return B57600;
+    case 115200L:  return B115200;
+    case 230400L:  return B230400;
+#ifdef B460800
+    case 460800L:  return B460800;
+#endif
+#ifdef B921600
+    case 921600L:  return B921600;
+#endif
+#ifdef B2000000
+    case 2000000L: return B2000000;
+#endif
+    default:       return B0;
+    }
+}
+
+/**
+ * @brief  Put a tty in raw 8N1 mode at the requested speed.
+ * @return 0 on success, -1 on error.
+ */
+static int setupTty(int fd, const char *path, long baud) {
+    struct termios tio;
+    speed_t speed = baudToSpeed(baud);
+
+    if (speed == B0) {
+        fprintf(stderr, "%s: unsupported baud rate %ld\n", path, baud);
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) != 0) {
+        perror(path);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    (void)cfsetispeed(&tio, speed);
+    (void)cfsetospeed(&tio, speed);
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        perror(path);
+        return -1;
+    }
+    (void)tcflush(fd, TCIFLUSH);
+    return 0;
+}
+
+int trng_hostOpenInput(const char *path, long baud, int nonblock) {
+    int fd;
+
+    if (strcmp(path, "-") == 0) {
+        fd = STDIN_FILENO;
+        if (nonblock != 0) {
+            (void)fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        }
+        return fd;
+    }
+
+    fd = open(path, O_RDONLY | O_NOCTTY | ((nonblock != 0) ? O_NONBLOCK : 0));
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    if ((isatty(fd) != 0) && (setupTty(fd, path, baud) != 0)) {
+        (void)close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int trng_hostWriteAll(int fd, const uint8_t *p, size_t len) {
+    while (len != 0U) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+double trng_hostNow(void) {
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
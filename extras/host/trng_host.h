@@ -0,0 +1,38 @@
+/*******************************************************************************
+ * @file    trng_host.h
+ * @brief   Helpers shared by the host-side tools in extras/host.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_HOST_H
+#define TRNG_HOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief   Open a serial device or capture file for reading.
+ *
+ * A tty is switched to raw 8N1 mode at @p baud. "-" opens stdin.
+ *
+ * @param      path      Device or file path.
+ * @param      baud      Serial speed, used only for ttys.
+ * @param      nonblock  Non-zero to open with O_NONBLOCK.
+ *
+ * @return  File descriptor, or -1 on error (reported on stderr).
+ */
+int trng_hostOpenInput(const char *path, long baud, int nonblock);
+
+/**
+ * @brief   Write a whole buffer to a blocking descriptor.
+ *
+ * @return  0 on success, -1 on error (errno set).
+ */
+int trng_hostWriteAll(int fd, const uint8_t *p, size_t len);
+
+/**
+ * @brief   Monotonic time in seconds.
+ */
+double trng_hostNow(void);
+
+#endif /* TRNG_HOST_H */
@@ -0,0 +1,204 @@
+/*******************************************************************************
+ * @file    trng_local.c
+ * @brief   Per-thread generators seeded from a shared TRNG source.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "trng_local.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+/** @brief ChaCha20 blocks per refill. */
+#define LOCAL_BLOCKS    16U
+/** @brief Bytes per refill; the first 32 become the next key. */
+#define LOCAL_BUF       (LOCAL_BLOCKS * 64U)
+
+/** @brief Generator of one thread. */
+typedef struct {
+    uint32_t key[8];            /**< ChaCha20 key. */
+    uint8_t  buf[LOCAL_BUF];    /**< Output of the last refill. */
+    size_t   pos;               /**< Next unserved byte in buf. */
+    size_t   sinceSeed;         /**< Bytes served since the last reseed. */
+    unsigned gen;               /**< _gen when seeded, 0 if unseeded. */
+} local_t;
+
+/** @brief Shared source and the lock that serializes it. */
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+static trng_local_source _src = NULL;
+static void *_srcCtx = NULL;
+/** @brief Incremented in the child after fork() to invalidate all states. */
+static atomic_uint _gen = 1U;
+static pthread_once_t _once = PTHREAD_ONCE_INIT;
+
+/** @brief Generator of the calling thread. */
+static __thread local_t _local;
+
+/** @brief ChaCha20 quarter round. */
+#define ROTL32(v, n)        (((v) << (n)) | ((v) >> (32U - (n))))
+#define QR(a, b, c, d)                                   \
+    do {                                                 \
+        (a) += (b); (d) ^= (a); (d) = ROTL32((d), 16U);  \
+        (c) += (d); (b) ^= (c); (b) = ROTL32((b), 12U);  \
+        (a) += (b); (d) ^= (a); (d) = ROTL32((d), 8U);   \
+        (c) += (d); (b) ^= (c); (b) = ROTL32((b), 7U);   \
+    } while (0)
+
+/**
+ * @brief  One ChaCha20 block (RFC 8439) with a 64-bit block counter and
+ *         zero nonce, written little-endian.
+ */
+static void chachaBlock(const uint32_t *key, uint64_t counter, uint8_t *out) {
+    uint32_t x[16];
+    uint32_t in[16] = {
+        0x61707865UL, 0x3320646EUL, 0x79622D32UL, 0x6B206574UL,
+        key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+        (uint32_t)counter, (uint32_t)(counter >> 32), 0U, 0U
+    };
+    unsigned i;
+
+    (void)memcpy(x, in, sizeof(x));
+    for (i = 0U; i < 10U; i++) {
+        QR(x[0], x[4], x[8], x[12]);
+        QR(x[1], x[5], x[9], x[13]);
+        QR(x[2], x[6], x[10], x[14]);
+        QR(x[3], x[7], x[11], x[15]);
+        QR(x[0], x[5], x[10], x[15]);
+        QR(x[1], x[6], x[11], x[12]);
+        QR(x[2], x[7], x[8], x[13]);
+        QR(x[3], x[4], x[9], x[14]);
+    }
+    for (i = 0U; i < 16U; i++) {
+        uint32_t v = x[i] + in[i];
+        out[(4U * i) + 0U] = (uint8_t)v;
+        out[(4U * i) + 1U] = (uint8_t)(v >> 8);
+        out[(4U * i) + 2U] = (uint8_t)(v >> 16);
+        out[(4U * i) + 3U] = (uint8_t)(v >> 24);
+    }
+}
+
+/**
+ * @brief  Produce the next buffer and key; the old key is overwritten.
+ */
+static void refill(local_t *g) {
+    unsigned i;
+
+    for (i = 0U; i < LOCAL_BLOCKS; i++) {
+        chachaBlock(g->key, i, &g->buf[64U * i]);
+    }
+    (void)memcpy(g->key, g->buf, sizeof(g->key));
+    (void)memset(g->buf, 0, sizeof(g->key));
+    g->pos = sizeof(g->key);
+}
+
+/**
+ * @brief  Mix 32 fresh bytes from the shared source into the key.
+ * @return 0 on success, -1 if no source is set.
+ */
+static int reseed(local_t *g) {
+    uint32_t seed[8];
+    trng_local_source src;
+    unsigned i;
+
+    (void)pthread_mutex_lock(&_lock);
+    src = _src;
+    if (src != NULL) {
+        src(_srcCtx, (uint8_t *)seed, sizeof(seed));
+    }
+    (void)pthread_mutex_unlock(&_lock);
+    if (src == NULL) {
+        return -1;
+    }
+    /* A fresh state (after fork or forget) starts from the seed alone. */
+    if (g->gen != atomic_load_explicit(&_gen, memory_order_relaxed)) {
+        (void)memset(g->key, 0, sizeof(g->key));
+    }
+    for (i = 0U; i < 8U; i++) {
+        g->key[i] ^= seed[i];
+    }
+    (void)memset(seed, 0, sizeof(seed));
+    g->gen = atomic_load_explicit(&_gen, memory_order_relaxed);
+    g->sinceSeed = 0U;
+    refill(g);
+    return 0;
+}
+
+/**
+ * @brief  fork() handlers: the source lock is held across fork() so the
+ *         child gets it unlocked, and no generator state survives into
+ *         the child.
+ */
+static void forkPrepare(void) {
+    (void)pthread_mutex_lock(&_lock);
+}
+
+static void forkParent(void) {
+    (void)pthread_mutex_unlock(&_lock);
+}
+
+static void forkChild(void) {
+    atomic_fetch_add(&_gen, 1U);
+    (void)pthread_mutex_unlock(&_lock);
+}
+
+/**
+ * @brief  Register the fork handlers once per process.
+ */
+static void registerFork(void) {
+    (void)pthread_atfork(forkPrepare, forkParent, forkChild);
+}
+
+void trng_localInit(trng_local_source src, void *ctx) {
+    (void)pthread_once(&_once, registerFork);
+    (void)pthread_mutex_lock(&_lock);
+    _src = src;
+    _srcCtx = ctx;
+    (void)pthread_mutex_unlock(&_lock);
+}
+
+int trng_localFill(uint8_t *buf, size_t len) {
+    local_t *g = &_local;
+    size_t done = 0U;
+
+    if ((g->gen != atomic_load_explicit(&_gen, memory_order_relaxed)) ||
+        (g->sinceSeed >= TRNG_LOCAL_RESEED)) {
+        if (reseed(g) != 0) {
+            return -1;
+        }
+    }
+    while (done < len) {
+        size_t n;
+        if (g->pos == LOCAL_BUF) {
+            refill(g);
+        }
+        n = ((LOCAL_BUF - g->pos) < (len - done)) ? (LOCAL_BUF - g->pos) : (len - done);
+        (void)memcpy(&buf[done], &g->buf[g->pos], n);
+        (void)memset(&g->buf[g->pos], 0, n);
+        g->pos += n;
+        done += n;
+    }
+    g->sinceSeed += len;
+    return 0;
+}
+
+int trng_localRandom32(uint32_t *out) {
+    local_t *g = &_local;
+
+    /* Fast path: four bytes left in the buffer and no reseed due. */
+    if ((g->gen == atomic_load_explicit(&_gen, memory_order_relaxed)) &&
+        (g->sinceSeed < TRNG_LOCAL_RESEED) &&
+        ((LOCAL_BUF - g->pos) >= sizeof(*out))) {
+        (void)memcpy(out, &g->buf[g->pos], sizeof(*out));
+        (void)memset(&g->buf[g->pos], 0, sizeof(*out));
+        g->pos += sizeof(*out);
+        g->sinceSeed += sizeof(*out);
+        return 0;
+    }
+    return trng_localFill((uint8_t *)out, sizeof(*out));
+}
+
+void trng_localForget(void) {
+    (void)memset(&_local, 0, sizeof(_local));
+}
@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * @file    trng_local.h
+ * @brief   Per-thread generators seeded from a shared TRNG source.
+ *
+ * A process that reads TRNG output on the host (a trngd ring lane, the
+ * daemon socket, a capture file) has one source that all of its threads
+ * must share under a lock. The functions below instead give every thread
+ * its own ChaCha20 generator, seeded from the shared source on first use
+ * and reseeded every TRNG_LOCAL_RESEED output bytes. The lock is taken
+ * only to read those 32-byte seeds, so generation never contends.
+ *
+ * Each generator uses fast key erasure: every refill produces the next key
+ * together with the output, and served bytes are wiped, so a state leak
+ * does not expose earlier output. A child process reseeds after fork().
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_LOCAL_H
+#define TRNG_LOCAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Output bytes per thread between reseeds from the shared source. */
+#define TRNG_LOCAL_RESEED   (1UL << 20)
+
+/**
+ * @brief   Shared source: fill @p dst with @p len TRNG bytes.
+ *
+ * Called with the process-wide source lock held. For a trngd ring,
+ * trng_ringReadWait() wrapped to take the trng_ring as @p ctx.
+ */
+typedef void (*trng_local_source)(void *ctx, uint8_t *dst, size_t len);
+
+/**
+ * @brief   Set the shared source of the process.
+ *
+ * Must be called before the first generator call. Generators already
+ * seeded keep their state until their next reseed.
+ */
+void trng_localInit(trng_local_source src, void *ctx);
+
+/**
+ * @brief   Random 32-bit value from the calling thread's generator.
+ *
+ * @return  0 on success, -1 if no source is set.
+ */
+int trng_localRandom32(uint32_t *out);
+
+/**
+ * @brief   Fill a buffer from the calling thread's generator.
+ *
+ * @return  0 on success, -1 if no source is set.
+ */
+int trng_localFill(uint8_t *buf, size_t len);
+
+/**
+ * @brief   Wipe the calling thread's generator; the next call reseeds.
+ */
+void trng_localForget(void);
+
+#endif /* TRNG_LOCAL_H */
@@ -0,0 +1,196 @@
+/*******************************************************************************
+ * @file    trng_local_bench.c
+ * @brief   Thread scaling of shared versus per-thread generators.
+ *
+ * For 1, 2, 4, ... up to -t threads, every thread draws -n random32
+ * values and then fills -n bytes in -c byte chunks, in two modes:
+ * - shared: each call takes the process-wide lock and reads the shared
+ *   source directly, as all threads of a process do without trng_local;
+ * - local: each call goes to the thread's own generator (trng_local.h),
+ *   which only takes the lock to reseed.
+ *
+ * The shared source is a trngd ring lane with -m, otherwise getrandom()
+ * stands in for it. Aggregate rates are printed per thread count.
+ *
+ * Build (Linux):
+ * @code
+ *   cc -O2 -pthread -o trng_local_bench trng_local_bench.c trng_local.c trng_ring.c trng_host.c
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_local_bench [-m shm_name] [-t threads] [-n count] [-c chunk]
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "trng_host.h"
+#include "trng_local.h"
+#include "trng_ring.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/random.h>
+#include <unistd.h>
+
+/** @brief Maximum number of threads. */
+#define BENCH_MAX_THREADS   256U
+
+/** @brief Lock a shared-mode caller takes around every read. */
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+static trng_ring _ring;
+static int _useRing = 0;
+static unsigned long _count = 1UL << 22;
+static size_t _chunk = 4096U;
+static pthread_barrier_t _start;
+
+/**
+ * @brief  Shared source: ring lane or getrandom().
+ */
+static void readSource(void *ctx, uint8_t *dst, size_t len) {
+    size_t got = 0U;
+
+    (void)ctx;
+    if (_useRing != 0) {
+        if (trng_ringReadWait(&_ring, dst, len, TRNG_RING_STALL) != 0) {
+            perror("trng_local_bench: ring");
+            exit(1);
+        }
+    } else {
+        while (got < len) {
+            ssize_t n = getrandom(&dst[got], len - got, 0);
+            got += (n > 0) ? (size_t)n : 0U;
+        }
+    }
+}
+
+/** @brief Per-thread arguments and results. */
+typedef struct {
+    int    local;
+    double r32Secs;
+    double fillSecs;
+} worker_t;
+
+/**
+ * @brief  Benchmark thread.
+ */
+static void *worker(void *arg) {
+    worker_t *w = arg;
+    uint8_t *buf = malloc(_chunk);
+    uint32_t sink = 0U;
+    unsigned long i;
+    double t0;
+
+    if (buf == NULL) {
+        return NULL;
+    }
+    (void)pthread_barrier_wait(&_start);
+    t0 = trng_hostNow();
+    for (i = 0UL; i < _count; i++) {
+        uint32_t v;
+        if (w->local != 0) {
+            (void)trng_localRandom32(&v);
+        } else {
+            (void)pthread_mutex_lock(&_lock);
+            readSource(NULL, (uint8_t *)&v, sizeof(v));
+            (void)pthread_mutex_unlock(&_lock);
+        }
+        sink ^= v;
+    }
+    w->r32Secs = trng_hostNow() - t0;
+
+    (void)pthread_barrier_wait(&_start);
+    t0 = trng_hostNow();
+    for (i = 0UL; i < _count; i += _chunk) {
+        if (w->local != 0) {
+            (void)trng_localFill(buf, _chunk);
+        } else {
+            (void)pthread_mutex_lock(&_lock);
+            readSource(NULL, buf, _chunk);
+            (void)pthread_mutex_unlock(&_lock);
+        }
+        sink ^= buf[0];
+    }
+    w->fillSecs = trng_hostNow() - t0;
+    free(buf);
+    /* Keep the loops from being optimized away. */
+    return (sink == 0x5A5A5A5AU) ? arg : NULL;
+}
+
+/**
+ * @brief  Run one configuration and print aggregate rates.
+ * @return 0 on success, -1 if threads could not be started.
+ */
+static int run(unsigned threads, int local) {
+    static worker_t w[BENCH_MAX_THREADS];
+    pthread_t tid[BENCH_MAX_THREADS];
+    double r32 = 0.0;
+    double fill = 0.0;
+    unsigned i;
+
+    (void)pthread_barrier_init(&_start, NULL, threads);
+    for (i = 0U; i < threads; i++) {
+        w[i].local = local;
+        if (pthread_create(&tid[i], NULL, worker, &w[i]) != 0) {
+            perror("pthread_create");
+            return -1;
+        }
+    }
+    for (i = 0U; i < threads; i++) {
+        (void)pthread_join(tid[i], NULL);
+        r32 = (w[i].r32Secs > r32) ? w[i].r32Secs : r32;
+        fill = (w[i].fillSecs > fill) ? w[i].fillSecs : fill;
+    }
+    (void)pthread_barrier_destroy(&_start);
+    printf("%3u threads %-6s random32 %8.2f M/s   fillRandom %8.1f MB/s\n", threads,
+           (local != 0) ? "local" : "shared", ((double)_count * threads / r32) / 1e6,
+           ((double)_count * threads / fill) / 1e6);
+    (void)fflush(stdout);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    unsigned maxThreads = (unsigned)sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned n;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:t:n:c:h")) != -1) {
+        switch (opt) {
+        case 'm':
+            if (trng_ringOpen(&_ring, optarg) != 0) {
+                perror(optarg);
+                return 1;
+            }
+            _useRing = 1;
+            break;
+        case 't': maxThreads = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'n': _count = strtoul(optarg, NULL, 10); break;
+        case 'c': _chunk = (size_t)strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: trng_local_bench [-m shm_name] [-t threads] [-n count] [-c chunk]\n");
+            return 2;
+        }
+    }
+    if ((maxThreads < 1U) || (maxThreads > BENCH_MAX_THREADS) || (_chunk == 0U)) {
+        fprintf(stderr, "trng_local_bench: invalid arguments\n");
+        return 2;
+    }
+
+    trng_localInit(readSource, NULL);
+    printf("%lu random32 calls and %lu bytes in %zu-byte fills per thread, source %s\n",
+           _count, _count, _chunk, (_useRing != 0) ? "ring" : "getrandom");
+    for (n = 1U; ; n = (n * 2U > maxThreads) ? maxThreads : (n * 2U)) {
+        if ((run(n, 0) != 0) || (run(n, 1) != 0)) {
+            return 1;
+        }
+        if (n == maxThreads) {
+            break;
+        }
+    }
+    if (_useRing != 0) {
+        trng_ringClose(&_ring);
+    }
+    return 0;
+}
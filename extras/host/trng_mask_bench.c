@@ -0,0 +1,199 @@
+/*******************************************************************************
+ * @file    trng_mask_bench.c
+ * @brief   Mask stream latency and underflows under a simulated slow TRNG.
+ *
+ * Builds src/trng_mask.c unchanged. trng_read128() is supplied by
+ * getrandom() plus a busy wait of -l microseconds per block, with up to
+ * -j microseconds of uniform jitter, to model the SCE5 latency.
+ *
+ * A consumer takes -n masks with trng_maskNext(), spending -g microseconds
+ * of busy "cipher work" between two masks. The ring is refilled in the
+ * background in one of two ways:
+ * - tick (default): a timer-interrupt model. Every -p microseconds the
+ *   consumer is preempted and, if trng_maskLow(), trng_maskRefill() reads
+ *   at most -b blocks, the time it takes being stolen from the consumer;
+ * - thread (-t): a producer thread refills whenever trng_maskLow(), to
+ *   exercise the lock-free ring with real concurrency (needs two CPUs).
+ * The same consumer is then run with one trng_read128() per mask, the
+ * trng_random32() pattern, for comparison.
+ *
+ * Build (Linux):
+ * @code
+ *   cc -O2 -pthread -I../../src -o trng_mask_bench trng_mask_bench.c trng_host.c ../../src/trng_mask.c
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_mask_bench [-n masks] [-s ring_words] [-r reserve] [-l us_per_block]
+ *                   [-j jitter_us] [-g us_between_masks] [-p tick_us] [-b blocks_per_tick] [-t]
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "trng_host.h"
+#include "trng_mask.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/random.h>
+#include <unistd.h>
+
+static double _blockDelay = 2e-6;
+static double _jitter = 2e-6;
+static volatile int _stop = 0;
+
+/**
+ * @brief  Busy wait until @p until (trng_hostNow() time).
+ */
+static void spinUntil(double until) {
+    while (trng_hostNow() < until) {
+    }
+}
+
+/**
+ * @brief  Host stand-in for the SCE5 read, with simulated latency.
+ */
+uint8_t trng_read128(uint32_t *out) {
+    uint8_t result = (getrandom(out, 16U, 0) == 16) ? TRNG_OK : TRNG_NOK;
+    double delay = _blockDelay;
+
+    if (_jitter > 0.0) {
+        delay += _jitter * ((double)(out[0] & 0xFFFFU) / 65536.0);
+    }
+    spinUntil(trng_hostNow() + delay);
+    return result;
+}
+
+/** @brief Producer thread of -t: refill whenever the ring runs low. */
+static void *producer(void *arg) {
+    trng_mask *m = (trng_mask *)arg;
+
+    while (_stop == 0) {
+        if (trng_maskLow(m) != 0U) {
+            (void)trng_maskRefill(m, 0U);
+        }
+    }
+    return NULL;
+}
+
+/** @brief qsort() comparator for latencies. */
+static int cmpDouble(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief  Sort and print per-mask latencies.
+ */
+static void report(const char *label, double *lat, unsigned long n) {
+    qsort(lat, n, sizeof(double), cmpDouble);
+    printf("%-14s p50 %8.3f us  p99 %8.3f us  p99.99 %8.3f us  max %8.3f us\n", label, lat[n / 2U] * 1e6,
+           lat[(n * 99U) / 100U] * 1e6, lat[(n * 9999U) / 10000U] * 1e6, lat[n - 1U] * 1e6);
+}
+
+int main(int argc, char **argv) {
+    unsigned long n = 200000UL;
+    uint32_t size = 256U;
+    uint32_t reserve = 64U;
+    uint32_t maxBlocks = 8U;
+    double gap = 5e-6;
+    double tick = 100e-6;
+    int threaded = 0;
+    uint32_t *ring;
+    double *lat;
+    trng_mask m;
+    pthread_t th;
+    uint32_t sink = 0U;
+    double nextTick;
+    unsigned long i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:r:l:j:g:p:b:th")) != -1) {
+        switch (opt) {
+        case 'n': n = strtoul(optarg, NULL, 10); break;
+        case 's': size = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'r': reserve = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'l': _blockDelay = strtod(optarg, NULL) / 1e6; break;
+        case 'j': _jitter = strtod(optarg, NULL) / 1e6; break;
+        case 'g': gap = strtod(optarg, NULL) / 1e6; break;
+        case 'p': tick = strtod(optarg, NULL) / 1e6; break;
+        case 'b': maxBlocks = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 't': threaded = 1; break;
+        default:
+            fprintf(stderr, "usage: trng_mask_bench [-n masks] [-s ring_words] [-r reserve] [-l us_per_block]\n"
+                            "                       [-j jitter_us] [-g us_between_masks] [-p tick_us]"
+                            " [-b blocks_per_tick] [-t]\n");
+            return 2;
+        }
+    }
+    if (n == 0UL) {
+        n = 1UL;
+    }
+    ring = malloc((size_t)size * sizeof(uint32_t));
+    lat = malloc(n * sizeof(double));
+    if ((ring == NULL) || (lat == NULL) || (trng_maskInit(&m, ring, size, reserve) != TRNG_OK)) {
+        fprintf(stderr, "trng_mask_bench: bad ring size (power of two >= 4) or reserve, or out of memory\n");
+        return 1;
+    }
+
+    printf("%lu masks every %.1f us, %.1f+%.1f us per block, ring %u words, reserve %u, %s\n", n, gap * 1e6,
+           _blockDelay * 1e6, _jitter * 1e6, (unsigned)size, (unsigned)reserve,
+           (threaded != 0) ? "producer thread" : "timer tick");
+
+    (void)trng_maskRefill(&m, 0U);
+    if ((threaded != 0) && (pthread_create(&th, NULL, producer, &m) != 0)) {
+        perror("trng_mask_bench");
+        return 1;
+    }
+    nextTick = trng_hostNow() + tick;
+    for (i = 0UL; i < n; i++) {
+        double t0 = trng_hostNow();
+        double until;
+        uint32_t mask;
+        if (trng_maskNext(&m, &mask) != TRNG_OK) {
+            fprintf(stderr, "trng_mask_bench: no mask at %lu\n", i);
+            return 1;
+        }
+        sink ^= mask;
+        lat[i] = trng_hostNow() - t0;
+
+        /* Cipher work, preempted by the refill tick. */
+        until = trng_hostNow() + gap;
+        while (trng_hostNow() < until) {
+            if ((threaded == 0) && (trng_hostNow() >= nextTick)) {
+                if (trng_maskLow(&m) != 0U) {
+                    double t1 = trng_hostNow();
+                    (void)trng_maskRefill(&m, maxBlocks);
+                    until += trng_hostNow() - t1;
+                }
+                nextTick += tick;
+            }
+        }
+    }
+    if (threaded != 0) {
+        _stop = 1;
+        (void)pthread_join(th, NULL);
+    }
+    report("trng_maskNext", lat, n);
+    printf("               underflows %u  failures %u  low water %u words\n", (unsigned)m.underflows,
+           (unsigned)m.failures, (unsigned)m.lowWater);
+
+    /* Baseline: one hardware block per mask. */
+    for (i = 0UL; i < n; i++) {
+        uint32_t block[4];
+        double t0 = trng_hostNow();
+        (void)trng_read128(block);
+        sink ^= block[0];
+        lat[i] = trng_hostNow() - t0;
+        spinUntil(trng_hostNow() + gap);
+    }
+    report("read128/mask", lat, n);
+
+    trng_maskFree(&m);
+    free(ring);
+    free(lat);
+    return (sink == 0x5A5A5A5AU) ? 3 : 0;
+}
@@ -0,0 +1,205 @@
+/*******************************************************************************
+ * @file    trng_mbedtls_bench.c
+ * @brief   Handshake random-byte latency of mbedTLS with the TRNG source.
+ *
+ * Builds src/trng_mbedtls.c unchanged against the system mbedTLS, with
+ * trng_read128() supplied by a trngd ring lane (-m) or getrandom(). Each
+ * simulated handshake seeds a fresh CTR_DRBG from a shared entropy context
+ * (as a per-connection mbedtls_ssl_conf_rng() setup does) and then draws
+ * the random bytes of an ECDHE-ECDSA client handshake: the 32-byte client
+ * random, a P-256 ephemeral key and the blinding values of two scalar
+ * multiplications. Three sources are compared:
+ * - direct: a callback reading the hardware for every byte of every poll,
+ *   the usual wrapper around trng_fillRandom();
+ * - pool: trng_mbedtlsPoll() with an empty buffer, so polls read the
+ *   hardware for their chunk only;
+ * - prefilled: trng_mbedtlsPoll() refilled between handshakes, as loop()
+ *   would do, so handshakes do not wait on the hardware.
+ *
+ * -l adds a busy wait per 128-bit block to model a slower noise source.
+ * The entropy context also polls the platform source of the system
+ * mbedTLS build, a fixed cost in all three modes.
+ *
+ * Build (Linux, mbedTLS 2.28 or 3.x development files):
+ * @code
+ *   cc -O2 -I../../src -o trng_mbedtls_bench trng_mbedtls_bench.c trng_ring.c trng_host.c ../../src/trng_mbedtls.c -lmbedcrypto
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_mbedtls_bench [-m shm_name] [-n handshakes] [-l us_per_block]
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+
+#include "trng_host.h"
+#include "trng_mbedtls.h"
+#include "trng_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+#include <unistd.h>
+
+/** @brief Random-byte requests of one client handshake. */
+static const size_t _requests[] = { 32U, 32U, 32U, 32U };
+
+static trng_ring _ring;
+static int _useRing = 0;
+static double _blockDelay = 0.0;
+static unsigned long _blocks = 0UL;
+
+/**
+ * @brief  Host stand-in for the SCE5 read.
+ */
+uint8_t trng_read128(uint32_t *out) {
+    uint8_t result = TRNG_OK;
+
+    if (_useRing != 0) {
+        if (trng_ringReadWait(&_ring, (uint8_t *)out, 16U, TRNG_RING_STALL) != 0) {
+            (void)memset(out, 0, 16U);
+            result = TRNG_NOK;
+        }
+    } else if (getrandom(out, 16U, 0) != 16) {
+        result = TRNG_NOK;
+    }
+    if (_blockDelay > 0.0) {
+        double until = trng_hostNow() + _blockDelay;
+        while (trng_hostNow() < until) {
+        }
+    }
+    _blocks++;
+    return result;
+}
+
+/**
+ * @brief  Baseline source: every poll reads the hardware for all of @p len.
+ */
+static int directPoll(void *data, unsigned char *output, size_t len, size_t *olen) {
+    uint32_t block[4];
+    size_t done = 0U;
+
+    (void)data;
+    while (done < len) {
+        size_t n = ((len - done) < 16U) ? (len - done) : 16U;
+        if (trng_read128(block) != TRNG_OK) {
+            return MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
+        }
+        memcpy(&output[done], block, n);
+        done += n;
+    }
+    *olen = len;
+    return 0;
+}
+
+/** @brief qsort() comparator for latencies. */
+static int cmpDouble(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief  Run @p n handshakes with one source and print their latency.
+ * @param  mode  0 direct, 1 pool, 2 prefilled.
+ * @return 0 on success.
+ */
+static int run(const char *label, int mode, unsigned long n, double *lat) {
+    mbedtls_entropy_context entropy;
+    trng_mbedtls src;
+    unsigned char out[64];
+    unsigned long blocks = 0UL;
+    double sum = 0.0;
+    unsigned long i;
+    int ret;
+
+    trng_mbedtlsInit(&src, 0U);
+    mbedtls_entropy_init(&entropy);
+    ret = (mode == 0)
+        ? mbedtls_entropy_add_source(&entropy, directPoll, NULL, TRNG_MBEDTLS_THRESHOLD,
+                                     MBEDTLS_ENTROPY_SOURCE_STRONG)
+        : trng_mbedtlsAddSource(&entropy, &src);
+
+    for (i = 0UL; (i < n) && (ret == 0); i++) {
+        mbedtls_ctr_drbg_context drbg;
+        unsigned long b0;
+        double t0;
+        size_t k;
+
+        if ((mode == 2) && (trng_mbedtlsRefill(&src) != TRNG_OK)) {
+            ret = -1;
+            break;
+        }
+        b0 = _blocks;
+        t0 = trng_hostNow();
+        mbedtls_ctr_drbg_init(&drbg);
+        ret = mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy, (const unsigned char *)"hs", 2U);
+        for (k = 0U; (k < (sizeof(_requests) / sizeof(_requests[0]))) && (ret == 0); k++) {
+            ret = mbedtls_ctr_drbg_random(&drbg, out, _requests[k]);
+        }
+        lat[i] = trng_hostNow() - t0;
+        blocks += _blocks - b0;
+        sum += lat[i];
+        mbedtls_ctr_drbg_free(&drbg);
+    }
+    mbedtls_entropy_free(&entropy);
+    trng_mbedtlsFree(&src);
+    if (ret != 0) {
+        fprintf(stderr, "%s: mbedTLS error -0x%04x\n", label, (unsigned)-ret);
+        return 1;
+    }
+
+    qsort(lat, n, sizeof(double), cmpDouble);
+    printf("%-10s mean %8.2f us  p50 %8.2f us  p99 %8.2f us  %5.1f blocks/handshake\n", label,
+           (sum / (double)n) * 1e6, lat[n / 2U] * 1e6, lat[(n * 99U) / 100U] * 1e6,
+           (double)blocks / (double)n);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    unsigned long n = 10000UL;
+    double *lat;
+    int rc = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:n:l:h")) != -1) {
+        switch (opt) {
+        case 'm':
+            if (trng_ringOpen(&_ring, optarg) != 0) {
+                return 1;
+            }
+            _useRing = 1;
+            break;
+        case 'n': n = strtoul(optarg, NULL, 10); break;
+        case 'l': _blockDelay = strtod(optarg, NULL) / 1e6; break;
+        default:
+            fprintf(stderr, "usage: trng_mbedtls_bench [-m shm_name] [-n handshakes] [-l us_per_block]\n");
+            return 2;
+        }
+    }
+    if (n == 0UL) {
+        n = 1UL;
+    }
+    lat = malloc(n * sizeof(double));
+    if (lat == NULL) {
+        perror("trng_mbedtls_bench");
+        return 1;
+    }
+
+    printf("%lu handshakes, source %s, %.1f us per block\n", n, (_useRing != 0) ? "ring" : "getrandom",
+           _blockDelay * 1e6);
+    rc |= run("direct", 0, n, lat);
+    rc |= run("pool", 1, n, lat);
+    rc |= run("prefilled", 2, n, lat);
+
+    free(lat);
+    if (_useRing != 0) {
+        trng_ringClose(&_ring);
+    }
+    return rc;
+}
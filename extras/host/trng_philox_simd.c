@@ -0,0 +1,208 @@
+/*******************************************************************************
+ * @file    trng_philox_simd.c
+ * @brief   Vectorized Philox4x32-10 for the host.
+ *
+ * Each vector lane holds one counter word of a different block (structure
+ * of arrays), so a round is two widening multiplies and a few xors per
+ * vector. The blocks are transposed back to stream order on store.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_philox_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PHILOX_AVX2     1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PHILOX_NEON     1
+#endif
+
+/** @brief Round constants, as in trng_philox.c. */
+#define PHILOX_M0   0xD2511F53U
+#define PHILOX_M1   0xCD9E8D57U
+#define PHILOX_W0   0x9E3779B9U
+#define PHILOX_W1   0xBB67AE85U
+
+/** @brief Blocks computed by one call of a vector kernel. */
+typedef size_t (*kernel_fn)(const trng_philox *p, uint64_t block, uint32_t *out, size_t blocks);
+
+#ifdef PHILOX_AVX2
+/**
+ * @brief  High and low halves of eight 32 x 32-bit products.
+ */
+__attribute__((target("avx2")))
+static inline void mulhilo8(__m256i a, __m256i m, __m256i *hi, __m256i *lo) {
+    __m256i even = _mm256_mul_epu32(a, m);
+    __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+
+    *lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    *hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+/**
+ * @brief  Eight blocks per iteration.
+ * @return Number of blocks computed (a multiple of 8).
+ */
+__attribute__((target("avx2")))
+static size_t kernelAvx2(const trng_philox *p, uint64_t block, uint32_t *out, size_t blocks) {
+    const __m256i m0 = _mm256_set1_epi32((int)PHILOX_M0);
+    const __m256i m1 = _mm256_set1_epi32((int)PHILOX_M1);
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    size_t done = 0U;
+
+    /* Stop before a group whose lanes would carry into the upper word. */
+    while (((blocks - done) >= 8U) && ((uint32_t)(block + done) <= (UINT32_MAX - 7U))) {
+        uint64_t b = block + done;
+        __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32((int)(uint32_t)b), lane);
+        __m256i c1 = _mm256_set1_epi32((int)(uint32_t)(b >> 32));
+        __m256i c2 = _mm256_set1_epi32((int)p->stream[0]);
+        __m256i c3 = _mm256_set1_epi32((int)p->stream[1]);
+        uint32_t k0 = p->key[0];
+        uint32_t k1 = p->key[1];
+        __m256i t0;
+        __m256i t1;
+        __m256i t2;
+        __m256i t3;
+        __m256i *dst = (__m256i *)&out[done * 4U];
+        unsigned r;
+
+        for (r = 0U; r < 10U; r++) {
+            __m256i hi0;
+            __m256i lo0;
+            __m256i hi1;
+            __m256i lo1;
+            mulhilo8(c0, m0, &hi0, &lo0);
+            mulhilo8(c2, m1, &hi1, &lo1);
+            c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32((int)k0));
+            c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32((int)k1));
+            c1 = lo1;
+            c3 = lo0;
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+
+        /* 4 x 8 transpose: lane j of c0..c3 is block j. */
+        t0 = _mm256_unpacklo_epi32(c0, c1);
+        t1 = _mm256_unpackhi_epi32(c0, c1);
+        t2 = _mm256_unpacklo_epi32(c2, c3);
+        t3 = _mm256_unpackhi_epi32(c2, c3);
+        c0 = _mm256_unpacklo_epi64(t0, t2);     /* blocks 0, 4 */
+        c1 = _mm256_unpackhi_epi64(t0, t2);     /* blocks 1, 5 */
+        c2 = _mm256_unpacklo_epi64(t1, t3);     /* blocks 2, 6 */
+        c3 = _mm256_unpackhi_epi64(t1, t3);     /* blocks 3, 7 */
+        _mm256_storeu_si256(&dst[0], _mm256_permute2x128_si256(c0, c1, 0x20));
+        _mm256_storeu_si256(&dst[1], _mm256_permute2x128_si256(c2, c3, 0x20));
+        _mm256_storeu_si256(&dst[2], _mm256_permute2x128_si256(c0, c1, 0x31));
+        _mm256_storeu_si256(&dst[3], _mm256_permute2x128_si256(c2, c3, 0x31));
+        done += 8U;
+    }
+    return done;
+}
+#endif /* PHILOX_AVX2 */
+
+#ifdef PHILOX_NEON
+/**
+ * @brief  High and low halves of four 32 x 32-bit products.
+ */
+static inline void mulhilo4(uint32x4_t a, uint32x4_t m, uint32x4_t *hi, uint32x4_t *lo) {
+    uint32x4_t pl = vreinterpretq_u32_u64(vmull_u32(vget_low_u32(a), vget_low_u32(m)));
+    uint32x4_t ph = vreinterpretq_u32_u64(vmull_high_u32(a, m));
+
+    *lo = vuzp1q_u32(pl, ph);
+    *hi = vuzp2q_u32(pl, ph);
+}
+
+/**
+ * @brief  Four blocks per iteration.
+ * @return Number of blocks computed (a multiple of 4).
+ */
+static size_t kernelNeon(const trng_philox *p, uint64_t block, uint32_t *out, size_t blocks) {
+    static const uint32_t laneInit[4] = { 0U, 1U, 2U, 3U };
+    const uint32x4_t m0 = vdupq_n_u32(PHILOX_M0);
+    const uint32x4_t m1 = vdupq_n_u32(PHILOX_M1);
+    const uint32x4_t lane = vld1q_u32(laneInit);
+    size_t done = 0U;
+
+    while (((blocks - done) >= 4U) && ((uint32_t)(block + done) <= (UINT32_MAX - 3U))) {
+        uint64_t b = block + done;
+        uint32x4x4_t c;
+        uint32_t k0 = p->key[0];
+        uint32_t k1 = p->key[1];
+        unsigned r;
+
+        c.val[0] = vaddq_u32(vdupq_n_u32((uint32_t)b), lane);
+        c.val[1] = vdupq_n_u32((uint32_t)(b >> 32));
+        c.val[2] = vdupq_n_u32(p->stream[0]);
+        c.val[3] = vdupq_n_u32(p->stream[1]);
+        for (r = 0U; r < 10U; r++) {
+            uint32x4_t hi0;
+            uint32x4_t lo0;
+            uint32x4_t hi1;
+            uint32x4_t lo1;
+            mulhilo4(c.val[0], m0, &hi0, &lo0);
+            mulhilo4(c.val[2], m1, &hi1, &lo1);
+            c.val[0] = veorq_u32(veorq_u32(hi1, c.val[1]), vdupq_n_u32(k0));
+            c.val[2] = veorq_u32(veorq_u32(hi0, c.val[3]), vdupq_n_u32(k1));
+            c.val[1] = lo1;
+            c.val[3] = lo0;
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+        /* Interleaving store: lane j of the four vectors is block j. */
+        vst4q_u32(&out[done * 4U], c);
+        done += 4U;
+    }
+    return done;
+}
+#endif /* PHILOX_NEON */
+
+/**
+ * @brief  Vector kernel for this CPU, NULL for scalar only.
+ */
+static kernel_fn kernel(void) {
+#if defined(PHILOX_AVX2)
+    return (__builtin_cpu_supports("avx2") != 0) ? kernelAvx2 : NULL;
+#elif defined(PHILOX_NEON)
+    return kernelNeon;
+#else
+    return NULL;
+#endif
+}
+
+const char *trng_philoxSimdName(void) {
+#if defined(PHILOX_AVX2)
+    return (kernel() != NULL) ? "avx2" : "scalar";
+#elif defined(PHILOX_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+void trng_philoxFillSimd(const trng_philox *p, uint64_t index, uint32_t *out, size_t words) {
+    kernel_fn k = kernel();
+    size_t head = (size_t)((4U - (index & 3U)) & 3U);
+    uint64_t block;
+    size_t done;
+
+    if ((k == NULL) || (words < 64U)) {
+        trng_philoxFill(p, index, out, words);
+        return;
+    }
+    /* Partial first block, whole blocks in vectors, then the rest. */
+    trng_philoxFill(p, index, out, head);
+    block = (index + head) >> 2;
+    done = head;
+    while ((words - done) >= 4U) {
+        size_t n = k(p, block, &out[done], (words - done) / 4U);
+        if (n == 0U) {
+            /* Carry into the upper counter word within a group. */
+            trng_philoxFill(p, block * 4U, &out[done], 4U);
+            n = 1U;
+        }
+        block += n;
+        done += n * 4U;
+    }
+    trng_philoxFill(p, block * 4U, &out[done], words - done);
+}
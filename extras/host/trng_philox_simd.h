@@ -0,0 +1,29 @@
+/*******************************************************************************
+ * @file    trng_philox_simd.h
+ * @brief   Vectorized Philox4x32-10 for the host.
+ *
+ * Same output as trng_philoxFill() (src/trng_philox.h), computed eight
+ * blocks at a time with AVX2 on x86-64 or four at a time with NEON on
+ * AArch64. The AVX2 path is selected at run time, so one binary runs on
+ * any x86-64 CPU; other targets use the scalar code.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_PHILOX_SIMD_H
+#define TRNG_PHILOX_SIMD_H
+
+#include "trng_philox.h"
+
+/**
+ * @brief   Compute words @p index .. @p index + @p words - 1 of a stream.
+ */
+void trng_philoxFillSimd(const trng_philox *p, uint64_t index, uint32_t *out, size_t words);
+
+/**
+ * @brief   Name of the implementation trng_philoxFillSimd() uses.
+ *
+ * @return  "avx2", "neon" or "scalar".
+ */
+const char *trng_philoxSimdName(void);
+
+#endif /* TRNG_PHILOX_SIMD_H */
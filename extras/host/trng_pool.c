@@ -0,0 +1,273 @@
+/*******************************************************************************
+ * @file    trng_pool.c
+ * @brief   Work-stealing thread pool for the host analysis tools.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "trng_pool.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/** @brief Queued task. */
+typedef struct {
+    trng_task_fn fn;
+    void        *arg;
+} task_t;
+
+/** @brief Per-worker deque (circular buffer). */
+typedef struct {
+    pthread_mutex_t lock;
+    task_t         *items;
+    size_t          cap;
+    size_t          head;
+    size_t          count;
+} deque_t;
+
+struct trng_pool {
+    unsigned         n;         /**< Number of workers. */
+    pthread_t       *threads;   /**< Worker threads. */
+    deque_t         *q;         /**< One deque per worker. */
+    pthread_mutex_t  lock;      /**< Protects the condition variables. */
+    pthread_cond_t   work;      /**< Signalled when a task is queued. */
+    pthread_cond_t   idle;      /**< Signalled when pending drops to 0. */
+    atomic_size_t    queued;    /**< Tasks waiting in the deques. */
+    size_t           pending;   /**< Tasks submitted and not finished. */
+    atomic_uint      next;      /**< Round-robin target for outside submits. */
+    int              stop;      /**< Set by trng_poolDestroy(). */
+};
+
+/** @brief Worker argument. */
+typedef struct {
+    trng_pool *pool;
+    unsigned   index;
+} worker_t;
+
+/** @brief Pool of the calling worker thread, NULL outside the pool. */
+static __thread trng_pool *_self = NULL;
+/** @brief Index of the calling worker thread. */
+static __thread unsigned _selfIndex = 0U;
+
+/**
+ * @brief  Push a task at the tail of a deque.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int dequePush(deque_t *d, trng_task_fn fn, void *arg) {
+    int rc = 0;
+
+    (void)pthread_mutex_lock(&d->lock);
+    if (d->count == d->cap) {
+        size_t cap = (d->cap == 0U) ? 64U : (d->cap * 2U);
+        task_t *items = malloc(cap * sizeof(*items));
+        if (items == NULL) {
+            rc = -1;
+        } else {
+            size_t i;
+            for (i = 0U; i < d->count; i++) {
+                items[i] = d->items[(d->head + i) % d->cap];
+            }
+            free(d->items);
+            d->items = items;
+            d->cap = cap;
+            d->head = 0U;
+        }
+    }
+    if (rc == 0) {
+        d->items[(d->head + d->count) % d->cap] = (task_t){ fn, arg };
+        d->count++;
+    }
+    (void)pthread_mutex_unlock(&d->lock);
+    return rc;
+}
+
+/**
+ * @brief  Take a task from the tail (owner) or the head (thief).
+ * @return 1 if a task was taken.
+ */
+static int dequeTake(deque_t *d, task_t *t, int steal) {
+    int got = 0;
+
+    (void)pthread_mutex_lock(&d->lock);
+    if (d->count != 0U) {
+        if (steal != 0) {
+            *t = d->items[d->head];
+            d->head = (d->head + 1U) % d->cap;
+        } else {
+            *t = d->items[(d->head + d->count - 1U) % d->cap];
+        }
+        d->count--;
+        got = 1;
+    }
+    (void)pthread_mutex_unlock(&d->lock);
+    return got;
+}
+
+/**
+ * @brief  Find a task: own deque first, then steal.
+ * @return 1 if a task was found.
+ */
+static int findTask(trng_pool *p, unsigned self, task_t *t) {
+    unsigned i;
+
+    if (dequeTake(&p->q[self], t, 0) != 0) {
+        return 1;
+    }
+    for (i = 1U; i < p->n; i++) {
+        if (dequeTake(&p->q[(self + i) % p->n], t, 1) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief  Worker thread body.
+ */
+static void *workerMain(void *arg) {
+    worker_t *w = arg;
+    trng_pool *p = w->pool;
+    unsigned self = w->index;
+    task_t t;
+
+    free(w);
+    _self = p;
+    _selfIndex = self;
+
+    for (;;) {
+        if (findTask(p, self, &t) != 0) {
+            (void)atomic_fetch_sub(&p->queued, 1U);
+            t.fn(t.arg);
+            (void)pthread_mutex_lock(&p->lock);
+            p->pending--;
+            if (p->pending == 0U) {
+                (void)pthread_cond_broadcast(&p->idle);
+            }
+            (void)pthread_mutex_unlock(&p->lock);
+            continue;
+        }
+        (void)pthread_mutex_lock(&p->lock);
+        while ((atomic_load(&p->queued) == 0U) && (p->stop == 0)) {
+            (void)pthread_cond_wait(&p->work, &p->lock);
+        }
+        if ((atomic_load(&p->queued) == 0U) && (p->stop != 0)) {
+            (void)pthread_mutex_unlock(&p->lock);
+            break;
+        }
+        (void)pthread_mutex_unlock(&p->lock);
+    }
+
+    return NULL;
+}
+
+trng_pool *trng_poolCreate(unsigned threads) {
+    trng_pool *p = calloc(1U, sizeof(*p));
+    unsigned i;
+
+    if (p == NULL) {
+        return NULL;
+    }
+    if (threads == 0U) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (cpus > 0L) ? (unsigned)cpus : 1U;
+    }
+    p->n = threads;
+    p->threads = calloc(threads, sizeof(*p->threads));
+    p->q = calloc(threads, sizeof(*p->q));
+    if ((p->threads == NULL) || (p->q == NULL)) {
+        free(p->threads);
+        free(p->q);
+        free(p);
+        return NULL;
+    }
+    (void)pthread_mutex_init(&p->lock, NULL);
+    (void)pthread_cond_init(&p->work, NULL);
+    (void)pthread_cond_init(&p->idle, NULL);
+    atomic_init(&p->queued, 0U);
+    atomic_init(&p->next, 0U);
+    for (i = 0U; i < threads; i++) {
+        (void)pthread_mutex_init(&p->q[i].lock, NULL);
+    }
+    for (i = 0U; i < threads; i++) {
+        worker_t *w = malloc(sizeof(*w));
+        if (w != NULL) {
+            w->pool = p;
+            w->index = i;
+        }
+        if ((w == NULL) || (pthread_create(&p->threads[i], NULL, workerMain, w) != 0)) {
+            /* Run with the workers started so far. */
+            free(w);
+            p->n = (i == 0U) ? 0U : i;
+            break;
+        }
+    }
+    if (p->n == 0U) {
+        free(p->threads);
+        free(p->q);
+        free(p);
+        return NULL;
+    }
+    return p;
+}
+
+void trng_poolSubmit(trng_pool *p, trng_task_fn fn, void *arg) {
+    unsigned target = (_self == p) ? _selfIndex : (atomic_fetch_add(&p->next, 1U) % p->n);
+
+    (void)pthread_mutex_lock(&p->lock);
+    p->pending++;
+    (void)pthread_mutex_unlock(&p->lock);
+
+    (void)atomic_fetch_add(&p->queued, 1U);
+    if (dequePush(&p->q[target], fn, arg) != 0) {
+        /* Out of memory: run inline rather than drop the task. */
+        (void)atomic_fetch_sub(&p->queued, 1U);
+        fn(arg);
+        (void)pthread_mutex_lock(&p->lock);
+        p->pending--;
+        if (p->pending == 0U) {
+            (void)pthread_cond_broadcast(&p->idle);
+        }
+        (void)pthread_mutex_unlock(&p->lock);
+        return;
+    }
+    (void)pthread_mutex_lock(&p->lock);
+    (void)pthread_cond_signal(&p->work);
+    (void)pthread_mutex_unlock(&p->lock);
+}
+
+void trng_poolWait(trng_pool *p) {
+    (void)pthread_mutex_lock(&p->lock);
+    while (p->pending != 0U) {
+        (void)pthread_cond_wait(&p->idle, &p->lock);
+    }
+    (void)pthread_mutex_unlock(&p->lock);
+}
+
+unsigned trng_poolThreads(const trng_pool *p) {
+    return p->n;
+}
+
+void trng_poolDestroy(trng_pool *p) {
+    unsigned i;
+
+    trng_poolWait(p);
+    (void)pthread_mutex_lock(&p->lock);
+    p->stop = 1;
+    (void)pthread_cond_broadcast(&p->work);
+    (void)pthread_mutex_unlock(&p->lock);
+    for (i = 0U; i < p->n; i++) {
+        (void)pthread_join(p->threads[i], NULL);
+    }
+    for (i = 0U; i < p->n; i++) {
+        (void)pthread_mutex_destroy(&p->q[i].lock);
+        free(p->q[i].items);
+    }
+    (void)pthread_mutex_destroy(&p->lock);
+    (void)pthread_cond_destroy(&p->work);
+    (void)pthread_cond_destroy(&p->idle);
+    free(p->threads);
+    free(p->q);
+    free(p);
+}
@@ -0,0 +1,53 @@
+/*******************************************************************************
+ * @file    trng_pool.h
+ * @brief   Work-stealing thread pool for the host analysis tools.
+ *
+ * Each worker owns a deque: it pushes and pops tasks at the tail (newest
+ * first, which keeps the data of the task it just split hot in its cache)
+ * and idle workers steal from the head of the others (oldest first, which
+ * hands them the largest remaining pieces of work). Tasks submitted from a
+ * worker go to that worker's deque; tasks submitted from outside the pool
+ * are spread round-robin.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_POOL_H
+#define TRNG_POOL_H
+
+/** @brief Task entry point. */
+typedef void (*trng_task_fn)(void *arg);
+
+/** @brief Opaque pool handle. */
+typedef struct trng_pool trng_pool;
+
+/**
+ * @brief   Start a pool.
+ *
+ * @param   threads  Number of workers, 0 for one per online CPU.
+ *
+ * @return  Pool, or NULL on error.
+ */
+trng_pool *trng_poolCreate(unsigned threads);
+
+/**
+ * @brief   Queue a task. May be called from inside a task.
+ */
+void trng_poolSubmit(trng_pool *p, trng_task_fn fn, void *arg);
+
+/**
+ * @brief   Wait until every submitted task, including the tasks they
+ *          submitted, has finished.
+ */
+void trng_poolWait(trng_pool *p);
+
+/**
+ * @brief   Number of workers.
+ */
+unsigned trng_poolThreads(const trng_pool *p);
+
+/**
+ * @brief   Stop the workers and free the pool. Queued tasks are run first.
+ */
+void trng_poolDestroy(trng_pool *p);
+
+#endif /* TRNG_POOL_H */
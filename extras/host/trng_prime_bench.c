@@ -0,0 +1,348 @@
+/*******************************************************************************
+ * @file    trng_prime_bench.c
+ * @brief   Known answers and per-phase cost of the prime generator.
+ *
+ * Builds src/trng_prime.c unchanged, with trng_read128() supplied by a
+ * Philox stream keyed by -s, so every run with the same seed draws the
+ * same candidates and witnesses. The checks:
+ * - known primes (2^61 - 1, 2^127 - 1, 2^521 - 1) and composites with
+ *   small factors (561, 3215031751) or only large ones
+ *   ((2^61 - 1)(2^89 - 1), (2^127 - 1)(2^89 - 1));
+ * - trng_primeTest() against trial division up to 200000 and against a
+ *   deterministic 64-bit Miller-Rabin on random 32- and 64-bit numbers;
+ * - every generated prime has its bit length, its top two bits set, and
+ *   passes the 64-bit test (at 64 bits) or is not split by a second
+ *   trng_primeTest() call; the product of two of them is reported
+ *   composite;
+ * - trng_primeGenerate() and trng_primeTest() leave no number in the
+ *   context workspace.
+ * It then generates -n primes of -b bits with 0, 16, 64 and 256 sieve
+ * primes (or with -S only) and prints the per-phase counts and times.
+ *
+ * Build (Linux):
+ * @code
+ *   cc -O2 -I../../src -o trng_prime_bench trng_prime_bench.c trng_host.c ../../src/trng_prime.c ../../src/trng_philox.c
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_prime_bench [-n primes] [-b bits] [-s seed] [-S sieve_primes]
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "trng_prime.h"
+#include "trng_philox.h"
+#include "trng_host.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static trng_philox _philox;
+static uint64_t _block = 0U;
+
+/**
+ * @brief  Deterministic stand-in for the SCE5 read.
+ */
+uint8_t trng_read128(uint32_t *out) {
+    trng_philoxBlock(&_philox, _block, out);
+    _block++;
+    return TRNG_OK;
+}
+
+/**
+ * @brief  Phase clock in microseconds.
+ */
+static uint32_t hostMicros(void) {
+    return (uint32_t)(uint64_t)(trng_hostNow() * 1e6);
+}
+
+/** @brief a * b mod m. */
+static uint64_t mulMod(uint64_t a, uint64_t b, uint64_t m) {
+    return (uint64_t)(((unsigned __int128)a * b) % m);
+}
+
+/**
+ * @brief  Deterministic Miller-Rabin for 64-bit numbers (the first twelve
+ *         prime bases suffice below 3.3e24).
+ */
+static int isPrime64(uint64_t n) {
+    static const uint64_t bases[] = { 2U, 3U, 5U, 7U, 11U, 13U, 17U, 19U, 23U, 29U, 31U, 37U };
+    uint64_t d = n - 1U;
+    unsigned s = 0U;
+    size_t i;
+
+    if (n < 2U) {
+        return 0;
+    }
+    for (i = 0U; i < (sizeof(bases) / sizeof(bases[0])); i++) {
+        if (n % bases[i] == 0U) {
+            return (n == bases[i]) ? 1 : 0;
+        }
+    }
+    while ((d & 1U) == 0U) {
+        d >>= 1U;
+        s++;
+    }
+    for (i = 0U; i < (sizeof(bases) / sizeof(bases[0])); i++) {
+        uint64_t x = 1U;
+        uint64_t b = bases[i];
+        uint64_t e = d;
+        unsigned r;
+        int pass;
+        while (e != 0U) {
+            if ((e & 1U) != 0U) {
+                x = mulMod(x, b, n);
+            }
+            b = mulMod(b, b, n);
+            e >>= 1U;
+        }
+        pass = ((x == 1U) || (x == (n - 1U))) ? 1 : 0;
+        for (r = 1U; (pass == 0) && (r < s); r++) {
+            x = mulMod(x, x, n);
+            pass = (x == (n - 1U)) ? 1 : 0;
+        }
+        if (pass == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/** @brief 2^bits - 1 into @p words words. */
+static void mersenne(uint32_t *x, size_t words, unsigned bits) {
+    size_t i;
+    for (i = 0U; i < words; i++) {
+        x[i] = (bits >= (32U * (i + 1U))) ? 0xFFFFFFFFU
+             : ((bits > (32U * i)) ? ((1U << (bits - (32U * i))) - 1U) : 0U);
+    }
+}
+
+/** @brief r = a * b, schoolbook; @p r has wa + wb words. */
+static void mul(uint32_t *r, const uint32_t *a, size_t wa, const uint32_t *b, size_t wb) {
+    size_t i;
+    size_t j;
+    memset(r, 0, (wa + wb) * sizeof(uint32_t));
+    for (i = 0U; i < wa; i++) {
+        uint64_t c = 0U;
+        for (j = 0U; j < wb; j++) {
+            c += ((uint64_t)a[i] * b[j]) + r[i + j];
+            r[i + j] = (uint32_t)c;
+            c >>= 32U;
+        }
+        r[i + wb] = (uint32_t)c;
+    }
+}
+
+/** @brief 1 if the number workspace and residues of @p ctx are all zero. */
+static int wiped(const trng_prime *ctx) {
+    const uint8_t *b = (const uint8_t *)ctx;
+    size_t i;
+    for (i = offsetof(trng_prime, base); i < offsetof(trng_prime, block); i++) {
+        if (b[i] != 0U) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/** @brief trng_primeTest() with a failure check; returns the verdict. */
+static int test(trng_prime *ctx, const uint32_t *n, size_t words) {
+    uint8_t prime = 2U;
+    if (trng_primeTest(ctx, n, words, 0U, &prime) != TRNG_OK) {
+        fprintf(stderr, "trng_primeTest failed\n");
+        exit(1);
+    }
+    return (int)prime;
+}
+
+/**
+ * @brief  Known answers and cross-checks.
+ * @return Number of failures.
+ */
+static int check(trng_prime *ctx) {
+    uint32_t a[TRNG_PRIME_MAX_WORDS];
+    uint32_t b[TRNG_PRIME_MAX_WORDS];
+    uint32_t c[TRNG_PRIME_MAX_WORDS];
+    uint32_t p[2U];
+    uint32_t q[2U];
+    int fail = 0;
+    uint32_t v;
+    unsigned i;
+
+    mersenne(a, 2U, 61U);
+    fail += (test(ctx, a, 2U) != 1);
+    mersenne(a, 4U, 127U);
+    fail += (test(ctx, a, 4U) != 1);
+    mersenne(a, 17U, 521U);
+    fail += (test(ctx, a, 17U) != 1);
+    a[0] = 561U;
+    fail += (test(ctx, a, 1U) != 0);
+    a[0] = 3215031751U;
+    fail += (test(ctx, a, 1U) != 0);
+    mersenne(a, 2U, 61U);
+    mersenne(b, 3U, 89U);
+    mul(c, a, 2U, b, 3U);
+    fail += (test(ctx, c, 5U) != 0);
+    mersenne(a, 4U, 127U);
+    mul(c, a, 4U, b, 3U);
+    fail += (test(ctx, c, 7U) != 0);
+    printf("known answers: %s\n", (fail == 0) ? "ok" : "FAIL");
+
+    for (v = 0U; v < 200000U; v++) {
+        uint32_t d;
+        int prime = (v >= 2U) ? 1 : 0;
+        for (d = 2U; (prime != 0) && ((d * d) <= v); d++) {
+            prime = ((v % d) != 0U) ? 1 : 0;
+        }
+        if (test(ctx, &v, 1U) != prime) {
+            fprintf(stderr, "trial division differs at %u\n", (unsigned)v);
+            fail++;
+        }
+    }
+    for (i = 0U; i < 200000U; i++) {
+        uint32_t r[4];
+        uint64_t n;
+        (void)trng_read128(r);
+        n = (i & 1U) ? (r[0] | 1U) : (((uint64_t)r[1] << 32U) | r[0] | 1U);
+        p[0] = (uint32_t)n;
+        p[1] = (uint32_t)(n >> 32U);
+        if (test(ctx, p, 2U) != isPrime64(n)) {
+            fprintf(stderr, "64-bit test differs at %llu\n", (unsigned long long)n);
+            fail++;
+        }
+    }
+    for (i = 0U; i < 1000U; i++) {
+        uint64_t n;
+        if ((trng_primeGenerate(ctx, p, 64U, 0U) != TRNG_OK) || (trng_primeGenerate(ctx, q, 64U, 0U) != TRNG_OK)) {
+            fail++;
+            break;
+        }
+        n = ((uint64_t)p[1] << 32U) | p[0];
+        mul(c, p, 2U, q, 2U);
+        if (((n >> 62U) != 3U) || (isPrime64(n) == 0) || (test(ctx, c, 4U) != 0)) {
+            fprintf(stderr, "generated 64-bit prime %llu is wrong\n", (unsigned long long)n);
+            fail++;
+        }
+    }
+    printf("trial division, 64-bit Miller-Rabin and generated 64-bit primes: %s\n", (fail == 0) ? "ok" : "FAIL");
+    mersenne(a, 17U, 521U);
+    i = (unsigned)test(ctx, a, 17U);
+    if ((i != 1U) || (wiped(ctx) == 0) || (trng_primeGenerate(ctx, a, 512U, 0U) != TRNG_OK) || (wiped(ctx) == 0)) {
+        fprintf(stderr, "workspace not wiped\n");
+        fail++;
+    }
+    printf("workspace wiped after test and generate: %s\n", (wiped(ctx) != 0) ? "ok" : "FAIL");
+    memset(a, 0, sizeof(a));
+    return fail;
+}
+
+/**
+ * @brief  Generate @p n primes of @p bits bits and print the phase breakdown.
+ * @return Number of failures.
+ */
+static int run(unsigned bits, unsigned long n, uint16_t sieve) {
+    static trng_prime ctx;
+    uint32_t p[TRNG_PRIME_MAX_WORDS];
+    uint32_t pq[2U * TRNG_PRIME_MAX_WORDS];
+    size_t w = (bits + 31U) / 32U;
+    uint64_t reads = _block;
+    double t0;
+    double total;
+    unsigned long i;
+    int fail = 0;
+
+    (void)trng_primeInit(&ctx, sieve, hostMicros);
+    t0 = trng_hostNow();
+    for (i = 0UL; i < n; i++) {
+        uint32_t top = bits - 1U;
+        if ((trng_primeGenerate(&ctx, p, bits, 0U) != TRNG_OK) ||
+            (((p[top / 32U] >> (top % 32U)) & 1U) == 0U) || (((p[(top - 1U) / 32U] >> ((top - 1U) % 32U)) & 1U) == 0U) ||
+            (((bits % 32U) != 0U) && ((p[w - 1U] >> (bits % 32U)) != 0U))) {
+            fail++;
+        }
+    }
+    total = trng_hostNow() - t0;
+    reads = _block - reads;
+    fail += (wiped(&ctx) == 0);
+    /* A product of two results must not pass. */
+    {
+        static trng_prime chk;
+        uint32_t q[TRNG_PRIME_MAX_WORDS];
+        if ((bits * 2U) <= TRNG_PRIME_MAX_BITS) {
+            (void)trng_primeInit(&chk, TRNG_PRIME_SIEVE, NULL);
+            (void)trng_primeGenerate(&chk, q, bits, 0U);
+            mul(pq, p, w, q, w);
+            fail += (test(&chk, pq, 2U * w) != 0);
+            trng_primeWipe(&chk);
+            memset(q, 0, sizeof(q));
+        }
+    }
+    trng_primeWipe(&ctx);
+    memset(p, 0, sizeof(p));
+    memset(pq, 0, sizeof(pq));
+
+    printf("%4u sieve primes: %8.2f ms/prime  %7.1f candidates  %8.1f sieved  %6.1f tested  %6.1f rounds  "
+           "%5.1f reads/prime\n",
+           (unsigned)sieve, (total * 1e3) / (double)n, (double)ctx.stats.candidates / (double)n,
+           (double)ctx.stats.sieved / (double)n, (double)ctx.stats.tested / (double)n,
+           (double)ctx.stats.rounds / (double)n, (double)reads / (double)n);
+    printf("                  draw %5.1f%%  sieve %5.1f%%  Miller-Rabin %5.1f%%%s\n",
+           (100.0 * ctx.stats.timeDraw) / (double)(ctx.stats.timeDraw + ctx.stats.timeSieve + ctx.stats.timeTest),
+           (100.0 * ctx.stats.timeSieve) / (double)(ctx.stats.timeDraw + ctx.stats.timeSieve + ctx.stats.timeTest),
+           (100.0 * ctx.stats.timeTest) / (double)(ctx.stats.timeDraw + ctx.stats.timeSieve + ctx.stats.timeTest),
+           (fail != 0) ? "  FAIL" : "");
+    return fail;
+}
+
+int main(int argc, char **argv) {
+    static const uint16_t sieves[] = { 0U, 16U, 64U, TRNG_PRIME_SIEVE };
+    static trng_prime ctx;
+    unsigned long n = 20UL;
+    unsigned bits = 512U;
+    unsigned long long seed = 1U;
+    long only = -1L;
+    size_t k;
+    int rc = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:b:s:S:h")) != -1) {
+        switch (opt) {
+        case 'n': n = strtoul(optarg, NULL, 10); break;
+        case 'b': bits = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 's': seed = strtoull(optarg, NULL, 0); break;
+        case 'S': only = strtol(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: trng_prime_bench [-n primes] [-b bits] [-s seed] [-S sieve_primes]\n");
+            return 2;
+        }
+    }
+    if ((bits < 64U) || (bits > TRNG_PRIME_MAX_BITS) || (only > (long)TRNG_PRIME_SIEVE)) {
+        fprintf(stderr, "trng_prime_bench: bits must be 64 to %u, sieve primes at most %u\n",
+                (unsigned)TRNG_PRIME_MAX_BITS, (unsigned)TRNG_PRIME_SIEVE);
+        return 2;
+    }
+    if (n == 0UL) {
+        n = 1UL;
+    }
+    _philox.key[0] = (uint32_t)seed;
+    _philox.key[1] = (uint32_t)(seed >> 32U);
+
+    (void)trng_primeInit(&ctx, TRNG_PRIME_SIEVE, NULL);
+    rc |= (check(&ctx) != 0) ? 1 : 0;
+
+    printf("%lu primes of %u bits, seed %llu:\n", n, bits, seed);
+    if (only >= 0L) {
+        rc |= (run(bits, n, (uint16_t)only) != 0) ? 1 : 0;
+    } else {
+        for (k = 0U; k < (sizeof(sieves) / sizeof(sieves[0])); k++) {
+            rc |= (run(bits, n, sieves[k]) != 0) ? 1 : 0;
+        }
+    }
+    trng_primeWipe(&ctx);
+    return rc;
+}
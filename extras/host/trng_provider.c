@@ -0,0 +1,520 @@
+/*******************************************************************************
+ * @file    trng_provider.c
+ * @brief   OpenSSL 3 provider serving board entropy from trngd.
+ *
+ * Registers one RAND algorithm, "TRNG" (property "provider=trng"), which
+ * reads the health-checked pool of trngd, over its Unix socket or from a
+ * lane of its shared-memory ring. It can be used three ways:
+ * - directly, as an EVP_RAND;
+ * - as the parent (seed source) of an OpenSSL DRBG: it implements
+ *   get_seed(), so EVP_RAND_CTX_new(ctr_drbg, trng_ctx) gives a CTR-DRBG
+ *   reseeded from board entropy, and with OpenSSL 3.2 or later the global
+ *   DRBGs are chained to it with "seed = TRNG" in the [random] section;
+ * - as the global generator, with "random = TRNG" in the [random] section
+ *   or RAND_set_DRBG_type().
+ *
+ * All contexts share one connection. Requests below TRNG_PROV_PREFETCH
+ * bytes are served from a prefetched block, so small DRBG seeds cost no
+ * round trip; larger ones are read straight into the caller's buffer,
+ * split into trngd requests of at most TRNG_PROV_REQUEST bytes with up to
+ * TRNG_PROV_DEPTH of them in flight. Served prefetch bytes are wiped. A
+ * forked child drops the prefetched bytes and opens its own connection,
+ * so parent and child never share output.
+ *
+ * Configuration, in the provider section or the environment (which wins):
+ * - socket / TRNG_SOCKET: trngd socket path (default /tmp/trngd.sock);
+ * - ring / TRNG_RING: shared-memory ring name (trngd -m), used instead of
+ *   the socket when set. A read fails if trngd has stopped or restarted,
+ *   or if its lane stays empty for TRNG_RING_STALL seconds; the next read
+ *   maps the ring again.
+ *
+ * @code
+ *   openssl_conf = conf
+ *   [conf]
+ *   providers = providers
+ *   alg_section = algs
+ *   random = random
+ *   [providers]
+ *   default = default_sect
+ *   trng = trng_sect
+ *   [default_sect]
+ *   activate = 1
+ *   [trng_sect]
+ *   module = /path/to/trng_provider.so
+ *   socket = /tmp/trngd.sock
+ *   activate = 1
+ *   [random]
+ *   seed = TRNG
+ *   seed_properties = provider=trng
+ * @endcode
+ *
+ * Build (Linux, OpenSSL 3 development files):
+ * @code
+ *   cc -O2 -fPIC -shared -pthread -o trng_provider.so trng_provider.c trng_ring.c trng_host.c -lcrypto
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "trng_host.h"
+#include "trng_ring.h"
+
+#include <openssl/core_dispatch.h>
+#include <openssl/core_names.h>
+#include <openssl/crypto.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/params.h>
+#include <openssl/proverr.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/** @brief Prefetched block size; smaller requests are served from it. */
+#define TRNG_PROV_PREFETCH  4096U
+/** @brief Largest single trngd request (TRNGD_MAX_REQUEST). */
+#define TRNG_PROV_REQUEST   (1UL << 20)
+/** @brief Requests kept in flight for large reads. */
+#define TRNG_PROV_DEPTH     16U
+/** @brief Largest generate() request announced to OpenSSL. */
+#define TRNG_PROV_MAX_REQUEST   (1UL << 30)
+/** @brief Security strength announced to OpenSSL, in bits. */
+#define TRNG_PROV_STRENGTH  256U
+/** @brief Default trngd socket. */
+#define TRNG_PROV_SOCKET    "/tmp/trngd.sock"
+
+/** @brief Connection to trngd, shared by every context. */
+typedef struct {
+    pthread_mutex_t lock;
+    char     socketPath[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    char     ringName[256];
+    int      fd;                            /**< Socket, -1 when closed. */
+    int      ringOpen;
+    trng_ring ring;
+    uint8_t  buf[TRNG_PROV_PREFETCH];       /**< Bytes [pos, TRNG_PROV_PREFETCH) are unread. */
+    size_t   pos;
+    unsigned forkGen;                       /**< Value of _forks when connected. */
+} trng_prov;
+
+/** @brief Number of forks seen in this process image. */
+static atomic_uint _forks;
+
+/** @brief Mark every connection of a forked child as inherited. */
+static void provAtforkChild(void) {
+    atomic_fetch_add(&_forks, 1U);
+}
+
+/** @brief RAND context. */
+typedef struct {
+    trng_prov *prov;
+    int        state;                       /**< EVP_RAND_STATE_*. */
+} trng_prov_rand;
+
+/**
+ * @brief  Connect to the configured source if not connected yet.
+ * @return 0 on success.
+ */
+static int provConnect(trng_prov *p) {
+    struct sockaddr_un addr;
+    unsigned gen = atomic_load(&_forks);
+
+    if (gen != p->forkGen) {
+        /* Inherited: keep the parent's lane and socket out of our reads. */
+        if (p->fd >= 0) {
+            (void)close(p->fd);
+        }
+        p->fd = -1;
+        p->ringOpen = 0;
+        OPENSSL_cleanse(p->buf, sizeof(p->buf));
+        p->pos = TRNG_PROV_PREFETCH;
+        p->forkGen = gen;
+    }
+    if ((p->fd >= 0) || (p->ringOpen != 0)) {
+        return 0;
+    }
+    if (p->ringName[0] != '\0') {
+        if (trng_ringOpen(&p->ring, p->ringName) != 0) {
+            return -1;
+        }
+        p->ringOpen = 1;
+        return 0;
+    }
+    p->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (p->fd < 0) {
+        return -1;
+    }
+    (void)memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    (void)memcpy(addr.sun_path, p->socketPath, sizeof(addr.sun_path));
+    if (connect(p->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        (void)close(p->fd);
+        p->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief  Read exactly @p len bytes from trngd, pipelining requests.
+ * @return 0 on success. On a socket error the connection is dropped, so
+ *         the next call starts with no response outstanding.
+ */
+static int provFetch(trng_prov *p, uint8_t *dst, size_t len) {
+    size_t asked = 0U;
+    size_t got = 0U;
+
+    if (provConnect(p) != 0) {
+        return -1;
+    }
+    if (p->ringOpen != 0) {
+        if (trng_ringReadWait(&p->ring, dst, len, TRNG_RING_STALL) != 0) {
+            /* trngd stopped, restarted or stalled: drop the lane, so the
+               next call maps the current object. */
+            OPENSSL_cleanse(dst, len);
+            trng_ringClose(&p->ring);
+            p->ringOpen = 0;
+            return -1;
+        }
+        return 0;
+    }
+    while (got < len) {
+        uint8_t reqs[TRNG_PROV_DEPTH * 4U];
+        size_t nreq = 0U;
+        ssize_t n;
+
+        while (((asked - got) < (TRNG_PROV_DEPTH * TRNG_PROV_REQUEST)) && (asked < len)) {
+            size_t r = ((len - asked) < TRNG_PROV_REQUEST) ? (len - asked) : TRNG_PROV_REQUEST;
+            reqs[nreq * 4U] = (uint8_t)(r & 0xFFU);
+            reqs[(nreq * 4U) + 1U] = (uint8_t)((r >> 8) & 0xFFU);
+            reqs[(nreq * 4U) + 2U] = (uint8_t)((r >> 16) & 0xFFU);
+            reqs[(nreq * 4U) + 3U] = (uint8_t)(r >> 24);
+            nreq++;
+            asked += r;
+        }
+        if ((nreq != 0U) && (trng_hostWriteAll(p->fd, reqs, nreq * 4U) != 0)) {
+            break;
+        }
+        n = read(p->fd, &dst[got], asked - got);
+        if (n > 0) {
+            got += (size_t)n;
+        } else if ((n < 0) && (errno == EINTR)) {
+            continue;
+        } else {
+            break;
+        }
+    }
+    if (got < len) {
+        OPENSSL_cleanse(dst, got);
+        (void)close(p->fd);
+        p->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief  Serve @p len bytes: prefetched bytes first, then either one
+ *         direct read or a new prefetched block.
+ * @return 1 on success, 0 on failure (OpenSSL convention).
+ */
+static int provRead(trng_prov *p, uint8_t *dst, size_t len) {
+    size_t done = 0U;
+    int ok = 1;
+
+    (void)pthread_mutex_lock(&p->lock);
+    if (provConnect(p) != 0) {
+        ok = 0;
+    }
+    while ((ok != 0) && (done < len)) {
+        size_t avail = TRNG_PROV_PREFETCH - p->pos;
+        if (avail != 0U) {
+            size_t n = ((len - done) < avail) ? (len - done) : avail;
+            (void)memcpy(&dst[done], &p->buf[p->pos], n);
+            OPENSSL_cleanse(&p->buf[p->pos], n);
+            p->pos += n;
+            done += n;
+        } else if ((len - done) >= TRNG_PROV_PREFETCH) {
+            ok = (provFetch(p, &dst[done], len - done) == 0);
+            done = len;
+        } else if (provFetch(p, p->buf, TRNG_PROV_PREFETCH) == 0) {
+            p->pos = 0U;
+        } else {
+            ok = 0;
+        }
+    }
+    (void)pthread_mutex_unlock(&p->lock);
+
+    if (ok == 0) {
+        OPENSSL_cleanse(dst, len);
+    }
+    return ok;
+}
+
+static void *randNew(void *provctx, void *parent, const OSSL_DISPATCH *parentCalls) {
+    trng_prov_rand *r = OPENSSL_zalloc(sizeof(*r));
+
+    /* A hardware source has no parent: one supplied is ignored. */
+    (void)parent;
+    (void)parentCalls;
+    if (r != NULL) {
+        r->prov = provctx;
+        r->state = EVP_RAND_STATE_UNINITIALISED;
+    }
+    return r;
+}
+
+static void randFree(void *vctx) {
+    OPENSSL_free(vctx);
+}
+
+static int randInstantiate(void *vctx, unsigned int strength, int predRes, const unsigned char *pstr,
+                           size_t pstrLen, const OSSL_PARAM params[]) {
+    trng_prov_rand *r = vctx;
+
+    (void)predRes;
+    (void)pstr;
+    (void)pstrLen;
+    (void)params;
+    if (strength > TRNG_PROV_STRENGTH) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_INSUFFICIENT_DRBG_STRENGTH);
+        return 0;
+    }
+    r->state = EVP_RAND_STATE_READY;
+    return 1;
+}
+
+static int randUninstantiate(void *vctx) {
+    trng_prov_rand *r = vctx;
+
+    r->state = EVP_RAND_STATE_UNINITIALISED;
+    return 1;
+}
+
+static int randGenerate(void *vctx, unsigned char *out, size_t outLen, unsigned int strength, int predRes,
+                        const unsigned char *adin, size_t adinLen) {
+    trng_prov_rand *r = vctx;
+
+    /* Every output is fresh entropy, so prediction resistance always holds. */
+    (void)predRes;
+    (void)adin;
+    (void)adinLen;
+    if ((r->state != EVP_RAND_STATE_READY) || (strength > TRNG_PROV_STRENGTH)) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_NOT_INSTANTIATED);
+        return 0;
+    }
+    if (provRead(r->prov, out, outLen) == 0) {
+        r->state = EVP_RAND_STATE_ERROR;
+        ERR_raise(ERR_LIB_PROV, PROV_R_ERROR_RETRIEVING_ENTROPY);
+        return 0;
+    }
+    return 1;
+}
+
+static int randReseed(void *vctx, int predRes, const unsigned char *ent, size_t entLen,
+                      const unsigned char *adin, size_t adinLen) {
+    (void)vctx;
+    (void)predRes;
+    (void)ent;
+    (void)entLen;
+    (void)adin;
+    (void)adinLen;
+    return 1;
+}
+
+/**
+ * @brief  Seed callback used when a DRBG has this source as its parent.
+ */
+static size_t randGetSeed(void *vctx, unsigned char **pout, int entropy, size_t minLen, size_t maxLen,
+                          int predRes, const unsigned char *adin, size_t adinLen) {
+    trng_prov_rand *r = vctx;
+    size_t len = ((size_t)entropy + 7U) / 8U;
+    unsigned char *buf;
+
+    (void)predRes;
+    (void)adin;
+    (void)adinLen;
+    if (len < minLen) {
+        len = minLen;
+    }
+    if (len > maxLen) {
+        return 0;
+    }
+    buf = OPENSSL_secure_malloc(len);
+    if (buf == NULL) {
+        return 0;
+    }
+    if (provRead(r->prov, buf, len) == 0) {
+        OPENSSL_secure_clear_free(buf, len);
+        ERR_raise(ERR_LIB_PROV, PROV_R_ERROR_RETRIEVING_ENTROPY);
+        return 0;
+    }
+    *pout = buf;
+    return len;
+}
+
+static void randClearSeed(void *vctx, unsigned char *out, size_t outLen) {
+    (void)vctx;
+    OPENSSL_secure_clear_free(out, outLen);
+}
+
+/* The shared connection has its own lock, so contexts need none. */
+static int randEnableLocking(void *vctx) {
+    (void)vctx;
+    return 1;
+}
+
+static int randLock(void *vctx) {
+    (void)vctx;
+    return 1;
+}
+
+static void randUnlock(void *vctx) {
+    (void)vctx;
+}
+
+static int randGetCtxParams(void *vctx, OSSL_PARAM params[]) {
+    trng_prov_rand *r = vctx;
+    OSSL_PARAM *p;
+
+    p = OSSL_PARAM_locate(params, OSSL_RAND_PARAM_STATE);
+    if ((p != NULL) && (OSSL_PARAM_set_int(p, r->state) == 0)) {
+        return 0;
+    }
+    p = OSSL_PARAM_locate(params, OSSL_RAND_PARAM_STRENGTH);
+    if ((p != NULL) && (OSSL_PARAM_set_uint(p, TRNG_PROV_STRENGTH) == 0)) {
+        return 0;
+    }
+    p = OSSL_PARAM_locate(params, OSSL_RAND_PARAM_MAX_REQUEST);
+    if ((p != NULL) && (OSSL_PARAM_set_size_t(p, TRNG_PROV_MAX_REQUEST) == 0)) {
+        return 0;
+    }
+    return 1;
+}
+
+static const OSSL_PARAM *randGettableCtxParams(void *vctx, void *provctx) {
+    static const OSSL_PARAM known[] = {
+        OSSL_PARAM_int(OSSL_RAND_PARAM_STATE, NULL),
+        OSSL_PARAM_uint(OSSL_RAND_PARAM_STRENGTH, NULL),
+        OSSL_PARAM_size_t(OSSL_RAND_PARAM_MAX_REQUEST, NULL),
+        OSSL_PARAM_END
+    };
+
+    (void)vctx;
+    (void)provctx;
+    return known;
+}
+
+static int randVerifyZeroization(void *vctx) {
+    (void)vctx;
+    return 1;
+}
+
+static const OSSL_DISPATCH _randFunctions[] = {
+    { OSSL_FUNC_RAND_NEWCTX, (void (*)(void))randNew },
+    { OSSL_FUNC_RAND_FREECTX, (void (*)(void))randFree },
+    { OSSL_FUNC_RAND_INSTANTIATE, (void (*)(void))randInstantiate },
+    { OSSL_FUNC_RAND_UNINSTANTIATE, (void (*)(void))randUninstantiate },
+    { OSSL_FUNC_RAND_GENERATE, (void (*)(void))randGenerate },
+    { OSSL_FUNC_RAND_RESEED, (void (*)(void))randReseed },
+    { OSSL_FUNC_RAND_GET_SEED, (void (*)(void))randGetSeed },
+    { OSSL_FUNC_RAND_CLEAR_SEED, (void (*)(void))randClearSeed },
+    { OSSL_FUNC_RAND_ENABLE_LOCKING, (void (*)(void))randEnableLocking },
+    { OSSL_FUNC_RAND_LOCK, (void (*)(void))randLock },
+    { OSSL_FUNC_RAND_UNLOCK, (void (*)(void))randUnlock },
+    { OSSL_FUNC_RAND_GET_CTX_PARAMS, (void (*)(void))randGetCtxParams },
+    { OSSL_FUNC_RAND_GETTABLE_CTX_PARAMS, (void (*)(void))randGettableCtxParams },
+    { OSSL_FUNC_RAND_VERIFY_ZEROIZATION, (void (*)(void))randVerifyZeroization },
+    { 0, NULL }
+};
+
+static const OSSL_ALGORITHM _rands[] = {
+    { "TRNG", "provider=trng", _randFunctions, "SCE5 board entropy served by trngd" },
+    { NULL, NULL, NULL, NULL }
+};
+
+static const OSSL_ALGORITHM *provQuery(void *provctx, int operation, int *noCache) {
+    (void)provctx;
+    *noCache = 0;
+    return (operation == OSSL_OP_RAND) ? _rands : NULL;
+}
+
+static void provTeardown(void *provctx) {
+    trng_prov *p = provctx;
+
+    if (p->fd >= 0) {
+        (void)close(p->fd);
+    }
+    if (p->ringOpen != 0) {
+        trng_ringClose(&p->ring);
+    }
+    (void)pthread_mutex_destroy(&p->lock);
+    OPENSSL_cleanse(p->buf, sizeof(p->buf));
+    free(p);
+}
+
+static const OSSL_DISPATCH _provFunctions[] = {
+    { OSSL_FUNC_PROVIDER_QUERY_OPERATION, (void (*)(void))provQuery },
+    { OSSL_FUNC_PROVIDER_TEARDOWN, (void (*)(void))provTeardown },
+    { 0, NULL }
+};
+
+/**
+ * @brief  Copy a setting: environment variable first, then the provider
+ *         configuration section.
+ */
+static void provSetting(char *dst, size_t size, const char *env, const char *conf) {
+    const char *v = getenv(env);
+
+    if ((v == NULL) || (v[0] == '\0')) {
+        v = conf;
+    }
+    if (v != NULL) {
+        (void)strncpy(dst, v, size - 1U);
+        dst[size - 1U] = '\0';
+    }
+}
+
+int OSSL_provider_init(const OSSL_CORE_HANDLE *handle, const OSSL_DISPATCH *in, const OSSL_DISPATCH **out,
+                       void **provctx) {
+    OSSL_FUNC_core_get_params_fn *getParams = NULL;
+    char *confSocket = NULL;
+    char *confRing = NULL;
+    trng_prov *p;
+
+    for (; in->function_id != 0; in++) {
+        if (in->function_id == OSSL_FUNC_CORE_GET_PARAMS) {
+            getParams = OSSL_FUNC_core_get_params(in);
+        }
+    }
+    if (getParams != NULL) {
+        OSSL_PARAM req[] = {
+            OSSL_PARAM_utf8_ptr("socket", &confSocket, 0),
+            OSSL_PARAM_utf8_ptr("ring", &confRing, 0),
+            OSSL_PARAM_END
+        };
+        (void)getParams(handle, req);
+    }
+
+    p = calloc(1U, sizeof(*p));
+    if ((p == NULL) || (pthread_atfork(NULL, NULL, provAtforkChild) != 0)) {
+        free(p);
+        return 0;
+    }
+    (void)pthread_mutex_init(&p->lock, NULL);
+    p->fd = -1;
+    p->pos = TRNG_PROV_PREFETCH;
+    p->forkGen = atomic_load(&_forks);
+    (void)strcpy(p->socketPath, TRNG_PROV_SOCKET);
+    provSetting(p->socketPath, sizeof(p->socketPath), "TRNG_SOCKET", confSocket);
+    provSetting(p->ringName, sizeof(p->ringName), "TRNG_RING", confRing);
+
+    *out = _provFunctions;
+    *provctx = p;
+    return 1;
+}
@@ -0,0 +1,155 @@
+/*******************************************************************************
+ * @file    trng_provider_bench.c
+ * @brief   Check and throughput of the trng OpenSSL provider.
+ *
+ * Loads trng_provider.so from the directory given with -p, then:
+ * - draws from the TRNG algorithm directly at several request sizes;
+ * - chains a CTR-DRBG to it as seed source, forcing a reseed from board
+ *   entropy on every call with prediction resistance;
+ * - makes it the global generator of a library context
+ *   (RAND_set_DRBG_type()) and times RAND_bytes_ex() against the default
+ *   OpenSSL DRBG.
+ * Run it against trngd (fed by boards or trng_sim); TRNG_SOCKET and
+ * TRNG_RING select the source as for the provider.
+ *
+ * Build (Linux, OpenSSL 3 development files):
+ * @code
+ *   cc -O2 -o trng_provider_bench trng_provider_bench.c trng_host.c -lcrypto
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_provider_bench [-p provider_dir] [-n bytes_per_size]
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_host.h"
+
+#include <openssl/core_names.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/provider.h>
+#include <openssl/rand.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/** @brief Request sizes measured, in bytes. */
+static const size_t _sizes[] = { 32U, 256U, 4096U, 65536U, 1U << 20 };
+
+/**
+ * @brief  Time @p total bytes of generate() calls of @p size bytes.
+ * @return MB/s, or a negative value on failure.
+ */
+static double rate(EVP_RAND_CTX *ctx, size_t size, size_t total, int predRes, OSSL_LIB_CTX *global) {
+    unsigned char *buf = malloc(size);
+    size_t done = 0U;
+    double t0 = trng_hostNow();
+    int ok = (buf != NULL);
+
+    while (ok && (done < total)) {
+        ok = (ctx == NULL) ? (RAND_bytes_ex(global, buf, size, 256U) == 1)
+                           : (EVP_RAND_generate(ctx, buf, size, 256U, predRes, NULL, 0U) == 1);
+        done += size;
+    }
+    free(buf);
+    return ok ? (((double)done / (trng_hostNow() - t0)) / 1e6) : -1.0;
+}
+
+/**
+ * @brief  Print one result line, with the OpenSSL error on failure.
+ */
+static int report(const char *label, size_t size, double mbs) {
+    if (mbs < 0.0) {
+        fprintf(stderr, "%s, %zu-byte requests: failed\n", label, size);
+        ERR_print_errors_fp(stderr);
+        return 1;
+    }
+    printf("%-22s %8zu B  %9.2f MB/s\n", label, size, mbs);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *dir = ".";
+    size_t total = 8U << 20;
+    OSSL_LIB_CTX *libctx;
+    OSSL_PROVIDER *trng;
+    OSSL_PROVIDER *deflt;
+    EVP_RAND *trngAlg;
+    EVP_RAND *drbgAlg;
+    EVP_RAND_CTX *src;
+    EVP_RAND_CTX *drbg;
+    OSSL_PARAM params[2];
+    size_t k;
+    int fails = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:n:h")) != -1) {
+        switch (opt) {
+        case 'p': dir = optarg; break;
+        case 'n': total = (size_t)strtoull(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: trng_provider_bench [-p provider_dir] [-n bytes_per_size]\n");
+            return 2;
+        }
+    }
+
+    (void)OSSL_PROVIDER_set_default_search_path(NULL, dir);
+    deflt = OSSL_PROVIDER_load(NULL, "default");
+    trng = OSSL_PROVIDER_load(NULL, "trng_provider");
+    trngAlg = EVP_RAND_fetch(NULL, "TRNG", "provider=trng");
+    drbgAlg = EVP_RAND_fetch(NULL, "CTR-DRBG", "provider=default");
+    if ((deflt == NULL) || (trng == NULL) || (trngAlg == NULL) || (drbgAlg == NULL)) {
+        ERR_print_errors_fp(stderr);
+        return 1;
+    }
+
+    /* Direct use. */
+    src = EVP_RAND_CTX_new(trngAlg, NULL);
+    if ((src == NULL) || (EVP_RAND_instantiate(src, 256U, 0, NULL, 0U, NULL) != 1)) {
+        ERR_print_errors_fp(stderr);
+        return 1;
+    }
+    for (k = 0U; k < (sizeof(_sizes) / sizeof(_sizes[0])); k++) {
+        fails += report("TRNG", _sizes[k], rate(src, _sizes[k], total, 0, NULL));
+    }
+
+    /* Seed-source chaining: every call reseeds from the board. */
+    drbg = EVP_RAND_CTX_new(drbgAlg, src);
+    params[0] = OSSL_PARAM_construct_utf8_string(OSSL_DRBG_PARAM_CIPHER, (char *)"AES-256-CTR", 0U);
+    params[1] = OSSL_PARAM_construct_end();
+    if ((drbg == NULL) || (EVP_RAND_instantiate(drbg, 256U, 1, NULL, 0U, params) != 1)) {
+        ERR_print_errors_fp(stderr);
+        return 1;
+    }
+    fails += report("CTR-DRBG <- TRNG", 32U, rate(drbg, 32U, total / 64U, 1, NULL));
+    fails += report("CTR-DRBG <- TRNG", 4096U, rate(drbg, 4096U, total, 0, NULL));
+    EVP_RAND_CTX_free(drbg);
+
+    /* Global generator, in a library context of its own. */
+    for (k = 0U; k < (sizeof(_sizes) / sizeof(_sizes[0])); k++) {
+        fails += report("RAND_bytes default", _sizes[k], rate(NULL, _sizes[k], total, 0, NULL));
+    }
+    libctx = OSSL_LIB_CTX_new();
+    if ((libctx == NULL) || (OSSL_PROVIDER_set_default_search_path(libctx, dir) != 1) ||
+        (OSSL_PROVIDER_load(libctx, "default") == NULL) ||
+        (OSSL_PROVIDER_load(libctx, "trng_provider") == NULL) ||
+        (RAND_set_DRBG_type(libctx, "TRNG", "provider=trng", NULL, NULL) != 1)) {
+        ERR_print_errors_fp(stderr);
+        return 1;
+    }
+    for (k = 0U; k < (sizeof(_sizes) / sizeof(_sizes[0])); k++) {
+        fails += report("RAND_bytes TRNG", _sizes[k], rate(NULL, _sizes[k], total, 0, libctx));
+    }
+    OSSL_LIB_CTX_free(libctx);
+
+    EVP_RAND_CTX_free(src);
+    EVP_RAND_free(trngAlg);
+    EVP_RAND_free(drbgAlg);
+    (void)OSSL_PROVIDER_unload(trng);
+    (void)OSSL_PROVIDER_unload(deflt);
+    return (fails != 0) ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+/*******************************************************************************
+ * @file    trng_recv.c
+ * @brief   Host-side receiver for the TRNG frame export protocol.
+ *
+ * Reads frames sent by trngClass::writeFrames() from a serial device, a
+ * file or stdin, verifies magic, CRC and sequence numbers, and writes the
+ * payloads of healthy frames to stdout or a file. Statistics are printed to
+ * stderr on exit.
+ *
+ * Build (Linux / macOS):
+ * @code
+ *   cc -O2 -I../../src -o trng_recv trng_recv.c trng_host.c ../../src/trng_frame.c
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_recv [-b baud] [-o file] [-n bytes] [-k] [device]
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_frame.h"
+#include "trng_host.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/** @brief Size of the read and write buffers. */
+#define RECV_BUF_SIZE   65536U
+
+/** @brief Set from the signal handler to stop the receive loop. */
+static volatile sig_atomic_t _stop = 0;
+
+/**
+ * @brief  Signal handler for SIGINT / SIGTERM.
+ */
+static void onSignal(int sig) {
+    (void)sig;
+    _stop = 1;
+}
+
+/**
+ * @brief  Print usage to stderr.
+ */
+static void usage(void) {
+    fprintf(stderr,
+        "usage: trng_recv [-b baud] [-o file] [-n bytes] [-k] [device]\n"
+        "  -b baud   serial speed when device is a tty (default 115200)\n"
+        "  -o file   write entropy to file instead of stdout\n"
+        "  -n bytes  stop after writing this many bytes\n"
+        "  -k        keep payloads of frames with health flags set (never\n"
+        "            those of device information frames)\n"
+        "  device    serial device or capture file (default stdin)\n");
+}
+
+int main(int argc, char **argv) {
+    static uint8_t in[RECV_BUF_SIZE];
+    static uint8_t out[RECV_BUF_SIZE];
+    static trng_frame_decoder dec;
+    struct sigaction sa;
+    long baud = 115200L;
+    const char *outPath = NULL;
+    unsigned long long limit = 0ULL;
+    unsigned long long written = 0ULL;
+    int keepFlagged = 0;
+    int inFd = STDIN_FILENO;
+    int outFd = STDOUT_FILENO;
+    size_t outFill = 0U;
+    int status = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:o:n:kh")) != -1) {
+        switch (opt) {
+        case 'b': baud = strtol(optarg, NULL, 10); break;
+        case 'o': outPath = optarg; break;
+        case 'n': limit = strtoull(optarg, NULL, 10); break;
+        case 'k': keepFlagged = 1; break;
+        default:  usage(); return 2;
+        }
+    }
+
+    if (optind < argc) {
+        inFd = trng_hostOpenInput(argv[optind], baud, 0);
+        if (inFd < 0) {
+            return 1;
+        }
+    }
+    if (outPath != NULL) {
+        outFd = open(outPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (outFd < 0) {
+            perror(outPath);
+            return 1;
+        }
+    }
+
+    /* No SA_RESTART: a signal must interrupt a read() waiting on an idle line. */
+    (void)memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onSignal;
+    (void)sigaction(SIGINT, &sa, NULL);
+    (void)sigaction(SIGTERM, &sa, NULL);
+    trng_frameDecoderInit(&dec);
+
+    while ((_stop == 0) && ((limit == 0ULL) || (written < limit))) {
+        ssize_t got = read(inFd, in, sizeof(in));
+        size_t pos = 0U;
+
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("trng_recv: read");
+            status = 1;
+            break;
+        }
+        if (got == 0) {
+            break;
+        }
+
+        while ((pos < (size_t)got) || (dec.payload != NULL)) {
+            uint8_t ready = 0U;
+            pos += trng_frameFeed(&dec, &in[pos], (size_t)got - pos, &ready);
+            if (ready == 0U) {
+                break;
+            }
+            if ((dec.flags & TRNG_FRAME_FLAG_INFO) != 0U) {
+                /* Device information, never written as entropy. */
+            } else if (((dec.flags & TRNG_FRAME_FLAG_HEALTH) == 0U) || (keepFlagged != 0)) {
+                size_t len = dec.payloadLen;
+                if ((limit != 0ULL) && ((limit - written) < len)) {
+                    len = (size_t)(limit - written);
+                }
+                if ((outFill + len) > sizeof(out)) {
+                    if (trng_hostWriteAll(outFd, out, outFill) != 0) {
+                        perror("trng_recv: write");
+                        status = 1;
+                        _stop = 1;
+                        break;
+                    }
+                    outFill = 0U;
+                }
+                (void)memcpy(&out[outFill], dec.payload, len);
+                outFill += len;
+                written += len;
+                if ((limit != 0ULL) && (written >= limit)) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if ((outFill != 0U) && (trng_hostWriteAll(outFd, out, outFill) != 0)) {
+        perror("trng_recv: write");
+        status = 1;
+    }
+
+    fprintf(stderr,
+        "trng_recv: %lu frames, %llu bytes written, %lu CRC errors, "
+        "%lu lost frames, %lu flagged frames, %lu info frames, %lu resyncs, %lu bytes skipped\n",
+        (unsigned long)dec.frames, written, (unsigned long)dec.crcErrors,
+        (unsigned long)dec.lostFrames, (unsigned long)dec.flagged, (unsigned long)dec.infoFrames,
+        (unsigned long)dec.resyncs, (unsigned long)dec.skipped);
+
+    return status;
+}
@@ -0,0 +1,205 @@
+/*******************************************************************************
+ * @file    trng_reentry_check.c
+ * @brief   Re-entry of the SCE5 read from an interrupt, checked on the host.
+ *
+ * Builds src/trng.c unchanged against the FSP stand-ins in fsp/, with a
+ * HW_SCE_RNG_Read() that can run an "interrupt handler" in the middle of
+ * a read, the way a trng_maskRefill() timer interrupt preempts the main
+ * path on the board. For every pair of a main-path call (trng_read128(),
+ * trng_fillRandom(), trng_fillRandomV(), trng_xorRandom(),
+ * trng_randomScalarP256(), trng_maskRefill()) and a handler call
+ * (trng_read128(), trng_fillRandom(), trng_maskRefill(), trng_maskNext()
+ * on an empty ring), the handler fires during a read of the main-path
+ * call, and the check requires that:
+ * - the handler gets TRNG_NOK, and the hardware read is never entered
+ *   twice (read depth 1); trng_maskNext() also leaves 0, not a mask;
+ * - the main-path call still completes with TRNG_OK;
+ * - the handler call succeeds again once the main path is done.
+ *
+ * Build (Linux):
+ * @code
+ *   cc -O2 -Ifsp -I../../src -o trng_reentry_check trng_reentry_check.c ../../src/trng.c ../../src/trng_mask.c
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_reentry_check
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng.h"
+#include "trng_mask.h"
+#include <hw_sce_private.h>
+#include <hw_sce_trng_private.h>
+#include <bsp_api.h>
+
+#include <stdio.h>
+
+/** @brief A library call under test. */
+typedef uint8_t (*call_t)(void);
+
+static unsigned _depth = 0U;
+static unsigned _maxDepth = 0U;
+static unsigned long _reads = 0UL;
+static unsigned long _fireAt = 0UL;
+static call_t _handler = NULL;
+static uint8_t _handlerResult = TRNG_OK;
+static int _fired = 0;
+static uint32_t _counter = 0U;
+
+void HW_SCE_PowerOn(void) {
+}
+
+fsp_err_t HW_SCE_McuSpecificInit(void) {
+    return FSP_SUCCESS;
+}
+
+bsp_unique_id_t const *R_BSP_UniqueIdGet(void) {
+    static const bsp_unique_id_t uid = { { 0x11223344U, 0x55667788U, 0x99AABBCCU, 0xDDEEFF00U } };
+    return &uid;
+}
+
+/**
+ * @brief  Stand-in for the SCE5 read: a counter stream, with the pending
+ *         handler run in the middle of read number _fireAt.
+ */
+fsp_err_t HW_SCE_RNG_Read(uint32_t *out) {
+    unsigned i;
+
+    _depth++;
+    if (_depth > _maxDepth) {
+        _maxDepth = _depth;
+    }
+    _reads++;
+    if ((_handler != NULL) && (_reads == _fireAt)) {
+        call_t handler = _handler;
+        _handler = NULL;
+        _handlerResult = handler();
+        _fired = 1;
+    }
+    for (i = 0U; i < 4U; i++) {
+        out[i] = _counter;
+        _counter++;
+    }
+    _depth--;
+    return FSP_SUCCESS;
+}
+
+static uint32_t _words[8U];
+static uint8_t _bytes[64U];
+static uint8_t _more[40U];
+static uint32_t _ring[16U];
+static uint32_t _handlerRing[4U];
+static uint32_t _handlerMask = 0U;
+
+static uint8_t callRead128(void) {
+    return trng_read128(_words);
+}
+
+static uint8_t callFillRandom(void) {
+    return trng_fillRandom(_bytes, sizeof(_bytes));
+}
+
+static uint8_t callFillRandomV(void) {
+    const trng_iovec iov[2U] = { { _bytes, 24U }, { _more, sizeof(_more) } };
+    return trng_fillRandomV(iov, 2U);
+}
+
+static uint8_t callXorRandom(void) {
+    return trng_xorRandom(_bytes, sizeof(_bytes));
+}
+
+static uint8_t callScalarP256(void) {
+    return trng_randomScalarP256(_words);
+}
+
+static uint8_t callMaskRefill(void) {
+    trng_mask m;
+    (void)trng_maskInit(&m, _ring, 16U, 4U);
+    return trng_maskRefill(&m, 0U);
+}
+
+static uint8_t handlerRead128(void) {
+    uint32_t out[4U];
+    return trng_read128(out);
+}
+
+static uint8_t handlerFillRandom(void) {
+    uint8_t out[20U];
+    return trng_fillRandom(out, sizeof(out));
+}
+
+static uint8_t handlerMaskRefill(void) {
+    trng_mask m;
+    (void)trng_maskInit(&m, _handlerRing, 4U, 4U);
+    return trng_maskRefill(&m, 1U);
+}
+
+static uint8_t handlerMaskNext(void) {
+    trng_mask m;
+    (void)trng_maskInit(&m, _handlerRing, 4U, 4U);
+    _handlerMask = 0xA5A5A5A5U;
+    return trng_maskNext(&m, &_handlerMask);
+}
+
+/** @brief A named call. */
+typedef struct {
+    const char *name;
+    call_t      fn;
+} entry_t;
+
+int main(void) {
+    static const entry_t mains[] = {
+        { "trng_read128", callRead128 },
+        { "trng_fillRandom", callFillRandom },
+        { "trng_fillRandomV", callFillRandomV },
+        { "trng_xorRandom", callXorRandom },
+        { "trng_randomScalarP256", callScalarP256 },
+        { "trng_maskRefill", callMaskRefill },
+    };
+    static const entry_t handlers[] = {
+        { "trng_read128", handlerRead128 },
+        { "trng_fillRandom", handlerFillRandom },
+        { "trng_maskRefill", handlerMaskRefill },
+        { "trng_maskNext", handlerMaskNext },
+    };
+    int fail = 0;
+    size_t m;
+    size_t h;
+
+    if (trng_begin() != TRNG_OK) {
+        fprintf(stderr, "trng_reentry_check: trng_begin failed\n");
+        return 1;
+    }
+    for (m = 0U; m < (sizeof(mains) / sizeof(mains[0])); m++) {
+        for (h = 0U; h < (sizeof(handlers) / sizeof(handlers[0])); h++) {
+            uint8_t mainResult;
+            uint8_t after;
+            uint32_t mask;
+            int ok;
+
+            /* Fire in the first read of the call, so that every call is
+               covered however many blocks it needs. */
+            _maxDepth = 0U;
+            _fired = 0;
+            _handlerResult = TRNG_OK;
+            _handlerMask = 0U;
+            _fireAt = _reads + 1UL;
+            _handler = handlers[h].fn;
+            mainResult = mains[m].fn();
+            _handler = NULL;
+            mask = _handlerMask;
+            after = handlers[h].fn();
+            ok = (_fired != 0) && (_handlerResult == TRNG_NOK) && (mask == 0U) && (_maxDepth == 1U) &&
+                 (mainResult == TRNG_OK) && (after == TRNG_OK);
+            printf("  %-22s preempted by %-16s handler %s, read depth %u, main %s, handler after %s%s\n",
+                   mains[m].name, handlers[h].name, (_handlerResult == TRNG_OK) ? "OK " : "NOK", _maxDepth,
+                   (mainResult == TRNG_OK) ? "OK " : "NOK", (after == TRNG_OK) ? "OK " : "NOK",
+                   ok ? "" : "  FAIL");
+            fail += ok ? 0 : 1;
+        }
+    }
+    printf("%s\n", (fail == 0) ? "ok" : "FAIL");
+    return (fail == 0) ? 0 : 1;
+}
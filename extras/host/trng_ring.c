@@ -0,0 +1,278 @@
+/*******************************************************************************
+ * @file    trng_ring.c
+ * @brief   Shared-memory ring for zero-copy distribution of entropy.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "trng_ring.h"
+#include "trng_host.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** @brief Seconds between two writer checks while a lane is empty. */
+#define TRNG_RING_PROBE     0.005
+
+/**
+ * @brief  Control block of lane @p i.
+ */
+static trng_ring_lane *laneAt(const trng_ring *r, uint32_t i) {
+    size_t stride = sizeof(trng_ring_lane) + r->laneSize;
+    return (trng_ring_lane *)(void *)(r->base + sizeof(trng_ring_header) + ((size_t)i * stride));
+}
+
+/**
+ * @brief  Data area of lane @p i.
+ */
+static uint8_t *laneData(const trng_ring *r, uint32_t i) {
+    return (uint8_t *)laneAt(r, i) + sizeof(trng_ring_lane);
+}
+
+/**
+ * @brief  Size of the whole object.
+ */
+static size_t mapSizeFor(uint32_t lanes, uint32_t laneSize) {
+    return sizeof(trng_ring_header) + ((size_t)lanes * (sizeof(trng_ring_lane) + laneSize));
+}
+
+int trng_ringCreate(trng_ring *r, const char *name, uint32_t lanes, uint32_t laneSize) {
+    trng_ring_header *h;
+    uint32_t i;
+    int fd;
+
+    if ((lanes == 0U) || (laneSize < TRNG_RING_LINE) || ((laneSize & (laneSize - 1U)) != 0U) ||
+        (strlen(name) >= sizeof(r->name))) {
+        errno = EINVAL;
+        return -1;
+    }
+    (void)memset(r, 0, sizeof(*r));
+    r->lanes = lanes;
+    r->laneSize = laneSize;
+    r->mapSize = mapSizeFor(lanes, laneSize);
+    r->writer = 1;
+    (void)strcpy(r->name, name);
+
+    (void)shm_unlink(name);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)r->mapSize) != 0) {
+        (void)close(fd);
+        (void)shm_unlink(name);
+        return -1;
+    }
+    r->base = mmap(NULL, r->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    (void)close(fd);
+    if (r->base == MAP_FAILED) {
+        (void)shm_unlink(name);
+        return -1;
+    }
+
+    for (i = 0U; i < lanes; i++) {
+        trng_ring_lane *l = laneAt(r, i);
+        atomic_init(&l->head, 0U);
+        atomic_init(&l->tail, 0U);
+        atomic_init(&l->owner, 0U);
+    }
+    h = (trng_ring_header *)(void *)r->base;
+    h->lanes = lanes;
+    h->laneSize = laneSize;
+    h->writerPid = (uint32_t)getpid();
+    atomic_init(&h->closed, 0U);
+    h->version = TRNG_RING_VERSION;
+    atomic_thread_fence(memory_order_release);
+    h->magic = TRNG_RING_MAGIC;
+    return 0;
+}
+
+int trng_ringOpen(trng_ring *r, const char *name) {
+    const trng_ring_header *h;
+    struct stat st;
+    uint32_t self = (uint32_t)getpid();
+    uint32_t i;
+    int fd;
+
+    if (strlen(name) >= sizeof(r->name)) {
+        errno = EINVAL;
+        return -1;
+    }
+    (void)memset(r, 0, sizeof(*r));
+    (void)strcpy(r->name, name);
+
+    fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(trng_ring_header))) {
+        (void)close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    r->mapSize = (size_t)st.st_size;
+    r->base = mmap(NULL, r->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    (void)close(fd);
+    if (r->base == MAP_FAILED) {
+        return -1;
+    }
+
+    h = (const trng_ring_header *)(const void *)r->base;
+    if ((h->magic != TRNG_RING_MAGIC) || (h->version != TRNG_RING_VERSION) ||
+        (mapSizeFor(h->lanes, h->laneSize) != r->mapSize)) {
+        (void)munmap(r->base, r->mapSize);
+        errno = EINVAL;
+        return -1;
+    }
+    r->lanes = h->lanes;
+    r->laneSize = h->laneSize;
+
+    for (i = 0U; i < r->lanes; i++) {
+        trng_ring_lane *l = laneAt(r, i);
+        uint32_t expected = 0U;
+        if (atomic_compare_exchange_strong(&l->owner, &expected, self)) {
+            /* Skip whatever a previous reader left unread. */
+            uint64_t head = atomic_load_explicit(&l->head, memory_order_acquire);
+            atomic_store_explicit(&l->tail, head, memory_order_release);
+            r->lane = i;
+            return 0;
+        }
+    }
+
+    (void)munmap(r->base, r->mapSize);
+    errno = EBUSY;
+    return -1;
+}
+
+void trng_ringClose(trng_ring *r) {
+    if ((r->base == NULL) || (r->base == MAP_FAILED)) {
+        return;
+    }
+    if (r->writer != 0) {
+        trng_ring_header *h = (trng_ring_header *)(void *)r->base;
+        atomic_store_explicit(&h->closed, 1U, memory_order_release);
+        (void)shm_unlink(r->name);
+    } else {
+        atomic_store_explicit(&laneAt(r, r->lane)->owner, 0U, memory_order_release);
+    }
+    (void)munmap(r->base, r->mapSize);
+    r->base = NULL;
+}
+
+size_t trng_ringRead(trng_ring *r, uint8_t *dst, size_t len) {
+    trng_ring_lane *l = laneAt(r, r->lane);
+    uint8_t *data = laneData(r, r->lane);
+    uint64_t tail = atomic_load_explicit(&l->tail, memory_order_relaxed);
+    uint64_t head = atomic_load_explicit(&l->head, memory_order_acquire);
+    size_t avail = (size_t)(head - tail);
+    size_t n = (len < avail) ? len : avail;
+    size_t off = (size_t)(tail & (r->laneSize - 1U));
+    size_t first = r->laneSize - off;
+
+    if (first > n) {
+        first = n;
+    }
+    (void)memcpy(dst, &data[off], first);
+    (void)memcpy(&dst[first], data, n - first);
+    (void)memset(&data[off], 0, first);
+    (void)memset(data, 0, n - first);
+    atomic_store_explicit(&l->tail, tail + n, memory_order_release);
+    return n;
+}
+
+/**
+ * @brief  0 once the writer has closed the ring or no longer exists.
+ */
+static int writerAlive(const trng_ring *r) {
+    trng_ring_header *h = (trng_ring_header *)(void *)r->base;
+
+    if (atomic_load_explicit(&h->closed, memory_order_acquire) != 0U) {
+        return 0;
+    }
+    return ((kill((pid_t)h->writerPid, 0) != 0) && (errno == ESRCH)) ? 0 : 1;
+}
+
+int trng_ringReadWait(trng_ring *r, uint8_t *dst, size_t len, double stall) {
+    size_t got = 0U;
+    double last = 0.0;
+    double probe = 0.0;
+
+    while (got < len) {
+        size_t n = trng_ringRead(r, &dst[got], len - got);
+        got += n;
+        if (n != 0U) {
+            last = 0.0;
+        } else {
+            double now = trng_hostNow();
+            if (last == 0.0) {
+                last = now;
+                probe = now + TRNG_RING_PROBE;
+            } else if (now >= probe) {
+                if (writerAlive(r) == 0) {
+                    errno = EPIPE;
+                    return -1;
+                }
+                if ((stall > 0.0) && ((now - last) >= stall)) {
+                    errno = ETIMEDOUT;
+                    return -1;
+                }
+                probe = now + TRNG_RING_PROBE;
+            }
+            (void)sched_yield();
+        }
+    }
+    return 0;
+}
+
+size_t trng_ringSpace(const trng_ring *r, uint32_t lane) {
+    trng_ring_lane *l = laneAt(r, lane);
+    uint64_t head;
+    uint64_t tail;
+
+    if (atomic_load_explicit(&l->owner, memory_order_acquire) == 0U) {
+        return 0U;
+    }
+    head = atomic_load_explicit(&l->head, memory_order_relaxed);
+    tail = atomic_load_explicit(&l->tail, memory_order_acquire);
+    return r->laneSize - (size_t)(head - tail);
+}
+
+size_t trng_ringWrite(trng_ring *r, uint32_t lane, const uint8_t *src, size_t len) {
+    trng_ring_lane *l = laneAt(r, lane);
+    uint8_t *data = laneData(r, lane);
+    uint64_t head = atomic_load_explicit(&l->head, memory_order_relaxed);
+    size_t space = trng_ringSpace(r, lane);
+    size_t n = (len < space) ? len : space;
+    size_t off = (size_t)(head & (r->laneSize - 1U));
+    size_t first = r->laneSize - off;
+
+    if (first > n) {
+        first = n;
+    }
+    (void)memcpy(&data[off], src, first);
+    (void)memcpy(data, &src[first], n - first);
+    atomic_store_explicit(&l->head, head + n, memory_order_release);
+    return n;
+}
+
+uint32_t trng_ringReclaim(trng_ring *r) {
+    uint32_t freed = 0U;
+    uint32_t i;
+
+    for (i = 0U; i < r->lanes; i++) {
+        trng_ring_lane *l = laneAt(r, i);
+        uint32_t pid = atomic_load_explicit(&l->owner, memory_order_acquire);
+        if ((pid != 0U) && (kill((pid_t)pid, 0) != 0) && (errno == ESRCH)) {
+            if (atomic_compare_exchange_strong(&l->owner, &pid, 0U)) {
+                freed++;
+            }
+        }
+    }
+    return freed;
+}
@@ -0,0 +1,151 @@
+/*******************************************************************************
+ * @file    trng_ring.h
+ * @brief   Shared-memory ring for zero-copy distribution of entropy.
+ *
+ * One writer (trngd) publishes verified TRNG bytes into a POSIX shared
+ * memory object; consumer processes map it and read without any system
+ * call on the hot path.
+ *
+ * The object holds a header followed by a fixed number of lanes. Each lane
+ * is a single-producer / single-consumer byte ring owned by at most one
+ * reader, with two monotonic 64-bit cursors on separate cache lines:
+ * - head: bytes published by the writer (store-release after the copy);
+ * - tail: bytes consumed by the reader (store-release after the copy).
+ *
+ * A reader claims a free lane with a compare-and-swap on its owner field,
+ * so no two readers are ever handed the same bytes. Consumed bytes are
+ * cleared before the tail is advanced. Every process that can map the
+ * object can read every lane: its permissions define the trust domain.
+ *
+ * A writer that stops or restarts unlinks the object and creates a new
+ * one, so an old mapping never receives data again. The header records
+ * the writer's PID and a closed flag set before the unlink, and
+ * trng_ringReadWait() gives up when either says the writer is gone, or
+ * when no byte arrives for a caller-set time.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_RING_H
+#define TRNG_RING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Magic value at the start of the object ("TRNG"). */
+#define TRNG_RING_MAGIC     0x474E5254UL
+/** @brief Layout version. */
+#define TRNG_RING_VERSION   2U
+/** @brief Alignment of every shared structure. */
+#define TRNG_RING_LINE      64U
+/** @brief Default stall limit for trng_ringReadWait(), in seconds. */
+#define TRNG_RING_STALL     5.0
+
+/** @brief Object header (one cache line). */
+typedef struct {
+    uint32_t magic;         /**< TRNG_RING_MAGIC. */
+    uint32_t version;       /**< TRNG_RING_VERSION. */
+    uint32_t lanes;         /**< Number of lanes. */
+    uint32_t laneSize;      /**< Data bytes per lane (power of two). */
+    uint32_t writerPid;     /**< PID of the writer. */
+    _Atomic uint32_t closed; /**< Set by the writer before it removes the object. */
+    uint8_t  pad[TRNG_RING_LINE - 24U];
+} trng_ring_header;
+
+/** @brief Lane control block (three cache lines), followed by its data. */
+typedef struct {
+    _Atomic uint64_t head;  /**< Bytes published by the writer. */
+    uint8_t  pad0[TRNG_RING_LINE - 8U];
+    _Atomic uint64_t tail;  /**< Bytes consumed by the reader. */
+    uint8_t  pad1[TRNG_RING_LINE - 8U];
+    _Atomic uint32_t owner; /**< PID of the reader, 0 if the lane is free. */
+    uint8_t  pad2[TRNG_RING_LINE - 4U];
+} trng_ring_lane;
+
+/** @brief Process-local handle on a mapped ring. */
+typedef struct {
+    uint8_t *base;          /**< Start of the mapping. */
+    size_t   mapSize;       /**< Size of the mapping. */
+    uint32_t lanes;         /**< Number of lanes. */
+    uint32_t laneSize;      /**< Data bytes per lane. */
+    uint32_t lane;          /**< Lane owned by this reader (readers only). */
+    int      writer;        /**< 1 for the writer handle. */
+    char     name[64];      /**< Shared memory object name. */
+} trng_ring;
+
+/**
+ * @brief   Create the shared memory object and map it as the writer.
+ *
+ * @param[out] r         Handle.
+ * @param      name      POSIX shm name, e.g. "/trngd".
+ * @param      lanes     Number of lanes (maximum concurrent readers).
+ * @param      laneSize  Data bytes per lane, a power of two.
+ *
+ * @return  0 on success, -1 on error (errno set).
+ */
+int trng_ringCreate(trng_ring *r, const char *name, uint32_t lanes, uint32_t laneSize);
+
+/**
+ * @brief   Map an existing ring and claim a free lane as a reader.
+ *
+ * @param[out] r     Handle.
+ * @param      name  POSIX shm name.
+ *
+ * @return  0 on success, -1 on error (errno set; EBUSY if no lane is free).
+ */
+int trng_ringOpen(trng_ring *r, const char *name);
+
+/**
+ * @brief   Release the lane (reader) or remove the object (writer), then
+ *          unmap.
+ */
+void trng_ringClose(trng_ring *r);
+
+/**
+ * @brief   Read up to @p len bytes from the reader's lane without blocking.
+ *
+ * @return  Number of bytes copied to @p dst.
+ */
+size_t trng_ringRead(trng_ring *r, uint8_t *dst, size_t len);
+
+/**
+ * @brief   Read exactly @p len bytes, polling while the lane is empty.
+ *
+ * Only waits (with sched_yield) when the writer has fallen behind. While
+ * it waits, it checks every few milliseconds that the writer still
+ * serves this object.
+ *
+ * @param      r      Reader handle.
+ * @param[out] dst    Destination; on failure it holds the bytes read so
+ *                    far, which the caller should wipe.
+ * @param      len    Bytes to read.
+ * @param      stall  Longest time in seconds without a new byte, e.g.
+ *                    TRNG_RING_STALL; 0 for no limit.
+ *
+ * @return  0 on success, -1 on error: errno EPIPE if the writer closed
+ *          the ring or exited, ETIMEDOUT if no byte came for @p stall
+ *          seconds. Close the handle and open the ring again to reach a
+ *          restarted writer.
+ */
+int trng_ringReadWait(trng_ring *r, uint8_t *dst, size_t len, double stall);
+
+/**
+ * @brief   Free space in a lane, 0 if the lane has no reader.
+ */
+size_t trng_ringSpace(const trng_ring *r, uint32_t lane);
+
+/**
+ * @brief   Publish up to @p len bytes into a lane.
+ *
+ * @return  Number of bytes published.
+ */
+size_t trng_ringWrite(trng_ring *r, uint32_t lane, const uint8_t *src, size_t len);
+
+/**
+ * @brief   Free lanes whose reader process no longer exists.
+ *
+ * @return  Number of lanes reclaimed.
+ */
+uint32_t trng_ringReclaim(trng_ring *r);
+
+#endif /* TRNG_RING_H */
@@ -0,0 +1,160 @@
+/*******************************************************************************
+ * @file    trng_ring_bench.c
+ * @brief   Multi-process throughput benchmark for the shared-memory ring.
+ *
+ * Forks -r reader processes that each attach to the ring and read -n bytes
+ * in -c byte chunks, then reports per-reader and aggregate throughput.
+ *
+ * Without -m, the benchmark creates its own ring and the parent process
+ * acts as the writer, republishing a fixed random buffer, which measures
+ * the ring itself. With -m, readers attach to a ring published by trngd,
+ * which measures end-to-end delivery.
+ *
+ * Build (Linux):
+ * @code
+ *   cc -O2 -o trng_ring_bench trng_ring_bench.c trng_ring.c trng_host.c
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_ring_bench [-m shm_name] [-r readers] [-n bytes] [-c chunk]
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "trng_host.h"
+#include "trng_ring.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/** @brief Maximum number of reader processes. */
+#define BENCH_MAX_READERS   64
+
+/**
+ * @brief  Reader process body.
+ * @return Process exit status.
+ */
+static int reader(const char *name, unsigned long long total, size_t chunk) {
+    trng_ring r;
+    uint8_t *buf = malloc(chunk);
+    unsigned long long got = 0ULL;
+    double start;
+    double secs;
+
+    if ((buf == NULL) || (trng_ringOpen(&r, name) != 0)) {
+        perror("trng_ring_bench: reader");
+        return 1;
+    }
+    start = trng_hostNow();
+    while (got < total) {
+        size_t n = ((total - got) < chunk) ? (size_t)(total - got) : chunk;
+        if (trng_ringReadWait(&r, buf, n, TRNG_RING_STALL) != 0) {
+            perror("trng_ring_bench: reader");
+            trng_ringClose(&r);
+            free(buf);
+            return 1;
+        }
+        got += n;
+    }
+    secs = trng_hostNow() - start;
+    printf("  reader %d (lane %u): %.1f MB/s\n", (int)getpid(), r.lane,
+           ((double)got / secs) / 1e6);
+    (void)fflush(stdout);
+    trng_ringClose(&r);
+    free(buf);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    static uint8_t src[1U << 16];
+    char ownName[64];
+    const char *name = NULL;
+    trng_ring ring;
+    pid_t pids[BENCH_MAX_READERS];
+    unsigned long long total = 256ULL << 20;
+    size_t chunk = 4096U;
+    int readers = 4;
+    int running;
+    int failed = 0;
+    int status;
+    double start;
+    double secs;
+    int opt;
+    int i;
+
+    while ((opt = getopt(argc, argv, "m:r:n:c:h")) != -1) {
+        switch (opt) {
+        case 'm': name = optarg; break;
+        case 'r': readers = atoi(optarg); break;
+        case 'n': total = strtoull(optarg, NULL, 10); break;
+        case 'c': chunk = (size_t)strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: trng_ring_bench [-m shm_name] [-r readers] [-n bytes] [-c chunk]\n");
+            return 2;
+        }
+    }
+    if ((readers < 1) || (readers > BENCH_MAX_READERS) || (chunk == 0U)) {
+        fprintf(stderr, "trng_ring_bench: invalid arguments\n");
+        return 2;
+    }
+
+    if (name == NULL) {
+        (void)snprintf(ownName, sizeof(ownName), "/trng_ring_bench.%d", (int)getpid());
+        name = ownName;
+        if (trng_ringCreate(&ring, name, (uint32_t)readers, 1U << 20) != 0) {
+            perror(name);
+            return 1;
+        }
+        (void)getrandom(src, sizeof(src), 0);
+    }
+
+    printf("%d readers, %llu bytes each, %zu-byte reads\n", readers, total, chunk);
+    (void)fflush(stdout);
+    start = trng_hostNow();
+    for (i = 0; i < readers; i++) {
+        pids[i] = fork();
+        if (pids[i] == 0) {
+            _exit(reader(name, total, chunk));
+        }
+    }
+
+    running = readers;
+    while (running > 0) {
+        if (name == ownName) {
+            uint32_t lane;
+            for (lane = 0U; lane < ring.lanes; lane++) {
+                size_t space = trng_ringSpace(&ring, lane);
+                size_t n = 1U;
+                while ((space != 0U) && (n != 0U)) {
+                    n = trng_ringWrite(&ring, lane, src, (space < sizeof(src)) ? space : sizeof(src));
+                    space -= n;
+                }
+            }
+        } else {
+            (void)usleep(1000U);
+        }
+        while ((running > 0) && (waitpid(-1, &status, WNOHANG) > 0)) {
+            running--;
+            if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+                failed = 1;
+            }
+        }
+    }
+    secs = trng_hostNow() - start;
+
+    if (name == ownName) {
+        trng_ringClose(&ring);
+    }
+    if (failed != 0) {
+        return 1;
+    }
+    printf("aggregate: %.1f MB/s\n", (((double)total * (double)readers) / secs) / 1e6);
+    return 0;
+}
@@ -0,0 +1,283 @@
+/*******************************************************************************
+ * @file    trng_sim.c
+ * @brief   Simulated boards for testing and benchmarking the host tools.
+ *
+ * Opens one pseudo-terminal per simulated board, prints the slave device
+ * paths on stdout, then streams export frames (see trng_frame.h) on every
+ * pty as fast as the readers accept them, or at a fixed rate per board.
+ * Payloads come from the host RNG, so frames pass the health tests. Each
+ * board starts with a device information frame and repeats it every
+ * SIM_INFO_EVERY frames, like the export example.
+ *
+ * For end-to-end tests (test_recv.sh), -f stops each board after a fixed
+ * number of frames and -w holds streaming until SIGUSR1, so the readers
+ * can open the ptys first. -d, -x and -t drop, corrupt (one payload byte
+ * flipped after the CRC) and truncate (first half only) every n-th frame
+ * by sequence number; info frames are never touched, and when periods
+ * coincide, drop wins over truncate, which wins over corrupt. -R resets
+ * each board once at a sequence number: numbering starts again at 0
+ * with an info frame, and the -f limit then applies to the new run.
+ *
+ * Build (Linux):
+ * @code
+ *   cc -O2 -I../../src -o trng_sim trng_sim.c ../../src/trng_frame.c
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_sim [-n boards] [-r bytes_per_second] [-p payload] [-f frames] [-w]
+ *            [-d drop_every] [-x corrupt_every] [-t truncate_every] [-R reset_at]
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "trng_frame.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/** @brief Maximum number of simulated boards. */
+#define SIM_MAX_BOARDS  64
+/** @brief Entropy frames between two device information frames. */
+#define SIM_INFO_EVERY  1024U
+
+/** @brief One simulated board. */
+typedef struct {
+    int      fd;                                                /**< pty master. */
+    uint8_t  frame[TRNG_FRAME_SIZE(TRNG_FRAME_MAX_PAYLOAD)];    /**< Frame being sent. */
+    size_t   size;                                              /**< Frame size. */
+    size_t   sent;                                              /**< Bytes of frame already sent. */
+    uint32_t seq;                                               /**< Next sequence number. */
+    uint8_t  id[16];                                            /**< Simulated device ID. */
+    double   start;                                             /**< Simulated reset time. */
+    double   budget;                                            /**< Bytes allowed by the rate limit. */
+    uint8_t  reset;                                             /**< 1 once the -R reset happened. */
+} board_t;
+
+/** @brief Set from the signal handler to stop streaming. */
+static volatile sig_atomic_t _stop = 0;
+/** @brief Cleared by SIGUSR1 when started with -w. */
+static volatile sig_atomic_t _hold = 0;
+
+/** @brief Fault periods in frames (0: never) and frames per board (0: unlimited). */
+static uint32_t _dropEvery = 0U;
+static uint32_t _corruptEvery = 0U;
+static uint32_t _truncateEvery = 0U;
+static uint32_t _frameLimit = 0U;
+/** @brief Sequence number at which each board resets once (0: never). */
+static uint32_t _resetAt = 0U;
+
+/**
+ * @brief  Signal handler for SIGINT / SIGTERM.
+ */
+static void onSignal(int sig) {
+    (void)sig;
+    _stop = 1;
+}
+
+/**
+ * @brief  SIGUSR1 handler: start streaming.
+ */
+static void onStart(int sig) {
+    (void)sig;
+    _hold = 0;
+}
+
+/**
+ * @brief  1 if @p seq is a multiple of a non-zero @p period.
+ */
+static int every(uint32_t seq, uint32_t period) {
+    return ((period != 0U) && ((seq % period) == 0U)) ? 1 : 0;
+}
+
+/**
+ * @brief  Monotonic time in seconds.
+ */
+static double now(void) {
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+/**
+ * @brief  Build the next frame of a board.
+ */
+static void nextFrame(board_t *b, size_t payload) {
+    uint8_t *p = &b->frame[TRNG_FRAME_HEADER_SIZE];
+    size_t got = 0U;
+    int skip;
+
+    /* Dropped frames use up their sequence number and send nothing. */
+    do {
+        if ((_resetAt != 0U) && (b->reset == 0U) && (b->seq >= _resetAt)) {
+            b->seq = 0U;
+            b->start = now();
+            b->reset = 1U;
+        }
+        skip = ((b->seq % (SIM_INFO_EVERY + 1U)) != 0U) && (every(b->seq, _dropEvery) != 0);
+        if (skip != 0) {
+            b->seq++;
+        }
+    } while (skip != 0);
+    b->sent = 0U;
+    if ((_frameLimit != 0U) && (b->seq >= _frameLimit)) {
+        b->size = 0U;
+        return;
+    }
+    if ((b->seq % (SIM_INFO_EVERY + 1U)) == 0U) {
+        trng_info info;
+        (void)memcpy(info.deviceId, b->id, sizeof(info.deviceId));
+        info.uptimeMs = (uint32_t)((now() - b->start) * 1000.0);
+        info.source = TRNG_SOURCE_CONDITIONED;
+        info.payloadSize = (uint16_t)payload;
+        trng_infoEncode(p, &info);
+        b->size = trng_frameEncode(b->frame, b->seq, TRNG_FRAME_FLAG_INFO, TRNG_INFO_SIZE);
+        b->seq++;
+        return;
+    }
+    while (got < payload) {
+        ssize_t n = getrandom(&p[got], payload - got, 0);
+        if (n > 0) {
+            got += (size_t)n;
+        }
+    }
+    b->size = trng_frameEncode(b->frame, b->seq, trng_frameHealth(p, payload), payload);
+    if (every(b->seq, _truncateEvery) != 0) {
+        b->size /= 2U;
+    } else if (every(b->seq, _corruptEvery) != 0) {
+        p[0] ^= 0x01U;
+    } else {
+        /* Sent intact. */
+    }
+    b->seq++;
+}
+
+/**
+ * @brief  Open a pty master in raw mode and print its slave path.
+ * @return Master descriptor, or -1 on error.
+ */
+static int openPty(void) {
+    struct termios tio;
+    int fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+    if ((fd < 0) || (grantpt(fd) != 0) || (unlockpt(fd) != 0)) {
+        perror("trng_sim: posix_openpt");
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        (void)tcsetattr(fd, TCSANOW, &tio);
+    }
+    printf("%s\n", ptsname(fd));
+    return fd;
+}
+
+int main(int argc, char **argv) {
+    static board_t boards[SIM_MAX_BOARDS];
+    struct pollfd pfd[SIM_MAX_BOARDS];
+    int count = 1;
+    double rate = 0.0;
+    size_t payload = 256U;
+    double last;
+    int opt;
+    int i;
+
+    while ((opt = getopt(argc, argv, "n:r:p:f:wd:x:t:R:h")) != -1) {
+        switch (opt) {
+        case 'n': count = atoi(optarg); break;
+        case 'r': rate = strtod(optarg, NULL); break;
+        case 'p': payload = (size_t)strtoul(optarg, NULL, 10); break;
+        case 'f': _frameLimit = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'w': _hold = 1; break;
+        case 'd': _dropEvery = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'x': _corruptEvery = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 't': _truncateEvery = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'R': _resetAt = (uint32_t)strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: trng_sim [-n boards] [-r bytes_per_second] [-p payload] [-f frames] [-w]\n"
+                            "                [-d drop_every] [-x corrupt_every] [-t truncate_every] [-R reset_at]\n");
+            return 2;
+        }
+    }
+    if ((count < 1) || (count > SIM_MAX_BOARDS) || (payload == 0U) ||
+        (payload > TRNG_FRAME_MAX_PAYLOAD)) {
+        fprintf(stderr, "trng_sim: invalid arguments\n");
+        return 2;
+    }
+
+    (void)signal(SIGINT, onSignal);
+    (void)signal(SIGTERM, onSignal);
+    (void)signal(SIGPIPE, SIG_IGN);
+    (void)signal(SIGUSR1, onStart);
+
+    for (i = 0; i < count; i++) {
+        boards[i].fd = openPty();
+        if (boards[i].fd < 0) {
+            return 1;
+        }
+        (void)getrandom(boards[i].id, sizeof(boards[i].id), 0);
+        boards[i].start = now();
+        nextFrame(&boards[i], payload);
+    }
+    (void)fflush(stdout);
+
+    while ((_hold != 0) && (_stop == 0)) {
+        (void)usleep(10000U);
+    }
+
+    last = now();
+    while (_stop == 0) {
+        double t = now();
+        for (i = 0; i < count; i++) {
+            pfd[i].fd = boards[i].fd;
+            /* A board past its -f limit has nothing left to send. */
+            pfd[i].events = (boards[i].size != 0U) ? POLLOUT : 0;
+            if (rate > 0.0) {
+                boards[i].budget += (t - last) * rate;
+            }
+        }
+        last = t;
+        if (poll(pfd, (nfds_t)count, 10) < 0) {
+            continue;
+        }
+        for (i = 0; i < count; i++) {
+            board_t *b = &boards[i];
+            ssize_t n = 1;
+            if ((pfd[i].revents & POLLOUT) == 0) {
+                continue;
+            }
+            /* Write until the pty is full or the rate budget is spent. */
+            while (n > 0) {
+                size_t len = b->size - b->sent;
+                if ((rate > 0.0) && (b->budget < (double)len)) {
+                    len = (b->budget > 0.0) ? (size_t)b->budget : 0U;
+                }
+                if (len == 0U) {
+                    break;
+                }
+                n = write(b->fd, &b->frame[b->sent], len);
+                if (n > 0) {
+                    b->sent += (size_t)n;
+                    b->budget -= (double)n;
+                    if (b->sent == b->size) {
+                        nextFrame(b, payload);
+                    }
+                }
+            }
+        }
+        if (rate > 0.0) {
+            (void)usleep(1000U);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,901 @@
+/*******************************************************************************
+ * @file    trng_sts.c
+ * @brief   NIST SP 800-22 rev. 1a statistical tests.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_sts.h"
+
+#include <complex.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(__POPCNT__)
+#warning "no hardware popcount: build with -march=native or -mpopcnt"
+#endif
+
+/** @brief Number of non-overlapping templates of length 9 (aperiodic). */
+#define TEMPLATES       148U
+/** @brief Template length of both template matching tests. */
+#define TEMPLATE_M      9U
+/** @brief pi, M_PI is not ISO C. */
+#define STS_PI          3.14159265358979323846
+
+/**
+ * @brief  Bit @p i of a sequence.
+ */
+static unsigned bitAt(const trng_sts_seq *s, size_t i) {
+    return (unsigned)((s->w[i >> 6] >> (63U - (i & 63U))) & 1U);
+}
+
+/**
+ * @brief  Number of ones in bits [from, from + len).
+ */
+static size_t onesIn(const trng_sts_seq *s, size_t from, size_t len) {
+    size_t end = from + len;
+    size_t ones = 0U;
+    size_t i = from;
+
+    while (i < end) {
+        size_t off = i & 63U;
+        size_t take = ((64U - off) < (end - i)) ? (64U - off) : (end - i);
+        uint64_t v = (s->w[i >> 6] << off) >> (64U - take);
+        ones += (size_t)__builtin_popcountll(v);
+        i += take;
+    }
+    return ones;
+}
+
+/**
+ * @brief  Standard normal cumulative distribution function.
+ */
+static double normalCdf(double x) {
+    return 0.5 * erfc(-x / sqrt(2.0));
+}
+
+double trng_stsIgamc(double a, double x) {
+    const double eps = 1e-15;
+    const double tiny = 1e-300;
+    double lpre;
+    int i;
+
+    if ((x <= 0.0) || (a <= 0.0)) {
+        return 1.0;
+    }
+    lpre = (a * log(x)) - x - lgamma(a);
+    if (x < (a + 1.0)) {
+        /* Series for P(a, x). */
+        double ap = a;
+        double del = 1.0 / a;
+        double sum = del;
+        for (i = 0; i < 10000; i++) {
+            ap += 1.0;
+            del *= x / ap;
+            sum += del;
+            if (fabs(del) < (fabs(sum) * eps)) {
+                break;
+            }
+        }
+        return 1.0 - (sum * exp(lpre));
+    } else {
+        /* Continued fraction for Q(a, x) (modified Lentz). */
+        double b = (x + 1.0) - a;
+        double c = 1.0 / tiny;
+        double d = 1.0 / b;
+        double h = d;
+        for (i = 1; i < 10000; i++) {
+            double an = -(double)i * ((double)i - a);
+            double del;
+            b += 2.0;
+            d = (an * d) + b;
+            if (fabs(d) < tiny) {
+                d = tiny;
+            }
+            c = b + (an / c);
+            if (fabs(c) < tiny) {
+                c = tiny;
+            }
+            d = 1.0 / d;
+            del = d * c;
+            h *= del;
+            if (fabs(del - 1.0) < eps) {
+                break;
+            }
+        }
+        return exp(lpre) * h;
+    }
+}
+
+/**
+ * @brief  2.1 Frequency (monobit) test.
+ */
+static void testFrequency(const trng_sts_seq *s, double *p) {
+    double sum = (2.0 * (double)onesIn(s, 0U, s->n)) - (double)s->n;
+    p[0] = erfc(fabs(sum) / sqrt(2.0 * (double)s->n));
+}
+
+/**
+ * @brief  2.2 Frequency test within a block, M = 128.
+ */
+static void testBlockFrequency(const trng_sts_seq *s, double *p) {
+    const size_t m = 128U;
+    size_t blocks = s->n / m;
+    double chi = 0.0;
+    size_t i;
+
+    for (i = 0U; i < blocks; i++) {
+        double pi = (double)onesIn(s, i * m, m) / (double)m;
+        chi += (pi - 0.5) * (pi - 0.5);
+    }
+    chi *= 4.0 * (double)m;
+    p[0] = trng_stsIgamc((double)blocks / 2.0, chi / 2.0);
+}
+
+/**
+ * @brief  P-value of the cumulative sums test for maximum excursion z.
+ */
+static double cusumP(long n, long z) {
+    double sq = sqrt((double)n);
+    double sum1 = 0.0;
+    double sum2 = 0.0;
+    long k;
+
+    for (k = ((-n / z) + 1) / 4; k <= ((n / z) - 1) / 4; k++) {
+        sum1 += normalCdf((double)((4 * k) + 1) * (double)z / sq) -
+                normalCdf((double)((4 * k) - 1) * (double)z / sq);
+    }
+    for (k = ((-n / z) - 3) / 4; k <= ((n / z) - 1) / 4; k++) {
+        sum2 += normalCdf((double)((4 * k) + 3) * (double)z / sq) -
+                normalCdf((double)((4 * k) + 1) * (double)z / sq);
+    }
+    return (1.0 - sum1) + sum2;
+}
+
+/**
+ * @brief  2.13 Cumulative sums test, forward and backward.
+ */
+static void testCusum(const trng_sts_seq *s, double *p) {
+    long sum = 0;
+    long fwdMax = 0;
+    long fwdMin = 0;
+    long revMax = 0;
+    long revMin = 0;
+    size_t i;
+
+    for (i = 0U; i < s->n; i++) {
+        /* Backward sums use S_0 .. S_(n-1), forward sums S_1 .. S_n. */
+        revMax = (sum > revMax) ? sum : revMax;
+        revMin = (sum < revMin) ? sum : revMin;
+        sum += (bitAt(s, i) != 0U) ? 1 : -1;
+        fwdMax = (sum > fwdMax) ? sum : fwdMax;
+        fwdMin = (sum < fwdMin) ? sum : fwdMin;
+    }
+    p[0] = cusumP((long)s->n, (fwdMax > -fwdMin) ? fwdMax : -fwdMin);
+    p[1] = cusumP((long)s->n, ((sum - revMin) > (revMax - sum)) ? (sum - revMin) : (revMax - sum));
+}
+
+/**
+ * @brief  2.3 Runs test.
+ */
+static void testRuns(const trng_sts_seq *s, double *p) {
+    size_t words = (s->n + 63U) / 64U;
+    double pi = (double)onesIn(s, 0U, s->n) / (double)s->n;
+    size_t changes = 0U;
+    size_t i;
+
+    if (fabs(pi - 0.5) >= (2.0 / sqrt((double)s->n))) {
+        p[0] = 0.0;
+        return;
+    }
+    /* Bit j of w ^ (w << 1) is set where bit j differs from bit j + 1. */
+    for (i = 0U; i < words; i++) {
+        uint64_t next = ((i + 1U) < words) ? s->w[i + 1U] : 0U;
+        uint64_t t = s->w[i] ^ ((s->w[i] << 1) | (next >> 63));
+        size_t valid = ((s->n - 1U) > (i * 64U)) ? ((s->n - 1U) - (i * 64U)) : 0U;
+        if (valid < 64U) {
+            t = (valid == 0U) ? 0U : (t >> (64U - valid)) << (64U - valid);
+        }
+        changes += (size_t)__builtin_popcountll(t);
+    }
+    p[0] = erfc(fabs((double)(changes + 1U) - (2.0 * (double)s->n * pi * (1.0 - pi))) /
+                (2.0 * sqrt(2.0 * (double)s->n) * pi * (1.0 - pi)));
+}
+
+/**
+ * @brief  2.4 Test for the longest run of ones in a block.
+ */
+static void testLongestRun(const trng_sts_seq *s, double *p) {
+    static const double pi6[6] = { 0.1174, 0.2430, 0.2493, 0.1752, 0.1027, 0.1124 };
+    static const double pi7[7] = { 0.0882, 0.2092, 0.2483, 0.1933, 0.1208, 0.0675, 0.0727 };
+    const double *pi;
+    size_t m;
+    unsigned k;
+    unsigned low;
+    double v[7] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    size_t blocks;
+    double chi = 0.0;
+    size_t b;
+    unsigned i;
+
+    if (s->n >= 750000U) {
+        m = 10000U; k = 6U; low = 10U; pi = pi7;
+    } else if (s->n >= 6272U) {
+        m = 128U; k = 5U; low = 4U; pi = pi6;
+    } else {
+        p[0] = NAN;
+        return;
+    }
+    blocks = s->n / m;
+    for (b = 0U; b < blocks; b++) {
+        unsigned run = 0U;
+        unsigned longest = 0U;
+        size_t j;
+        for (j = b * m; j < ((b + 1U) * m); j++) {
+            run = (bitAt(s, j) != 0U) ? (run + 1U) : 0U;
+            longest = (run > longest) ? run : longest;
+        }
+        if (longest < low) {
+            longest = low;
+        }
+        if (longest > (low + k)) {
+            longest = low + k;
+        }
+        v[longest - low] += 1.0;
+    }
+    for (i = 0U; i <= k; i++) {
+        double e = (double)blocks * pi[i];
+        chi += ((v[i] - e) * (v[i] - e)) / e;
+    }
+    p[0] = trng_stsIgamc((double)k / 2.0, chi / 2.0);
+}
+
+/**
+ * @brief  Probability that a random 32 x 32 binary matrix has rank r.
+ */
+static double rankProb(int r) {
+    double prod = 1.0;
+    int i;
+
+    for (i = 0; i < r; i++) {
+        double f = 1.0 - pow(2.0, (double)(i - 32));
+        prod *= (f * f) / (1.0 - pow(2.0, (double)(i - r)));
+    }
+    return pow(2.0, (double)((r * (64 - r)) - 1024)) * prod;
+}
+
+/**
+ * @brief  2.5 Binary matrix rank test, 32 x 32 matrices.
+ */
+static void testRank(const trng_sts_seq *s, double *p) {
+    size_t mats = s->n / 1024U;
+    double f32 = 0.0;
+    double f31 = 0.0;
+    double p32 = rankProb(32);
+    double p31 = rankProb(31);
+    double p30 = (1.0 - p32) - p31;
+    double n;
+    double chi;
+    size_t k;
+
+    if (mats < 38U) {
+        p[0] = NAN;
+        return;
+    }
+    for (k = 0U; k < mats; k++) {
+        uint32_t row[32];
+        int rank = 0;
+        int col;
+        int r;
+        for (r = 0; r < 32; r++) {
+            uint64_t w = s->w[(k * 16U) + ((size_t)r / 2U)];
+            row[r] = (uint32_t)(((r & 1) == 0) ? (w >> 32) : w);
+        }
+        for (col = 31; (col >= 0) && (rank < 32); col--) {
+            uint32_t bit = 1UL << col;
+            for (r = rank; (r < 32) && ((row[r] & bit) == 0U); r++) {
+            }
+            if (r < 32) {
+                uint32_t t = row[r];
+                row[r] = row[rank];
+                row[rank] = t;
+                for (r = rank + 1; r < 32; r++) {
+                    if ((row[r] & bit) != 0U) {
+                        row[r] ^= t;
+                    }
+                }
+                rank++;
+            }
+        }
+        if (rank == 32) {
+            f32 += 1.0;
+        } else if (rank == 31) {
+            f31 += 1.0;
+        }
+    }
+    n = (double)mats;
+    chi = (((f32 - (p32 * n)) * (f32 - (p32 * n))) / (p32 * n)) +
+          (((f31 - (p31 * n)) * (f31 - (p31 * n))) / (p31 * n)) +
+          ((((n - f32 - f31) - (p30 * n)) * ((n - f32 - f31) - (p30 * n))) / (p30 * n));
+    p[0] = exp(-chi / 2.0);
+}
+
+/**
+ * @brief  In-place iterative radix-2 FFT.
+ * @param  inverse  Non-zero for the unscaled inverse transform.
+ */
+static void fft(double complex *a, size_t n, int inverse) {
+    size_t i;
+    size_t j = 0U;
+    size_t len;
+
+    for (i = 1U; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; (j & bit) != 0U; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            double complex t = a[i];
+            a[i] = a[j];
+            a[j] = t;
+        }
+    }
+    for (len = 2U; len <= n; len <<= 1) {
+        double ang = ((inverse != 0) ? 2.0 : -2.0) * STS_PI / (double)len;
+        for (i = 0U; i < n; i += len) {
+            size_t k;
+            for (k = 0U; k < (len / 2U); k++) {
+                double complex w = cexp(I * ang * (double)k);
+                double complex u = a[i + k];
+                double complex v = a[i + k + (len / 2U)] * w;
+                a[i + k] = u + v;
+                a[i + k + (len / 2U)] = u - v;
+            }
+        }
+    }
+}
+
+/**
+ * @brief  2.6 Discrete Fourier transform (spectral) test.
+ *
+ * The DFT of the +-1 sequence is computed exactly for any n with
+ * Bluestein's algorithm on power-of-two FFTs.
+ */
+static void testDft(const trng_sts_seq *s, double *p) {
+    size_t n = s->n;
+    size_t m = 1U;
+    double complex *a;
+    double complex *b;
+    double complex *chirp;
+    double threshold = sqrt(2.995732274 * (double)n);
+    double n0 = 0.95 * (double)n / 2.0;
+    size_t n1 = 0U;
+    size_t k;
+
+    while (m < ((2U * n) - 1U)) {
+        m <<= 1;
+    }
+    a = calloc(m, sizeof(*a));
+    b = calloc(m, sizeof(*b));
+    chirp = malloc(n * sizeof(*chirp));
+    if ((a == NULL) || (b == NULL) || (chirp == NULL)) {
+        free(a);
+        free(b);
+        free(chirp);
+        p[0] = NAN;
+        return;
+    }
+    for (k = 0U; k < n; k++) {
+        /* k^2 mod 2n keeps the chirp angle exact for large n. */
+        uint64_t sq = ((uint64_t)k * (uint64_t)k) % (2U * (uint64_t)n);
+        chirp[k] = cexp(-I * STS_PI * (double)sq / (double)n);
+        a[k] = ((bitAt(s, k) != 0U) ? 1.0 : -1.0) * chirp[k];
+        b[k] = conj(chirp[k]);
+        if (k != 0U) {
+            b[m - k] = conj(chirp[k]);
+        }
+    }
+    fft(a, m, 0);
+    fft(b, m, 0);
+    for (k = 0U; k < m; k++) {
+        a[k] *= b[k];
+    }
+    fft(a, m, 1);
+    for (k = 0U; k < (n / 2U); k++) {
+        if (cabs(chirp[k] * a[k] / (double)m) < threshold) {
+            n1++;
+        }
+    }
+    free(a);
+    free(b);
+    free(chirp);
+    p[0] = erfc(fabs(((double)n1 - n0) / sqrt((double)n * 0.95 * 0.05 / 4.0)) / sqrt(2.0));
+}
+
+/**
+ * @brief  9-bit window starting at every position (n - 8 entries).
+ * @return Array to free, NULL on allocation failure.
+ */
+static uint16_t *windows9(const trng_sts_seq *s) {
+    uint16_t *win = malloc(s->n * sizeof(uint16_t));
+    unsigned v = 0U;
+    size_t i;
+
+    if (win != NULL) {
+        for (i = 0U; i < s->n; i++) {
+            v = ((v << 1) | bitAt(s, i)) & 0x1FFU;
+            if (i >= (TEMPLATE_M - 1U)) {
+                win[i - (TEMPLATE_M - 1U)] = (uint16_t)v;
+            }
+        }
+    }
+    return win;
+}
+
+/**
+ * @brief  2.7 Non-overlapping template matching test, all 148 aperiodic
+ *         templates of length 9, N = 8 blocks.
+ */
+static void testNonOverlapping(const trng_sts_seq *s, double *p) {
+    const size_t blocks = 8U;
+    size_t m = s->n / blocks;
+    double mu = (double)(m - TEMPLATE_M + 1U) / 512.0;
+    double var = (double)m * ((1.0 / 512.0) - (17.0 / (512.0 * 512.0)));
+    uint16_t *win = windows9(s);
+    unsigned t;
+    unsigned idx = 0U;
+
+    if (win == NULL) {
+        for (t = 0U; t < TEMPLATES; t++) {
+            p[t] = NAN;
+        }
+        return;
+    }
+    for (t = 0U; t < 512U; t++) {
+        unsigned shift;
+        int periodic = 0;
+        double chi = 0.0;
+        size_t b;
+        /* Aperiodic: no proper prefix equals the suffix of the same length. */
+        for (shift = 1U; shift < TEMPLATE_M; shift++) {
+            if ((t >> shift) == (t & ((1U << (TEMPLATE_M - shift)) - 1U))) {
+                periodic = 1;
+            }
+        }
+        if (periodic != 0) {
+            continue;
+        }
+        for (b = 0U; b < blocks; b++) {
+            const uint16_t *w = &win[b * m];
+            size_t count = 0U;
+            size_t i = 0U;
+            while (i <= (m - TEMPLATE_M)) {
+                if (w[i] == t) {
+                    count++;
+                    i += TEMPLATE_M;
+                } else {
+                    i++;
+                }
+            }
+            chi += (((double)count - mu) * ((double)count - mu)) / var;
+        }
+        p[idx++] = trng_stsIgamc((double)blocks / 2.0, chi / 2.0);
+    }
+    free(win);
+}
+
+/**
+ * @brief  Probability of u template matches in a block (STS Pr()).
+ */
+static double overlapPr(unsigned u, double eta) {
+    double sum = 0.0;
+    unsigned l;
+
+    if (u == 0U) {
+        return exp(-eta);
+    }
+    for (l = 1U; l <= u; l++) {
+        sum += exp((((-eta - ((double)u * log(2.0))) + ((double)l * log(eta))) -
+                    lgamma((double)l + 1.0)) + lgamma((double)u) - lgamma((double)l) -
+                   lgamma((double)(u - l) + 1.0));
+    }
+    return sum;
+}
+
+/**
+ * @brief  2.8 Overlapping template matching test, template of nine ones,
+ *         M = 1032.
+ *
+ * Uses the class probabilities the STS computes rather than the refined
+ * ones of rev. 1a section 3.8, so P-values match the reference.
+ */
+static void testOverlapping(const trng_sts_seq *s, double *p) {
+    const size_t m = 1032U;
+    size_t blocks = s->n / m;
+    double v[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    double pi[6];
+    double chi = 0.0;
+    uint16_t *win = windows9(s);
+    size_t b;
+    unsigned i;
+
+    if ((win == NULL) || (blocks == 0U)) {
+        free(win);
+        p[0] = NAN;
+        return;
+    }
+    for (b = 0U; b < blocks; b++) {
+        size_t count = 0U;
+        size_t j;
+        for (j = 0U; j <= (m - TEMPLATE_M); j++) {
+            if (win[(b * m) + j] == 0x1FFU) {
+                count++;
+            }
+        }
+        v[(count < 5U) ? count : 5U] += 1.0;
+    }
+    free(win);
+    pi[5] = 1.0;
+    for (i = 0U; i < 5U; i++) {
+        pi[i] = overlapPr(i, (double)(m - TEMPLATE_M + 1U) / 1024.0);
+        pi[5] -= pi[i];
+    }
+    for (i = 0U; i < 6U; i++) {
+        double e = (double)blocks * pi[i];
+        chi += ((v[i] - e) * (v[i] - e)) / e;
+    }
+    p[0] = trng_stsIgamc(5.0 / 2.0, chi / 2.0);
+}
+
+/**
+ * @brief  2.9 Maurer's universal statistical test.
+ */
+static void testUniversal(const trng_sts_seq *s, double *p) {
+    static const double expected[17] = {
+        0.0, 0.73264948, 1.5374383, 2.4016068, 3.3112247, 4.2534266, 5.2177052,
+        6.1962507, 7.1836656, 8.1764248, 9.1723243, 10.170032, 11.168765,
+        12.168070, 13.167693, 14.167488, 15.167379
+    };
+    static const double variance[17] = {
+        0.0, 0.690, 1.338, 1.901, 2.358, 2.705, 2.954, 3.125, 3.238, 3.311,
+        3.356, 3.384, 3.401, 3.410, 3.416, 3.419, 3.421
+    };
+    static const size_t minN[11] = {
+        387840U, 904960U, 2068480U, 4654080U, 10342400U, 22753280U, 49643520U,
+        107560960U, 231669760U, 496435200U, 1059061760U
+    };
+    size_t l = 5U;
+    size_t q;
+    size_t k;
+    size_t *last;
+    double sum = 0.0;
+    double c;
+    double sigma;
+    size_t i;
+
+    while (((l - 5U) < 11U) && (s->n >= minN[l - 5U])) {
+        l++;
+    }
+    if (l == 5U) {
+        p[0] = NAN;
+        return;
+    }
+    q = 10U * ((size_t)1U << l);
+    k = (s->n / l) - q;
+    last = calloc((size_t)1U << l, sizeof(size_t));
+    if (last == NULL) {
+        p[0] = NAN;
+        return;
+    }
+    for (i = 1U; i <= (q + k); i++) {
+        size_t v = 0U;
+        size_t j;
+        for (j = 0U; j < l; j++) {
+            v = (v << 1) | bitAt(s, ((i - 1U) * l) + j);
+        }
+        if (i > q) {
+            sum += log2((double)(i - last[v]));
+        }
+        last[v] = i;
+    }
+    free(last);
+    c = (0.7 - (0.8 / (double)l)) +
+        (((4.0 + (32.0 / (double)l)) * pow((double)k, -3.0 / (double)l)) / 15.0);
+    sigma = c * sqrt(variance[l] / (double)k);
+    p[0] = erfc(fabs((sum / (double)k) - expected[l]) / (sqrt(2.0) * sigma));
+}
+
+/**
+ * @brief  Count the overlapping m-bit patterns of the sequence, wrapping
+ *         around at the end.
+ */
+static void countPatterns(const trng_sts_seq *s, unsigned m, uint32_t *count) {
+    uint32_t mask = (uint32_t)((1UL << m) - 1U);
+    uint32_t v = 0U;
+    size_t i;
+
+    for (i = 0U; i < (m - 1U); i++) {
+        v = (v << 1) | bitAt(s, i);
+    }
+    for (i = 0U; i < s->n; i++) {
+        size_t j = i + m - 1U;
+        v = ((v << 1) | bitAt(s, (j < s->n) ? j : (j - s->n))) & mask;
+        count[v]++;
+    }
+}
+
+/**
+ * @brief  2.12 Approximate entropy test, m = 10.
+ */
+static void testApEn(const trng_sts_seq *s, double *p) {
+    const unsigned m = 10U;
+    uint32_t *c11 = calloc((size_t)1U << (m + 1U), sizeof(uint32_t));
+    double phi[2] = { 0.0, 0.0 };
+    double n = (double)s->n;
+    unsigned v;
+
+    if (c11 == NULL) {
+        p[0] = NAN;
+        return;
+    }
+    countPatterns(s, m + 1U, c11);
+    for (v = 0U; v < (1U << (m + 1U)); v++) {
+        if (c11[v] != 0U) {
+            phi[1] += ((double)c11[v] / n) * log((double)c11[v] / n);
+        }
+    }
+    for (v = 0U; v < (1U << m); v++) {
+        uint32_t c = c11[2U * v] + c11[(2U * v) + 1U];
+        if (c != 0U) {
+            phi[0] += ((double)c / n) * log((double)c / n);
+        }
+    }
+    free(c11);
+    p[0] = trng_stsIgamc((double)(1U << (m - 1U)), n * (log(2.0) - (phi[0] - phi[1])));
+}
+
+/**
+ * @brief  2.11 Serial test, m = 16.
+ */
+static void testSerial(const trng_sts_seq *s, double *p) {
+    const unsigned m = 16U;
+    uint32_t *c = calloc((size_t)1U << m, sizeof(uint32_t));
+    double psi[3];
+    double n = (double)s->n;
+    unsigned k;
+
+    if (c == NULL) {
+        p[0] = NAN;
+        p[1] = NAN;
+        return;
+    }
+    countPatterns(s, m, c);
+    /* psi^2 for m, m - 1 and m - 2; shorter counts are marginals. */
+    for (k = 0U; k < 3U; k++) {
+        unsigned bits = m - k;
+        double sum = 0.0;
+        unsigned v;
+        for (v = 0U; v < (1U << bits); v++) {
+            sum += (double)c[v] * (double)c[v];
+        }
+        psi[k] = ((sum * (double)(1UL << bits)) / n) - n;
+        for (v = 0U; v < (1U << (bits - 1U)); v++) {
+            c[v] = c[2U * v] + c[(2U * v) + 1U];
+        }
+    }
+    free(c);
+    p[0] = trng_stsIgamc((double)(1U << (m - 2U)), (psi[0] - psi[1]) / 2.0);
+    p[1] = trng_stsIgamc((double)(1U << (m - 3U)), ((psi[0] - (2.0 * psi[1])) + psi[2]) / 2.0);
+}
+
+/** @brief Words of a linear complexity bit vector (M = 500). */
+#define LC_WORDS    8U
+
+/**
+ * @brief  dst = src << sh on LC_WORDS-word vectors (bit i in word i / 64).
+ */
+static void vecShl(uint64_t *dst, const uint64_t *src, size_t sh) {
+    size_t ws = sh / 64U;
+    size_t bs = sh % 64U;
+    size_t i;
+
+    for (i = LC_WORDS; i > 0U; i--) {
+        size_t d = i - 1U;
+        uint64_t v = 0U;
+        if (d >= ws) {
+            v = src[d - ws] << bs;
+            if ((bs != 0U) && (d > ws)) {
+                v |= src[d - ws - 1U] >> (64U - bs);
+            }
+        }
+        dst[d] = v;
+    }
+}
+
+/**
+ * @brief  2.10 Linear complexity test, M = 500.
+ *
+ * Berlekamp-Massey over GF(2) with bit-packed polynomials: each
+ * discrepancy is the parity of popcount(C & R), where R holds the
+ * sequence reversed.
+ */
+static void testLinearComplexity(const trng_sts_seq *s, double *p) {
+    static const double pi[7] = { 0.01047, 0.03125, 0.125, 0.5, 0.25, 0.0625, 0.020833 };
+    const size_t m = 500U;
+    size_t blocks = s->n / m;
+    double mu = ((double)m / 2.0) + (8.0 / 36.0) - (((double)m / 3.0) + (2.0 / 9.0)) / pow(2.0, (double)m);
+    double v[7] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    double chi = 0.0;
+    size_t b;
+    unsigned i;
+
+    if (blocks == 0U) {
+        p[0] = NAN;
+        return;
+    }
+    for (b = 0U; b < blocks; b++) {
+        uint64_t c[LC_WORDS] = { 1U };
+        uint64_t bb[LC_WORDS] = { 1U };
+        uint64_t r[LC_WORDS] = { 0U };
+        uint64_t t[LC_WORDS];
+        uint64_t sh[LC_WORDS];
+        size_t l = 0U;
+        long mm = -1;
+        size_t n;
+        double ti;
+
+        for (n = 0U; n < m; n++) {
+            unsigned d = 0U;
+            vecShl(r, r, 1U);
+            r[0] |= bitAt(s, (b * m) + n);
+            for (i = 0U; i < LC_WORDS; i++) {
+                d += (unsigned)__builtin_popcountll(c[i] & r[i]);
+            }
+            if ((d & 1U) != 0U) {
+                (void)memcpy(t, c, sizeof(t));
+                vecShl(sh, bb, n - (size_t)mm);
+                for (i = 0U; i < LC_WORDS; i++) {
+                    c[i] ^= sh[i];
+                }
+                if (l <= (n / 2U)) {
+                    l = (n + 1U) - l;
+                    mm = (long)n;
+                    (void)memcpy(bb, t, sizeof(bb));
+                }
+            }
+        }
+        /* M = 500 is even, so T = (L - mu) + 2/9. */
+        ti = ((double)l - mu) + (2.0 / 9.0);
+        if (ti <= -2.5) {
+            v[0] += 1.0;
+        } else if (ti <= -1.5) {
+            v[1] += 1.0;
+        } else if (ti <= -0.5) {
+            v[2] += 1.0;
+        } else if (ti <= 0.5) {
+            v[3] += 1.0;
+        } else if (ti <= 1.5) {
+            v[4] += 1.0;
+        } else if (ti <= 2.5) {
+            v[5] += 1.0;
+        } else {
+            v[6] += 1.0;
+        }
+    }
+    for (i = 0U; i < 7U; i++) {
+        double e = (double)blocks * pi[i];
+        chi += ((v[i] - e) * (v[i] - e)) / e;
+    }
+    p[0] = trng_stsIgamc(3.0, chi / 2.0);
+}
+
+/**
+ * @brief  Random walk of the +-1 sequence, split into cycles at zeros.
+ * @param  nu  Per cycle visit histograms of the states -4..-1, 1..4,
+ *             visit counts above 4 in the last bin.
+ * @param  xi  Total visits of the states -9..9 (index state + 9).
+ * @return Number of cycles J.
+ */
+static double excursionWalk(const trng_sts_seq *s, double nu[8][6], double xi[19]) {
+    uint32_t visits[8] = { 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U };
+    double cycles = 0.0;
+    long sum = 0;
+    size_t i;
+    unsigned x;
+
+    (void)memset(nu, 0, 8U * sizeof(nu[0]));
+    (void)memset(xi, 0, 19U * sizeof(xi[0]));
+    for (i = 0U; i <= s->n; i++) {
+        if (i < s->n) {
+            sum += (bitAt(s, i) != 0U) ? 1 : -1;
+            if ((sum >= -9) && (sum <= 9)) {
+                xi[sum + 9] += 1.0;
+            }
+            if ((sum >= -4) && (sum <= 4) && (sum != 0)) {
+                visits[(sum < 0) ? (sum + 4) : (sum + 3)]++;
+            }
+        }
+        /* The walk is closed with a final zero if it does not end on one. */
+        if ((i < s->n) ? (sum == 0) : (sum != 0)) {
+            for (x = 0U; x < 8U; x++) {
+                nu[x][(visits[x] < 5U) ? visits[x] : 5U] += 1.0;
+                visits[x] = 0U;
+            }
+            cycles += 1.0;
+        }
+    }
+    return cycles;
+}
+
+/**
+ * @brief  Whether the walk has enough cycles for the excursion tests.
+ */
+static int excursionsApply(const trng_sts_seq *s, double cycles) {
+    return (cycles >= fmax(0.005 * sqrt((double)s->n), 500.0)) ? 1 : 0;
+}
+
+/**
+ * @brief  2.14 Random excursions test, states -4..-1 and 1..4.
+ */
+static void testExcursions(const trng_sts_seq *s, double *p) {
+    double nu[8][6];
+    double xi[19];
+    double j = excursionWalk(s, nu, xi);
+    int x;
+
+    for (x = 0; x < 8; x++) {
+        int state = (x < 4) ? (x - 4) : (x - 3);
+        double a = 1.0 / (2.0 * fabs((double)state));
+        double pi[6];
+        double chi = 0.0;
+        int k;
+        if (excursionsApply(s, j) == 0) {
+            p[x] = NAN;
+            continue;
+        }
+        pi[0] = 1.0 - a;
+        for (k = 1; k < 5; k++) {
+            pi[k] = (1.0 / (4.0 * (double)state * (double)state)) * pow(1.0 - a, (double)(k - 1));
+        }
+        pi[5] = a * pow(1.0 - a, 4.0);
+        for (k = 0; k < 6; k++) {
+            chi += ((nu[x][k] - (j * pi[k])) * (nu[x][k] - (j * pi[k]))) / (j * pi[k]);
+        }
+        p[x] = trng_stsIgamc(5.0 / 2.0, chi / 2.0);
+    }
+}
+
+/**
+ * @brief  2.15 Random excursions variant test, states -9..-1 and 1..9.
+ */
+static void testExcursionsVariant(const trng_sts_seq *s, double *p) {
+    double nu[8][6];
+    double xi[19];
+    double j = excursionWalk(s, nu, xi);
+    int x;
+
+    for (x = 0; x < 18; x++) {
+        int state = (x < 9) ? (x - 9) : (x - 8);
+        p[x] = (excursionsApply(s, j) == 0) ? NAN :
+               erfc(fabs(xi[state + 9] - j) / sqrt(2.0 * j * ((4.0 * fabs((double)state)) - 2.0)));
+    }
+}
+
+const trng_sts_test trng_stsTests[TRNG_STS_TESTS] = {
+    { "Frequency",               0U,   1U,   testFrequency },
+    { "BlockFrequency",          1U,   1U,   testBlockFrequency },
+    { "CumulativeSums",          2U,   2U,   testCusum },
+    { "Runs",                    4U,   1U,   testRuns },
+    { "LongestRun",              5U,   1U,   testLongestRun },
+    { "Rank",                    6U,   1U,   testRank },
+    { "FFT",                     7U,   1U,   testDft },
+    { "NonOverlappingTemplate",  8U,   148U, testNonOverlapping },
+    { "OverlappingTemplate",     156U, 1U,   testOverlapping },
+    { "Universal",               157U, 1U,   testUniversal },
+    { "ApproximateEntropy",      158U, 1U,   testApEn },
+    { "RandomExcursions",        159U, 8U,   testExcursions },
+    { "RandomExcursionsVariant", 167U, 18U,  testExcursionsVariant },
+    { "Serial",                  185U, 2U,   testSerial },
+    { "LinearComplexity",        187U, 1U,   testLinearComplexity }
+};
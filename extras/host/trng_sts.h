@@ -0,0 +1,51 @@
+/*******************************************************************************
+ * @file    trng_sts.h
+ * @brief   NIST SP 800-22 rev. 1a statistical tests.
+ *
+ * The fifteen tests of SP 800-22 with the default parameters of the NIST
+ * reference suite (STS 2.1.2), producing the same 188 P-values per
+ * sequence. Sequences are bit-packed, most significant bit first, so bit
+ * i of a byte stream is bit (63 - i % 64) of word i / 64; counting tests
+ * run on whole words with popcount. Build with -march=native (or at least
+ * -mpopcnt on x86-64) so that popcount is one instruction; otherwise GCC
+ * calls libgcc's software routine, and trng_sts.c warns at compile time.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_STS_H
+#define TRNG_STS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Number of P-values per sequence. */
+#define TRNG_STS_PVALUES    188U
+/** @brief Number of tests. */
+#define TRNG_STS_TESTS      15U
+
+/** @brief Bit-packed sequence. */
+typedef struct {
+    const uint64_t *w;  /**< Words, most significant bit first. */
+    size_t          n;  /**< Number of bits. */
+} trng_sts_seq;
+
+/** @brief Test entry point: writes its P-values, NAN when not applicable. */
+typedef void (*trng_sts_fn)(const trng_sts_seq *s, double *p);
+
+/** @brief Test descriptor. */
+typedef struct {
+    const char *name;   /**< Name as in the STS report. */
+    unsigned    first;  /**< Index of the first P-value. */
+    unsigned    count;  /**< Number of P-values. */
+    trng_sts_fn run;    /**< Implementation. */
+} trng_sts_test;
+
+/** @brief The tests, in STS report order. */
+extern const trng_sts_test trng_stsTests[TRNG_STS_TESTS];
+
+/**
+ * @brief   Regularized upper incomplete gamma function Q(a, x).
+ */
+double trng_stsIgamc(double a, double x);
+
+#endif /* TRNG_STS_H */
@@ -0,0 +1,233 @@
+/*******************************************************************************
+ * @file    trng_writeto_bench.cpp
+ * @brief   trngClass::writeTo() against mock Print sinks on the host.
+ *
+ * Instantiates the writeTo() template from src/trng.h unchanged, with
+ * trng_read128() supplied by a counter stream that costs -r microseconds
+ * per 128-bit block, like a slow SCE5 read. Two mock sinks record the
+ * time and length of every write() call:
+ * - buffered: a -b byte transmit buffer draining at -s bytes/s; write()
+ *   waits until there is room for one byte, then accepts what fits and
+ *   returns short, like a UART or a TCP window;
+ * - blocking: write() takes len / rate seconds and accepts everything,
+ *   like File or a blocking WiFiClient.
+ * Each run checks that the sink received exactly the block stream, in
+ * order, with no chunk repeated or skipped, and prints the write calls,
+ * the time the line sat idle with an empty buffer, and the total time.
+ * The single-buffer loop writeTo() used before (generate, then write
+ * until done) runs on the same sinks for comparison.
+ *
+ * Build (Linux):
+ * @code
+ *   cc -O2 -c trng_host.c
+ *   c++ -std=c++17 -O2 -I../../src -o trng_writeto_bench trng_writeto_bench.cpp trng_host.o
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trng_writeto_bench [-n bytes] [-r us_per_block] [-s bytes_per_second] [-b buffer]
+ * @endcode
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng.h"
+extern "C" {
+#include "trng_host.h"
+}
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static double _blockCost = 2e-6;
+static uint32_t _counter = 0U;
+
+/**
+ * @brief  Busy-wait until @p t (trng_hostNow() seconds).
+ */
+static void waitUntil(double t) {
+    while (trng_hostNow() < t) {
+    }
+}
+
+/**
+ * @brief  Host stand-in for the SCE5 read: consecutive counter words.
+ */
+extern "C" uint8_t trng_read128(uint32_t *out) {
+    waitUntil(trng_hostNow() + _blockCost);
+    for (uint8_t i = 0U; i < 4U; i++) {
+        out[i] = _counter;
+        _counter++;
+    }
+    return TRNG_OK;
+}
+
+/** @brief Mock Print sink recording every write() call. */
+class MockSink {
+public:
+    MockSink(bool blocking, double rate, size_t buffer, size_t capacity)
+        : _blocking(blocking), _rate(rate), _buffer(buffer), _data(static_cast<uint8_t *>(malloc(capacity))),
+          _capacity(capacity) {}
+    ~MockSink() { free(_data); }
+
+    size_t write(const uint8_t *buf, size_t len) {
+        double now = trng_hostNow();
+        size_t n = len;
+
+        if (_calls == 0UL) {
+            _start = now;
+            _last = now;
+        }
+        drain(now);
+        if (_blocking) {
+            waitUntil(now + ((double)len / _rate));
+        } else {
+            if (_level >= (double)_buffer) {
+                /* Full: wait for room for one byte. */
+                waitUntil(now + ((_level - (double)_buffer + 1.0) / _rate));
+                drain(trng_hostNow());
+            }
+            size_t room = _buffer - (size_t)_level;
+            n = (len < room) ? len : room;
+            _level += (double)n;
+        }
+        if ((_received + n) <= _capacity) {
+            (void)memcpy(&_data[_received], buf, n);
+        }
+        _received += n;
+        _calls++;
+        _short += (n < len) ? 1UL : 0UL;
+        return n;
+    }
+
+    /** @brief Time until the buffer empties after the last write. */
+    double finish() {
+        double now = trng_hostNow();
+        drain(now);
+        return _blocking ? (now - _start) : ((now - _start) + (_level / _rate));
+    }
+
+    /** @brief 1 if the bytes received are the counter stream from @p first. */
+    int intact(uint32_t first) const {
+        for (size_t i = 0U; i < _received; i += 4U) {
+            uint32_t w = first + (uint32_t)(i / 4U);
+            if (memcmp(&_data[i], &w, ((_received - i) < 4U) ? (_received - i) : 4U) != 0) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    size_t received() const { return _received; }
+    unsigned long calls() const { return _calls; }
+    unsigned long shortWrites() const { return _short; }
+    double idle() const { return _idle; }
+
+private:
+    /** @brief Drain the buffer up to @p now and account the empty-line time. */
+    void drain(double now) {
+        double out = (now - _last) * _rate;
+        if (!_blocking) {
+            if (out > _level) {
+                _idle += (out - _level) / _rate;
+                _level = 0.0;
+            } else {
+                _level -= out;
+            }
+        }
+        _last = now;
+    }
+
+    bool _blocking;
+    double _rate;
+    size_t _buffer;
+    uint8_t *_data;
+    size_t _capacity;
+    size_t _received = 0U;
+    double _level = 0.0;
+    double _start = 0.0;
+    double _last = 0.0;
+    double _idle = 0.0;
+    unsigned long _calls = 0UL;
+    unsigned long _short = 0UL;
+};
+
+/**
+ * @brief  The single-buffer loop: generate a chunk, then write it out.
+ */
+template <typename Sink>
+static size_t singleBuffer(Sink &out, size_t nBytes) {
+    uint32_t chunk[TRNG_WRITE_CHUNK / 4U];
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(chunk);
+    size_t sent = 0U;
+    bool ok = true;
+
+    while (ok && (sent < nBytes)) {
+        size_t len = ((nBytes - sent) < TRNG_WRITE_CHUNK) ? (nBytes - sent) : TRNG_WRITE_CHUNK;
+        for (size_t w = 0U; ok && ((w * 4U) < len); w += 4U) {
+            ok = (trng_read128(&chunk[w]) == TRNG_OK);
+        }
+        size_t off = 0U;
+        while (ok && (off < len)) {
+            size_t n = out.write(&bytes[off], len - off);
+            off += n;
+            ok = (n != 0U);
+        }
+        sent += off;
+    }
+    return sent;
+}
+
+/**
+ * @brief  Run one loop on one sink and print its record.
+ * @return 0 if the output is complete and intact.
+ */
+static int run(const char *label, bool blocking, bool twoChunks, size_t n, double rate, size_t buffer) {
+    MockSink sink(blocking, rate, buffer, n);
+    uint32_t first = _counter;
+    size_t sent = twoChunks ? TRNG.writeTo(sink, n) : singleBuffer(sink, n);
+    double total = sink.finish();
+    int fail = ((sent != n) || (sink.received() != n) || (sink.intact(first) == 0)) ? 1 : 0;
+
+    printf("  %-22s %7lu writes (%6lu short)  line idle %7.2f ms  total %8.2f ms%s\n", label, sink.calls(),
+           sink.shortWrites(), sink.idle() * 1e3, total * 1e3, (fail != 0) ? "  FAIL" : "");
+    return fail;
+}
+
+int main(int argc, char **argv) {
+    size_t n = 65536U;
+    double rate = 1e6;
+    size_t buffer = 64U;
+    int rc = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:s:b:h")) != -1) {
+        switch (opt) {
+        case 'n': n = strtoul(optarg, NULL, 10); break;
+        case 'r': _blockCost = strtod(optarg, NULL) * 1e-6; break;
+        case 's': rate = strtod(optarg, NULL); break;
+        case 'b': buffer = strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: trng_writeto_bench [-n bytes] [-r us_per_block] [-s bytes_per_second] [-b buffer]\n");
+            return 2;
+        }
+    }
+    if ((rate <= 0.0) || (buffer == 0U)) {
+        fprintf(stderr, "trng_writeto_bench: rate and buffer must be positive\n");
+        return 2;
+    }
+
+    printf("%zu bytes, %u-byte chunks, %.1f us/block, sink %.0f bytes/s\n", n, (unsigned)TRNG_WRITE_CHUNK,
+           _blockCost * 1e6, rate);
+    printf("buffered sink (%zu-byte transmit buffer):\n", buffer);
+    rc |= run("writeTo", false, true, n, rate, buffer);
+    rc |= run("single buffer", false, false, n, rate, buffer);
+    printf("blocking sink:\n");
+    rc |= run("writeTo", true, true, n, rate, buffer);
+    rc |= run("single buffer", true, false, n, rate, buffer);
+    /* Odd lengths: partial last chunk and partial last block. */
+    rc |= run("writeTo, 1 byte", false, true, 1U, rate, buffer);
+    rc |= run("writeTo, 4099 bytes", false, true, 4099U, rate, buffer);
+    return rc;
+}
@@ -0,0 +1,531 @@
+/*******************************************************************************
+ * @file    trngd.c
+ * @brief   Host entropy daemon serving several boards over a Unix socket.
+ *
+ * Reads N framed entropy streams (see trng_frame.h) in parallel from an
+ * epoll loop, with one frame decoder and one health state per stream. A
+ * stream whose frames carry health-test failures (TRNG_FRAME_FLAG_HEALTH)
+ * is quarantined: its next TRNGD_QUARANTINE frames are discarded. Device
+ * information frames are skipped without affecting the health state.
+ * Payloads of healthy frames are appended to a shared pool; once the pool
+ * is full, new payloads are XORed into it instead of being dropped.
+ *
+ * Client protocol (SOCK_STREAM on a Unix domain socket): a request is a
+ * 4-byte little-endian byte count between 1 and TRNGD_MAX_REQUEST. The
+ * daemon answers every request with exactly that many bytes, in request
+ * order, as soon as the pool holds them. Clients batch by sending several
+ * requests in one write.
+ *
+ * Build (Linux):
+ * @code
+ *   cc -O2 -I../../src -o trngd trngd.c trng_host.c trng_ring.c ../../src/trng_frame.c
+ * @endcode
+ *
+ * Usage:
+ * @code
+ *   trngd [-s socket] [-b baud] [-p pool_kib] [-m shm_name [-l lanes] [-L lane_kib]] device...
+ * @endcode
+ * SIGUSR1 prints per-stream statistics to stderr.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "trng_frame.h"
+#include "trng_host.h"
+#include "trng_ring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+/** @brief Maximum number of board streams. */
+#define TRNGD_MAX_STREAMS   64
+/** @brief Maximum number of connected clients. */
+#define TRNGD_MAX_CLIENTS   256
+/** @brief Largest byte count accepted in one request. */
+#define TRNGD_MAX_REQUEST   (1UL << 20)
+/** @brief Largest number of bytes a client may have outstanding. */
+#define TRNGD_MAX_PENDING   (64UL << 20)
+/** @brief Frames discarded after a frame with health flags. */
+#define TRNGD_QUARANTINE    64U
+/** @brief Read size per stream wakeup. */
+#define TRNGD_READ_SIZE     16384U
+/** @brief Per-client output buffer size. */
+#define TRNGD_OUT_SIZE      65536U
+/** @brief Default socket path. */
+#define TRNGD_SOCKET        "/tmp/trngd.sock"
+
+/** @brief Tag stored in epoll data to tell descriptors apart. */
+enum { TAG_LISTEN = 0, TAG_STREAM = 1, TAG_CLIENT = 2 };
+
+/** @brief One board stream. */
+typedef struct {
+    const char *path;               /**< Device path. */
+    int fd;                         /**< Descriptor, -1 once closed. */
+    trng_frame_decoder dec;         /**< Frame decoder. */
+    uint32_t quarantine;            /**< Frames still to discard. */
+    unsigned long long pooled;      /**< Payload bytes added to the pool. */
+    unsigned long long discarded;   /**< Payload bytes discarded by health checks. */
+} stream_t;
+
+/** @brief One connected client. */
+typedef struct {
+    int fd;                         /**< Descriptor, -1 if the slot is free. */
+    uint8_t req[4];                 /**< Partial request. */
+    size_t reqFill;                 /**< Bytes in req. */
+    unsigned long pending;          /**< Bytes requested and not yet queued. */
+    uint8_t out[TRNGD_OUT_SIZE];    /**< Bytes queued for sending. */
+    size_t outPos;                  /**< First unsent byte in out. */
+    size_t outLen;                  /**< End of queued bytes in out. */
+    int wantOut;                    /**< 1 if EPOLLOUT is armed. */
+} client_t;
+
+/** @brief Shared entropy pool (ring buffer). */
+typedef struct {
+    uint8_t *buf;                   /**< Storage. */
+    size_t size;                    /**< Capacity. */
+    size_t head;                    /**< Oldest byte. */
+    size_t count;                   /**< Bytes held. */
+    size_t mixPos;                  /**< Next byte to XOR into when full. */
+    unsigned long long mixed;       /**< Bytes XORed into a full pool. */
+    unsigned long long served;      /**< Bytes handed to clients. */
+} pool_t;
+
+static stream_t _streams[TRNGD_MAX_STREAMS];
+static client_t _clients[TRNGD_MAX_CLIENTS];
+static pool_t _pool;
+static trng_ring _ring;
+static int _useRing = 0;
+static int _nStreams = 0;
+static int _epfd = -1;
+static volatile sig_atomic_t _stop = 0;
+static volatile sig_atomic_t _dump = 0;
+
+/**
+ * @brief  Signal handler: SIGUSR1 requests statistics, others stop.
+ */
+static void onSignal(int sig) {
+    if (sig == SIGUSR1) {
+        _dump = 1;
+    } else {
+        _stop = 1;
+    }
+}
+
+/**
+ * @brief  Add payload bytes to the pool, mixing them in once it is full.
+ */
+static void poolPut(pool_t *p, const uint8_t *data, size_t len) {
+    size_t i = 0U;
+
+    while ((i < len) && (p->count < p->size)) {
+        p->buf[(p->head + p->count) % p->size] = data[i];
+        p->count++;
+        i++;
+    }
+    while (i < len) {
+        p->buf[(p->head + p->mixPos) % p->size] ^= data[i];
+        p->mixPos = (p->mixPos + 1U) % p->size;
+        p->mixed++;
+        i++;
+    }
+}
+
+/**
+ * @brief  Take up to @p len bytes from the pool, oldest first.
+ * @return Number of bytes taken.
+ */
+static size_t poolTake(pool_t *p, uint8_t *dst, size_t len) {
+    size_t n = (len < p->count) ? len : p->count;
+    size_t first = p->size - p->head;
+
+    if (first > n) {
+        first = n;
+    }
+    (void)memcpy(dst, &p->buf[p->head], first);
+    (void)memcpy(&dst[first], p->buf, n - first);
+    (void)memset(&p->buf[p->head], 0, first);
+    (void)memset(p->buf, 0, n - first);
+    p->head = (p->head + n) % p->size;
+    p->count -= n;
+    p->mixPos = 0U;
+    p->served += n;
+    return n;
+}
+
+/**
+ * @brief  Register a descriptor with epoll.
+ */
+static int watch(int fd, int tag, int index, uint32_t events, int op) {
+    struct epoll_event ev;
+
+    ev.events = events;
+    ev.data.u64 = ((uint64_t)(uint32_t)tag << 32) | (uint32_t)index;
+    return epoll_ctl(_epfd, op, fd, &ev);
+}
+
+/**
+ * @brief  Close a client and free its slot.
+ */
+static void dropClient(client_t *c) {
+    (void)epoll_ctl(_epfd, EPOLL_CTL_DEL, c->fd, NULL);
+    (void)close(c->fd);
+    (void)memset(c->out, 0, sizeof(c->out));
+    c->fd = -1;
+}
+
+/**
+ * @brief  Move pool bytes into a client's output buffer and send them.
+ */
+static void serveClient(client_t *c, int index) {
+    int again = 1;
+
+    while ((again != 0) && (c->fd >= 0)) {
+        again = 0;
+        if ((c->outPos == c->outLen) && (c->pending != 0UL) && (_pool.count != 0U)) {
+            size_t want = (c->pending < TRNGD_OUT_SIZE) ? (size_t)c->pending : TRNGD_OUT_SIZE;
+            c->outPos = 0U;
+            c->outLen = poolTake(&_pool, c->out, want);
+            c->pending -= c->outLen;
+        }
+        if (c->outPos < c->outLen) {
+            ssize_t n = send(c->fd, &c->out[c->outPos], c->outLen - c->outPos, MSG_NOSIGNAL);
+            if (n > 0) {
+                c->outPos += (size_t)n;
+                again = (c->outPos == c->outLen) ? 1 : 0;
+            } else if ((n < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+                if (c->wantOut == 0) {
+                    c->wantOut = 1;
+                    (void)watch(c->fd, TAG_CLIENT, index, EPOLLIN | EPOLLOUT, EPOLL_CTL_MOD);
+                }
+            } else if ((n < 0) && (errno == EINTR)) {
+                again = 1;
+            } else {
+                dropClient(c);
+            }
+        }
+    }
+
+    if ((c->fd >= 0) && (c->wantOut != 0) && (c->outPos == c->outLen)) {
+        c->wantOut = 0;
+        (void)watch(c->fd, TAG_CLIENT, index, EPOLLIN, EPOLL_CTL_MOD);
+    }
+}
+
+/**
+ * @brief  Serve every client with outstanding requests, in slot order.
+ */
+static void serveAll(void) {
+    int i;
+
+    for (i = 0; (i < TRNGD_MAX_CLIENTS) && (_pool.count != 0U); i++) {
+        if ((_clients[i].fd >= 0) && (_clients[i].pending != 0UL)) {
+            serveClient(&_clients[i], i);
+        }
+    }
+}
+
+/**
+ * @brief  Top up every claimed ring lane from the pool.
+ */
+static void fillRing(void) {
+    uint8_t buf[TRNGD_OUT_SIZE];
+    uint32_t i;
+
+    for (i = 0U; (i < _ring.lanes) && (_pool.count != 0U); i++) {
+        size_t space = trng_ringSpace(&_ring, i);
+        while ((space != 0U) && (_pool.count != 0U)) {
+            size_t n = poolTake(&_pool, buf, (space < sizeof(buf)) ? space : sizeof(buf));
+            size_t put = trng_ringWrite(&_ring, i, buf, n);
+            if (put < n) {
+                /* Reader detached meanwhile: return the bytes to the pool. */
+                poolPut(&_pool, &buf[put], n - put);
+                space = 0U;
+            } else {
+                space -= n;
+            }
+        }
+    }
+    (void)memset(buf, 0, sizeof(buf));
+}
+
+/**
+ * @brief  Read and parse requests from a client.
+ */
+static void readClient(client_t *c, int index) {
+    uint8_t buf[4096];
+    ssize_t n = recv(c->fd, buf, sizeof(buf), 0);
+    ssize_t i;
+
+    if (n <= 0) {
+        if ((n == 0) || ((errno != EAGAIN) && (errno != EINTR))) {
+            dropClient(c);
+        }
+        return;
+    }
+    for (i = 0; i < n; i++) {
+        c->req[c->reqFill] = buf[i];
+        c->reqFill++;
+        if (c->reqFill == 4U) {
+            unsigned long len = (unsigned long)c->req[0] | ((unsigned long)c->req[1] << 8) |
+                                ((unsigned long)c->req[2] << 16) | ((unsigned long)c->req[3] << 24);
+            c->reqFill = 0U;
+            if ((len == 0UL) || (len > TRNGD_MAX_REQUEST) ||
+                ((c->pending + len) > TRNGD_MAX_PENDING)) {
+                dropClient(c);
+                return;
+            }
+            c->pending += len;
+        }
+    }
+    serveClient(c, index);
+}
+
+/**
+ * @brief  Accept pending connections.
+ */
+static void acceptClients(int lfd) {
+    int fd;
+
+    while ((fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        int i = 0;
+        while ((i < TRNGD_MAX_CLIENTS) && (_clients[i].fd >= 0)) {
+            i++;
+        }
+        if (i == TRNGD_MAX_CLIENTS) {
+            (void)close(fd);
+            continue;
+        }
+        _clients[i].fd = fd;
+        _clients[i].reqFill = 0U;
+        _clients[i].pending = 0UL;
+        _clients[i].outPos = 0U;
+        _clients[i].outLen = 0U;
+        _clients[i].wantOut = 0;
+        (void)watch(fd, TAG_CLIENT, i, EPOLLIN, EPOLL_CTL_ADD);
+    }
+}
+
+/**
+ * @brief  Read a stream, run its health checks and pool healthy payloads.
+ */
+static void readStream(stream_t *s) {
+    uint8_t buf[TRNGD_READ_SIZE];
+    ssize_t n = read(s->fd, buf, sizeof(buf));
+    size_t pos = 0U;
+
+    if (n <= 0) {
+        if ((n == 0) || ((errno != EAGAIN) && (errno != EINTR))) {
+            fprintf(stderr, "trngd: %s: stream closed\n", s->path);
+            (void)epoll_ctl(_epfd, EPOLL_CTL_DEL, s->fd, NULL);
+            (void)close(s->fd);
+            s->fd = -1;
+        }
+        return;
+    }
+
+    while ((pos < (size_t)n) || (s->dec.payload != NULL)) {
+        uint8_t ready = 0U;
+        pos += trng_frameFeed(&s->dec, &buf[pos], (size_t)n - pos, &ready);
+        if (ready == 0U) {
+            break;
+        }
+        if ((s->dec.flags & TRNG_FRAME_FLAG_INFO) != 0U) {
+            /* Device information, not entropy: never pooled, not a failure. */
+        } else if ((s->dec.flags & TRNG_FRAME_FLAG_HEALTH) != 0U) {
+            if (s->quarantine == 0U) {
+                fprintf(stderr, "trngd: %s: health flags 0x%02X at frame %lu, quarantined\n",
+                        s->path, s->dec.flags, (unsigned long)s->dec.seq);
+            }
+            s->quarantine = TRNGD_QUARANTINE;
+            s->discarded += s->dec.payloadLen;
+        } else if (s->quarantine != 0U) {
+            s->quarantine--;
+            s->discarded += s->dec.payloadLen;
+        } else {
+            poolPut(&_pool, s->dec.payload, s->dec.payloadLen);
+            s->pooled += s->dec.payloadLen;
+        }
+    }
+}
+
+/**
+ * @brief  Print per-stream and pool statistics to stderr.
+ */
+static void dumpStats(void) {
+    int i;
+
+    for (i = 0; i < _nStreams; i++) {
+        const stream_t *s = &_streams[i];
+        fprintf(stderr,
+            "trngd: %s: %s, %lu frames, %llu pooled, %llu discarded, %lu CRC errors, "
+            "%lu lost, %lu resyncs, %lu flagged, %lu info\n",
+            s->path, (s->fd < 0) ? "closed" : ((s->quarantine != 0U) ? "quarantined" : "healthy"),
+            (unsigned long)s->dec.frames, s->pooled, s->discarded,
+            (unsigned long)s->dec.crcErrors, (unsigned long)s->dec.lostFrames,
+            (unsigned long)s->dec.resyncs, (unsigned long)s->dec.flagged, (unsigned long)s->dec.infoFrames);
+    }
+    fprintf(stderr, "trngd: pool %zu/%zu bytes, %llu served, %llu mixed\n",
+            _pool.count, _pool.size, _pool.served, _pool.mixed);
+}
+
+/**
+ * @brief  Create the listening Unix socket.
+ * @return Descriptor, or -1 on error.
+ */
+static int listenOn(const char *path) {
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (fd < 0) {
+        perror("trngd: socket");
+        return -1;
+    }
+    (void)memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "trngd: socket path too long\n");
+        (void)close(fd);
+        return -1;
+    }
+    (void)strcpy(addr.sun_path, path);
+    (void)unlink(path);
+    if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) || (listen(fd, 64) != 0)) {
+        perror(path);
+        (void)close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char **argv) {
+    struct epoll_event events[64];
+    const char *sockPath = TRNGD_SOCKET;
+    long baud = 115200L;
+    size_t poolKib = 1024U;
+    const char *shmName = NULL;
+    uint32_t lanes = 16U;
+    uint32_t laneKib = 256U;
+    time_t lastReclaim = 0;
+    int lfd;
+    int opt;
+    int i;
+
+    while ((opt = getopt(argc, argv, "s:b:p:m:l:L:h")) != -1) {
+        switch (opt) {
+        case 's': sockPath = optarg; break;
+        case 'b': baud = strtol(optarg, NULL, 10); break;
+        case 'p': poolKib = (size_t)strtoul(optarg, NULL, 10); break;
+        case 'm': shmName = optarg; break;
+        case 'l': lanes = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'L': laneKib = (uint32_t)strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: trngd [-s socket] [-b baud] [-p pool_kib] "
+                            "[-m shm_name [-l lanes] [-L lane_kib]] device...\n");
+            return 2;
+        }
+    }
+    if ((optind >= argc) || ((argc - optind) > TRNGD_MAX_STREAMS) || (poolKib == 0U)) {
+        fprintf(stderr, "usage: trngd [-s socket] [-b baud] [-p pool_kib] "
+                        "[-m shm_name [-l lanes] [-L lane_kib]] device...\n");
+        return 2;
+    }
+    if (shmName != NULL) {
+        if (trng_ringCreate(&_ring, shmName, lanes, laneKib * 1024U) != 0) {
+            perror(shmName);
+            return 1;
+        }
+        _useRing = 1;
+    }
+
+    _pool.size = poolKib * 1024U;
+    _pool.buf = calloc(1U, _pool.size);
+    _epfd = epoll_create1(EPOLL_CLOEXEC);
+    if ((_pool.buf == NULL) || (_epfd < 0)) {
+        perror("trngd");
+        return 1;
+    }
+    for (i = 0; i < TRNGD_MAX_CLIENTS; i++) {
+        _clients[i].fd = -1;
+    }
+
+    for (i = optind; i < argc; i++) {
+        stream_t *s = &_streams[_nStreams];
+        s->path = argv[i];
+        s->fd = trng_hostOpenInput(argv[i], baud, 1);
+        if (s->fd < 0) {
+            return 1;
+        }
+        trng_frameDecoderInit(&s->dec);
+        (void)watch(s->fd, TAG_STREAM, _nStreams, EPOLLIN, EPOLL_CTL_ADD);
+        _nStreams++;
+    }
+
+    lfd = listenOn(sockPath);
+    if (lfd < 0) {
+        return 1;
+    }
+    (void)watch(lfd, TAG_LISTEN, 0, EPOLLIN, EPOLL_CTL_ADD);
+
+    (void)signal(SIGINT, onSignal);
+    (void)signal(SIGTERM, onSignal);
+    (void)signal(SIGUSR1, onSignal);
+    (void)signal(SIGPIPE, SIG_IGN);
+
+    while (_stop == 0) {
+        int n = epoll_wait(_epfd, events, 64, 1000);
+        int pooled = 0;
+
+        for (i = 0; i < n; i++) {
+            int tag = (int)(events[i].data.u64 >> 32);
+            int index = (int)(events[i].data.u64 & 0xFFFFFFFFU);
+            if (tag == TAG_LISTEN) {
+                acceptClients(lfd);
+            } else if (tag == TAG_STREAM) {
+                if (_streams[index].fd >= 0) {
+                    readStream(&_streams[index]);
+                    pooled = 1;
+                }
+            } else if (_clients[index].fd >= 0) {
+                if ((events[i].events & (EPOLLERR | EPOLLHUP)) != 0U) {
+                    dropClient(&_clients[index]);
+                } else if ((events[i].events & EPOLLIN) != 0U) {
+                    readClient(&_clients[index], index);
+                } else {
+                    serveClient(&_clients[index], index);
+                }
+            } else {
+                /* Client closed earlier in this batch. */
+            }
+        }
+        if (pooled != 0) {
+            serveAll();
+            if (_useRing != 0) {
+                fillRing();
+            }
+        }
+        if ((_useRing != 0) && (time(NULL) != lastReclaim)) {
+            lastReclaim = time(NULL);
+            (void)trng_ringReclaim(&_ring);
+        }
+        if (_dump != 0) {
+            _dump = 0;
+            dumpStats();
+        }
+    }
+
+    dumpStats();
+    if (_useRing != 0) {
+        trng_ringClose(&_ring);
+    }
+    (void)unlink(sockPath);
+    return 0;
+}
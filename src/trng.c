@@ -14,10 +14,133 @@
 #include "trng.h"
 #include <hw_sce_private.h>
 #include <hw_sce_trng_private.h>
+#include <bsp_api.h>
+#include <string.h>
 
 /** @brief Tracks initialization state (0 = not ready, 1 = ready). */
 static uint8_t _initialized = 0U;
 
+/** @brief Set while HW_SCE_RNG_Read() runs, so an interrupt cannot re-enter it. */
+static volatile uint8_t _reading = 0U;
+
+/** @brief Buffered 128-bit block shared by the word-level generators. */
+static uint32_t _pool[4U];
+/** @brief Index of the next unread word in _pool (4 = empty). */
+static uint8_t _poolPos = 4U;
+
+/** @brief Bit reservoir refilled one pool word at a time. */
+static uint64_t _bits = 0U;
+/** @brief Number of valid bits in _bits. */
+static uint8_t _bitCount = 0U;
+
+/** @brief Lowercase hex digits, as RFC 9562 recommends for UUID text. */
+static const char _hexLower[] = "0123456789abcdef";
+
+/** @brief Uppercase hex digits used by trng_fillHex(). */
+static const char _hexUpper[] = "0123456789ABCDEF";
+
+/** @brief Standard base64 alphabet (RFC 4648, section 4). */
+static const char _base64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/** @brief Order of the NIST P-256 group, least significant word first. */
+const uint32_t trng_orderP256[TRNG_SCALAR_WORDS] = {
+    0xFC632551U, 0xF3B9CAC2U, 0xA7179E84U, 0xBCE6FAADU, 0xFFFFFFFFU, 0xFFFFFFFFU, 0x00000000U, 0xFFFFFFFFU
+};
+
+/** @brief Order of the Curve25519 prime-order subgroup, 2^252 + 2774...8493, least significant word first. */
+const uint32_t trng_orderCurve25519[TRNG_SCALAR_WORDS] = {
+    0x5CF5D3EDU, 0x5812631AU, 0xA2F79CD6U, 0x14DEF9DEU, 0x00000000U, 0x00000000U, 0x00000000U, 0x10000000U
+};
+
+/**
+ * @brief  Take the next 32-bit word from the buffered hardware block.
+ *
+ * The SCE5 is only read again once all four words of the previous block
+ * have been handed out. Each word is cleared as soon as it is consumed.
+ *
+ * @param[out] out  Pointer to a uint32_t.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ */
+static uint8_t trng_poolWord(uint32_t *out) {
+    uint8_t result = TRNG_OK;
+
+    if (_poolPos >= 4U) {
+        result = trng_read128(_pool);
+        if (result == TRNG_OK) {
+            _poolPos = 0U;
+        }
+    }
+
+    if (result == TRNG_OK) {
+        *out = _pool[_poolPos];
+        _pool[_poolPos] = 0U;
+        _poolPos++;
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Take the next @p n bits (1..32) from the bit reservoir.
+ *
+ * Narrow draws share each pool word, so no random bit is discarded.
+ *
+ * @param[out] out  Pointer to a uint32_t, receives the bits right-aligned.
+ * @param      n    Number of bits, 1 to 32.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ */
+static uint8_t trng_poolBits(uint32_t *out, uint8_t n) {
+    uint8_t result = TRNG_OK;
+
+    if (_bitCount < n) {
+        uint32_t w;
+        result = trng_poolWord(&w);
+        if (result == TRNG_OK) {
+            _bits |= (uint64_t)w << _bitCount;
+            _bitCount = (uint8_t)(_bitCount + 32U);
+        }
+    }
+
+    if (result == TRNG_OK) {
+        *out = (uint32_t)(_bits & ((1ULL << n) - 1ULL));
+        _bits >>= n;
+        _bitCount = (uint8_t)(_bitCount - n);
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Fill @p len bytes from the bit reservoir, 32 bits at a time.
+ * @param[out] dst  Destination bytes.
+ * @param      len  Number of bytes.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ */
+static uint8_t trng_poolBytes(uint8_t *dst, size_t len) {
+    uint8_t result = TRNG_OK;
+    size_t i = 0U;
+
+    while ((i < len) && (result == TRNG_OK)) {
+        size_t chunk = ((len - i) < 4U) ? (len - i) : 4U;
+        uint32_t v;
+        result = trng_poolBits(&v, (uint8_t)(chunk * 8U));
+        if (result == TRNG_OK) {
+            size_t j;
+            for (j = 0U; j < chunk; j++) {
+                dst[i] = (uint8_t)(v & 0xFFU);
+                v >>= 8U;
+                i++;
+            }
+        }
+    }
+
+    return result;
+}
+
 /**
  * @brief  Initialize the SCE hardware for TRNG use.
  * @retval TRNG_OK   Success.
@@ -42,15 +165,19 @@ uint8_t trng_begin(void) {
  * @brief  Read 128 bits of true random data.
  * @param[out] out  Buffer of at least 4 uint32_t.
  * @retval TRNG_OK   Success.
- * @retval TRNG_NOK  Read failed or not initialized.
+ * @retval TRNG_NOK  Read failed, not initialized, or a read in progress.
  */
 uint8_t trng_read128(uint32_t *out) {
     uint8_t result = TRNG_NOK;
 
-    if ((_initialized != 0U) && (out != NULL)) {
+    /* A preempting caller runs to completion before the preempted one
+       resumes, so a plain flag is enough on this single core. */
+    if ((_initialized != 0U) && (out != NULL) && (_reading == 0U)) {
+        _reading = 1U;
         if (HW_SCE_RNG_Read(out) == FSP_SUCCESS) {
             result = TRNG_OK;
         }
+        _reading = 0U;
     }
 
     return result;
@@ -161,12 +288,196 @@ uint8_t trng_randomRange(uint32_t *out, uint32_t min, uint32_t max) {
     return result;
 }
 
+/**
+ * @brief  Write a uniform random value in [0, bound) into @p out.
+ * @param[out] out    Pointer to a uint32_t.
+ * @param      bound  Exclusive upper bound, 0 for the full 32-bit range.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ * @note   Draws only the bits needed for @p bound from the bit reservoir
+ *         and redraws values >= bound, so the result is unbiased and the
+ *         SCE5 is read once per 128 bits consumed (less than two draws
+ *         on average).
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_randomBounded(uint32_t *out, uint32_t bound) {
+    uint8_t result = TRNG_NOK;
+
+    if (out != NULL) {
+        uint32_t top = bound - 1U;
+        uint8_t n = 0U;
+        uint32_t val = 0U;
+
+        while ((n < 32U) && ((top >> n) != 0U)) {
+            n++;
+        }
+        if (n == 0U) {
+            /* bound == 1: the only value needs no random bits. */
+            result = TRNG_OK;
+        } else {
+            result = trng_poolBits(&val, n);
+            while ((result == TRNG_OK) && (val > top)) {
+                result = trng_poolBits(&val, n);
+            }
+        }
+        if (result == TRNG_OK) {
+            *out = val;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Draw a uniform integer in [1, modulus) whose most significant
+ *         nonzero word is @p top and has @p k significant bits.
+ *
+ * The words below @p top are read once, in whole hardware blocks. The top
+ * word takes @p k bits from the reservoir and alone is redrawn while it
+ * exceeds the modulus' top word. Only when it equals it and the lower
+ * words are not below the modulus (probability below 2^-(k-1)), or the
+ * result is 0, is everything drawn again; that keeps the result exactly
+ * uniform.
+ */
+static uint8_t trng_randomBelowTop(uint32_t *out, const uint32_t *modulus, size_t top, uint8_t k) {
+    uint8_t result = TRNG_OK;
+    uint8_t done = 0U;
+
+    while ((result == TRNG_OK) && (done == 0U)) {
+        uint32_t t = 0U;
+        size_t i = 0U;
+
+        while ((result == TRNG_OK) && ((top - i) >= 4U)) {
+            result = trng_read128(&out[i]);
+            i += 4U;
+        }
+        while ((result == TRNG_OK) && (i < top)) {
+            result = trng_poolWord(&out[i]);
+            i++;
+        }
+        do {
+            if (result == TRNG_OK) {
+                result = trng_poolBits(&t, k);
+            }
+        } while ((result == TRNG_OK) && (t > modulus[top]));
+
+        if (result == TRNG_OK) {
+            uint8_t below = (t < modulus[top]) ? 1U : 0U;
+            uint32_t any = t;
+            out[top] = t;
+            i = top;
+            /* Equal top words: compare the lower words, most significant first. */
+            while ((below == 0U) && (i > 0U) && (t == modulus[top])) {
+                i--;
+                if (out[i] != modulus[i]) {
+                    below = (out[i] < modulus[i]) ? 1U : 0U;
+                    i = 0U;
+                }
+            }
+            for (i = 0U; (any == 0U) && (i < top); i++) {
+                any = out[i];
+            }
+            done = ((below != 0U) && (any != 0U)) ? 1U : 0U;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Write a uniform multi-precision integer in [1, modulus).
+ * @param[out] out      @p nwords words, least significant first.
+ * @param      modulus  @p nwords words, least significant first; at least 2.
+ * @param      nwords   Number of words.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, null pointer or modulus
+ *                   below 2; @p out is zeroed.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_randomBelow(uint32_t *out, const uint32_t *modulus, size_t nwords) {
+    uint8_t result = TRNG_NOK;
+
+    if ((out != NULL) && (modulus != NULL) && (nwords != 0U)) {
+        size_t top = nwords - 1U;
+        size_t i;
+        uint8_t k = 0U;
+
+        while ((top > 0U) && (modulus[top] == 0U)) {
+            top--;
+        }
+        while ((k < 32U) && ((modulus[top] >> k) != 0U)) {
+            k++;
+        }
+        for (i = top + 1U; i < nwords; i++) {
+            out[i] = 0U;
+        }
+        if ((top > 0U) || (modulus[0U] >= 2U)) {
+            result = trng_randomBelowTop(out, modulus, top, k);
+        }
+        if (result != TRNG_OK) {
+            for (i = 0U; i < nwords; i++) {
+                out[i] = 0U;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Write a uniform P-256 scalar in [1, n).
+ * @param[out] out  TRNG_SCALAR_WORDS words, least significant first.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or null pointer; @p out is zeroed.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_randomScalarP256(uint32_t *out) {
+    uint8_t result = TRNG_NOK;
+
+    if (out != NULL) {
+        /* Full 32-bit top word: a redraw is needed with probability 2^-32. */
+        result = trng_randomBelowTop(out, trng_orderP256, TRNG_SCALAR_WORDS - 1U, 32U);
+        if (result != TRNG_OK) {
+            size_t i;
+            for (i = 0U; i < TRNG_SCALAR_WORDS; i++) {
+                out[i] = 0U;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Write a uniform Curve25519 scalar in [1, l).
+ * @param[out] out  TRNG_SCALAR_WORDS words, least significant first.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or null pointer; @p out is zeroed.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_randomScalarCurve25519(uint32_t *out) {
+    uint8_t result = TRNG_NOK;
+
+    if (out != NULL) {
+        /* 29-bit top word 0x10000000: about one top-word redraw in two, lower words kept. */
+        result = trng_randomBelowTop(out, trng_orderCurve25519, TRNG_SCALAR_WORDS - 1U, 29U);
+        if (result != TRNG_OK) {
+            size_t i;
+            for (i = 0U; i < TRNG_SCALAR_WORDS; i++) {
+                out[i] = 0U;
+            }
+        }
+    }
+
+    return result;
+}
+
 /**
  * @brief  Fill a buffer with random bytes.
  * @param[out] buf  Destination buffer.
  * @param      len  Number of bytes to fill.
  * @retval TRNG_OK   Success.
- * @retval TRNG_NOK  Read failed or not initialized.
+ * @retval TRNG_NOK  Read failed, not initialized, or a read in progress.
  */
 // cppcheck-suppress unusedFunction
 uint8_t trng_fillRandom(uint8_t *buf, size_t len) {
@@ -178,9 +489,8 @@ uint8_t trng_fillRandom(uint8_t *buf, size_t len) {
         result = TRNG_OK;
 
         while ((i < len) && (result == TRNG_OK)) {
-            if (HW_SCE_RNG_Read(tmp) != FSP_SUCCESS) {
-                result = TRNG_NOK;
-            } else {
+            result = trng_read128(tmp);
+            if (result == TRNG_OK) {
                 const uint8_t *src = (const uint8_t *)tmp;
                 size_t chunk = ((len - i) < 16U) ? (len - i) : 16U;
                 size_t j;
@@ -194,3 +504,573 @@ uint8_t trng_fillRandom(uint8_t *buf, size_t len) {
 
     return result;
 }
+
+/**
+ * @brief  XOR random bytes into a buffer in one pass: whole hardware
+ *         blocks a word at a time, then the tail from the bit reservoir.
+ * @param[in,out] buf  Buffer to mask.
+ * @param         len  Number of bytes.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_xorRandom(uint8_t *buf, size_t len) {
+    uint8_t result = TRNG_NOK;
+
+    if ((_initialized != 0U) && (buf != NULL)) {
+        size_t i = 0U;
+        result = TRNG_OK;
+
+        while (((len - i) >= 16U) && (result == TRNG_OK)) {
+            uint32_t tmp[4U];
+            result = trng_read128(tmp);
+            if (result == TRNG_OK) {
+                uint8_t k;
+                for (k = 0U; k < 4U; k++) {
+                    uint32_t w;
+                    /* memcpy() compiles to a single, possibly unaligned, load and store. */
+                    (void)memcpy(&w, &buf[i], 4U);
+                    w ^= tmp[k];
+                    (void)memcpy(&buf[i], &w, 4U);
+                    i += 4U;
+                }
+            }
+        }
+        while ((i < len) && (result == TRNG_OK)) {
+            size_t chunk = ((len - i) < 4U) ? (len - i) : 4U;
+            uint32_t v;
+            result = trng_poolBits(&v, (uint8_t)(chunk * 8U));
+            if (result == TRNG_OK) {
+                size_t j;
+                for (j = 0U; j < chunk; j++) {
+                    buf[i] ^= (uint8_t)(v & 0xFFU);
+                    v >>= 8U;
+                    i++;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Fill the segments of @p iov as one stream: whole hardware blocks
+ *         run across segment boundaries, the last partial block comes from
+ *         the bit reservoir.
+ * @param  iov    Segments.
+ * @param  count  Number of segments.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_fillRandomV(const trng_iovec *iov, size_t count) {
+    uint8_t result = TRNG_NOK;
+
+    if ((_initialized != 0U) && ((iov != NULL) || (count == 0U))) {
+        size_t remaining = 0U;
+        size_t s;
+        result = TRNG_OK;
+
+        for (s = 0U; s < count; s++) {
+            if ((iov[s].base == NULL) && (iov[s].len != 0U)) {
+                result = TRNG_NOK;
+            }
+            remaining += iov[s].len;
+        }
+
+        if (result == TRNG_OK) {
+            uint32_t tmp[4U];
+            const uint8_t *src = (const uint8_t *)tmp;
+            size_t avail = 0U;
+
+            for (s = 0U; (s < count) && (result == TRNG_OK); s++) {
+                uint8_t *dst = (uint8_t *)iov[s].base;
+                size_t i = 0U;
+
+                while ((i < iov[s].len) && (result == TRNG_OK)) {
+                    if (avail == 0U) {
+                        if (remaining >= 16U) {
+                            result = trng_read128(tmp);
+                            avail = 16U;
+                        } else {
+                            /* Tail: the rest of the segment from the reservoir. */
+                            result = trng_poolBytes(&dst[i], iov[s].len - i);
+                            remaining -= iov[s].len - i;
+                            i = iov[s].len;
+                        }
+                    } else {
+                        dst[i] = src[16U - avail];
+                        avail--;
+                        remaining--;
+                        i++;
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Number of whole bytes the pool and bit reservoir can serve
+ *         without reading the SCE5.
+ */
+static size_t trng_poolAvailable(void) {
+    size_t bits = _bitCount;
+
+    if (_poolPos < 4U) {
+        bits += 32U * (size_t)(4U - _poolPos);
+    }
+
+    return bits / 8U;
+}
+
+/**
+ * @brief  getrandom()-style fill: buffered bytes first, then whole
+ *         hardware blocks, then the tail from the pool.
+ * @param[out] buf    Destination buffer.
+ * @param      len    Number of bytes requested.
+ * @param      flags  TRNG_GRND_* flags.
+ * @return Number of bytes written (possibly fewer than @p len), or
+ *         TRNG_EINVAL, TRNG_EAGAIN or TRNG_EIO.
+ */
+// cppcheck-suppress unusedFunction
+int32_t trng_getrandom(void *buf, size_t len, uint32_t flags) {
+    int32_t result;
+    uint8_t *dst = (uint8_t *)buf;
+    size_t want = (len > (size_t)INT32_MAX) ? (size_t)INT32_MAX : len;
+    size_t done = 0U;
+
+    if (((buf == NULL) && (len != 0U)) || ((flags & ~TRNG_GRND_FLAGS) != 0U)) {
+        result = TRNG_EINVAL;
+    } else {
+        size_t buffered = trng_poolAvailable();
+        size_t n = (buffered < want) ? buffered : want;
+        uint8_t ok = 1U;
+
+        /* Cannot fail: every bit it takes is already buffered. */
+        (void)trng_poolBytes(dst, n);
+        done = n;
+
+        if ((flags & TRNG_GRND_NONBLOCK) == 0U) {
+            while ((ok != 0U) && ((want - done) >= 16U)) {
+                uint32_t tmp[4U];
+                if (trng_read128(tmp) == TRNG_OK) {
+                    const uint8_t *src = (const uint8_t *)tmp;
+                    size_t j;
+                    for (j = 0U; j < 16U; j++) {
+                        dst[done] = src[j];
+                        done++;
+                    }
+                } else {
+                    ok = 0U;
+                }
+            }
+            /* The rest of the last block stays buffered for later calls. */
+            if ((ok != 0U) && (done < want) && (trng_poolBytes(&dst[done], want - done) == TRNG_OK)) {
+                done = want;
+            }
+        }
+
+        if ((done != 0U) || (want == 0U)) {
+            result = (int32_t)done;
+        } else if ((flags & TRNG_GRND_NONBLOCK) != 0U) {
+            result = TRNG_EAGAIN;
+        } else {
+            result = TRNG_EIO;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Fill a bitmap with independent Bernoulli(p) bits.
+ * @param[out] out    Destination words.
+ * @param      words  Number of 32-bit words to fill.
+ * @param      p      Probability of a set bit, in units of 2^-32.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ * @note   Each of the 32 lanes compares its own uniform fraction U against
+ *         p, one binary digit per random word, most significant first.
+ *         A lane is decided at the first digit where U and p differ, so a
+ *         word costs about log2(32) + 2 random words whatever the value of p.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_fillBernoulli(uint32_t *out, size_t words, uint32_t p) {
+    uint8_t result = TRNG_NOK;
+
+    if ((_initialized != 0U) && (out != NULL)) {
+        /* Digits of p below its lowest set bit are zero: an undecided lane
+         * at that point has U >= p, so the comparison can stop there. */
+        uint32_t lowest = p & (~p + 1U);
+        size_t i = 0U;
+        result = TRNG_OK;
+
+        while ((i < words) && (result == TRNG_OK)) {
+            uint32_t set = 0U;
+            uint32_t open = 0xFFFFFFFFU;
+            uint32_t bit = 0x80000000U;
+
+            while ((lowest != 0U) && (bit >= lowest) && (open != 0U) &&
+                   (result == TRNG_OK)) {
+                uint32_t r;
+                result = trng_poolWord(&r);
+                if (result == TRNG_OK) {
+                    if ((p & bit) != 0U) {
+                        /* Digit of p is 1: lanes drawing 0 have U < p. */
+                        set |= open & ~r;
+                        open &= r;
+                    } else {
+                        /* Digit of p is 0: lanes drawing 1 have U > p. */
+                        open &= ~r;
+                    }
+                    bit >>= 1U;
+                }
+            }
+
+            if (result == TRNG_OK) {
+                out[i] = set;
+                i++;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Generate @p count version 4 (random) UUIDs.
+ * @param[out] out    Destination, 16 bytes per UUID.
+ * @param      count  Number of UUIDs.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ * @note   Takes exactly 122 bits per UUID from the reservoir: the version
+ *         and variant bits are constants, not overwritten random bits.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_uuid4(uint8_t *out, size_t count) {
+    uint8_t result = TRNG_NOK;
+
+    if ((_initialized != 0U) && (out != NULL)) {
+        size_t i = 0U;
+        result = TRNG_OK;
+
+        while ((i < count) && (result == TRNG_OK)) {
+            uint8_t *u = &out[i * TRNG_UUID_SIZE];
+            uint32_t v = 0U;
+            uint32_t var = 0U;
+
+            result = trng_poolBytes(u, 6U);
+            if (result == TRNG_OK) {
+                result = trng_poolBits(&v, 12U);
+            }
+            if (result == TRNG_OK) {
+                result = trng_poolBits(&var, 6U);
+            }
+            if (result == TRNG_OK) {
+                result = trng_poolBytes(&u[9U], 7U);
+            }
+            if (result == TRNG_OK) {
+                u[6U] = (uint8_t)(0x40U | (v >> 8U));
+                u[7U] = (uint8_t)(v & 0xFFU);
+                u[8U] = (uint8_t)(0x80U | var);
+                i++;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Generate @p count version 7 (time-ordered) UUIDs.
+ * @param[out] out     Destination, 16 bytes per UUID.
+ * @param      count   Number of UUIDs.
+ * @param      unixMs  Unix timestamp in milliseconds (low 48 bits are used).
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ * @note   Takes exactly 74 bits per UUID from the reservoir.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_uuid7(uint8_t *out, size_t count, uint64_t unixMs) {
+    uint8_t result = TRNG_NOK;
+
+    if ((_initialized != 0U) && (out != NULL)) {
+        size_t i = 0U;
+        result = TRNG_OK;
+
+        while ((i < count) && (result == TRNG_OK)) {
+            uint8_t *u = &out[i * TRNG_UUID_SIZE];
+            uint32_t randA = 0U;
+            uint32_t var = 0U;
+
+            result = trng_poolBits(&randA, 12U);
+            if (result == TRNG_OK) {
+                result = trng_poolBits(&var, 6U);
+            }
+            if (result == TRNG_OK) {
+                result = trng_poolBytes(&u[9U], 7U);
+            }
+            if (result == TRNG_OK) {
+                size_t j;
+                for (j = 0U; j < 6U; j++) {
+                    u[j] = (uint8_t)((unixMs >> (40U - (8U * j))) & 0xFFU);
+                }
+                u[6U] = (uint8_t)(0x70U | (randA >> 8U));
+                u[7U] = (uint8_t)(randA & 0xFFU);
+                u[8U] = (uint8_t)(0x80U | var);
+                i++;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Format binary UUIDs in canonical 8-4-4-4-12 text form.
+ * @param[out] out    Destination, TRNG_UUID_STR_SIZE chars per UUID.
+ * @param      uuids  Source UUIDs, 16 bytes each.
+ * @param      count  Number of UUIDs.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_uuidToString(char *out, const uint8_t *uuids, size_t count) {
+    uint8_t result = TRNG_NOK;
+
+    if ((out != NULL) && (uuids != NULL)) {
+        size_t i;
+        for (i = 0U; i < count; i++) {
+            const uint8_t *u = &uuids[i * TRNG_UUID_SIZE];
+            char *s = &out[i * TRNG_UUID_STR_SIZE];
+            size_t j;
+            size_t k = 0U;
+            for (j = 0U; j < TRNG_UUID_SIZE; j++) {
+                if ((j == 4U) || (j == 6U) || (j == 8U) || (j == 10U)) {
+                    s[k] = '-';
+                    k++;
+                }
+                s[k] = _hexLower[u[j] >> 4U];
+                s[k + 1U] = _hexLower[u[j] & 0x0FU];
+                k += 2U;
+            }
+            s[k] = '\0';
+        }
+        result = TRNG_OK;
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Fill @p out with @p len characters drawn uniformly from an alphabet.
+ * @param[out] out          Destination, at least len + 1 chars (NUL-terminated).
+ * @param      len          Number of characters to generate.
+ * @param      alphabet     Symbols to draw from.
+ * @param      alphabetLen  Number of symbols (>= 1).
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or invalid argument.
+ * @note   Power-of-two alphabets take log2(alphabetLen) bits per character
+ *         from the reservoir. Other sizes pack k characters into one word:
+ *         a word is accepted if it lies below the largest multiple of
+ *         alphabetLen^k, then split into k base-alphabetLen digits.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_randomString(char *out, size_t len, const char *alphabet, size_t alphabetLen) {
+    uint8_t result = TRNG_NOK;
+
+    if ((_initialized != 0U) && (out != NULL) && (alphabet != NULL) && (alphabetLen != 0U)) {
+        uint32_t m = (uint32_t)alphabetLen;
+        size_t i = 0U;
+        result = TRNG_OK;
+
+        if ((m & (m - 1U)) == 0U) {
+            /* Fast path: no rejection, exactly log2(m) bits per character. */
+            uint8_t bits = 0U;
+            while ((1UL << bits) < m) {
+                bits++;
+            }
+            while ((i < len) && (result == TRNG_OK)) {
+                uint32_t v = 0U;
+                if (bits != 0U) {
+                    result = trng_poolBits(&v, bits);
+                }
+                if (result == TRNG_OK) {
+                    out[i] = alphabet[v];
+                    i++;
+                }
+            }
+        } else {
+            /* k = characters per word, span = m^k <= 2^32. */
+            uint64_t span = m;
+            uint32_t k = 1U;
+            while ((span * m) <= 0x100000000ULL) {
+                span *= m;
+                k++;
+            }
+            uint32_t limit = (uint32_t)((0x100000000ULL / span) * span);
+
+            while ((i < len) && (result == TRNG_OK)) {
+                uint32_t w;
+                result = trng_poolWord(&w);
+                if ((result == TRNG_OK) && (w < limit)) {
+                    uint32_t j;
+                    for (j = 0U; (j < k) && (i < len); j++) {
+                        out[i] = alphabet[w % m];
+                        w /= m;
+                        i++;
+                    }
+                }
+            }
+        }
+
+        if (result == TRNG_OK) {
+            out[len] = '\0';
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Generate @p nBytes random bytes and write them as uppercase hex.
+ * @param[out] out     Destination, at least TRNG_HEX_LEN(nBytes) chars.
+ * @param      nBytes  Number of random bytes to encode.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_fillHex(char *out, size_t nBytes) {
+    uint8_t result = TRNG_NOK;
+
+    if ((_initialized != 0U) && (out != NULL)) {
+        size_t i = 0U;
+        size_t k = 0U;
+        result = TRNG_OK;
+
+        while ((i < nBytes) && (result == TRNG_OK)) {
+            uint32_t w;
+            result = trng_poolWord(&w);
+            if (result == TRNG_OK) {
+                size_t j;
+                for (j = 0U; (j < 4U) && (i < nBytes); j++) {
+                    out[k] = _hexUpper[(w >> 4U) & 0x0FU];
+                    out[k + 1U] = _hexUpper[w & 0x0FU];
+                    w >>= 8U;
+                    k += 2U;
+                    i++;
+                }
+            }
+        }
+
+        if (result == TRNG_OK) {
+            out[k] = '\0';
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Generate @p nBytes random bytes and write them as padded base64.
+ * @param[out] out     Destination, at least TRNG_BASE64_LEN(nBytes) chars.
+ * @param      nBytes  Number of random bytes to encode.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ * @note   Each 3-byte group is drawn as 24 bits from the reservoir and
+ *         split into four 6-bit table indices.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_fillBase64(char *out, size_t nBytes) {
+    uint8_t result = TRNG_NOK;
+
+    if ((_initialized != 0U) && (out != NULL)) {
+        size_t i = 0U;
+        size_t k = 0U;
+        result = TRNG_OK;
+
+        while (((nBytes - i) >= 3U) && (result == TRNG_OK)) {
+            uint32_t v;
+            result = trng_poolBits(&v, 24U);
+            if (result == TRNG_OK) {
+                out[k] = _base64[v >> 18U];
+                out[k + 1U] = _base64[(v >> 12U) & 0x3FU];
+                out[k + 2U] = _base64[(v >> 6U) & 0x3FU];
+                out[k + 3U] = _base64[v & 0x3FU];
+                k += 4U;
+                i += 3U;
+            }
+        }
+
+        if ((result == TRNG_OK) && (i < nBytes)) {
+            /* One or two trailing bytes: 2 or 3 symbols, then padding. */
+            uint32_t v;
+            uint8_t tail = (uint8_t)(nBytes - i);
+            result = trng_poolBits(&v, (uint8_t)(tail * 8U));
+            if (result == TRNG_OK) {
+                v <<= (3U - tail) * 8U;
+                out[k] = _base64[v >> 18U];
+                out[k + 1U] = _base64[(v >> 12U) & 0x3FU];
+                out[k + 2U] = (tail == 2U) ? _base64[(v >> 6U) & 0x3FU] : '=';
+                out[k + 3U] = '=';
+                k += 4U;
+            }
+        }
+
+        if (result == TRNG_OK) {
+            out[k] = '\0';
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Copy the 128-bit MCU unique ID into @p out.
+ * @param[out] out  Destination, 16 bytes.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_deviceId(uint8_t *out) {
+    uint8_t result = TRNG_NOK;
+
+    if (out != NULL) {
+        const bsp_unique_id_t *id = R_BSP_UniqueIdGet();
+        size_t i;
+        for (i = 0U; i < 16U; i++) {
+            out[i] = id->unique_id_bytes[i];
+        }
+        result = TRNG_OK;
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Key a Philox4x32-10 generator from one hardware block.
+ * @param[out] p  Generator parameters.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_philoxSeed(trng_philox *p) {
+    uint8_t result = TRNG_NOK;
+
+    if (p != NULL) {
+        uint32_t buf[4U];
+        if (trng_read128(buf) == TRNG_OK) {
+            p->key[0U] = buf[0U];
+            p->key[1U] = buf[1U];
+            p->stream[0U] = buf[2U];
+            p->stream[1U] = buf[3U];
+            result = TRNG_OK;
+        }
+    }
+
+    return result;
+}
@@ -16,12 +16,65 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "trng_frame.h"
+#include "trng_philox.h"
 
 /** @brief Success return code. */
 #define TRNG_OK     0U
 /** @brief Failure return code. */
 #define TRNG_NOK    1U
 
+/**
+ * @brief   Convert a probability in [0, 1) to the fixed-point form used by
+ *          trng_fillBernoulli() (units of 2^-32).
+ */
+#define TRNG_PROBABILITY(x)    ((uint32_t)((x) * 4294967296.0))
+
+/** @brief Size of a binary UUID in bytes. */
+#define TRNG_UUID_SIZE      16U
+/** @brief Size of a canonical UUID string, including the terminating NUL. */
+#define TRNG_UUID_STR_SIZE  37U
+
+/** @brief Buffer size for trng_fillHex() of @p n bytes, including the NUL. */
+#define TRNG_HEX_LEN(n)     ((2U * (n)) + 1U)
+/** @brief Buffer size for trng_fillBase64() of @p n bytes, including the NUL. */
+#define TRNG_BASE64_LEN(n)  ((4U * (((n) + 2U) / 3U)) + 1U)
+
+/** @brief trng_getrandom(): return only bytes that are already buffered. */
+#define TRNG_GRND_NONBLOCK  0x0001U
+/** @brief trng_getrandom(): accepted for compatibility, no effect. */
+#define TRNG_GRND_RANDOM    0x0002U
+/** @brief trng_getrandom(): accepted for compatibility, no effect. */
+#define TRNG_GRND_INSECURE  0x0004U
+/** @brief All flags accepted by trng_getrandom(). */
+#define TRNG_GRND_FLAGS     (TRNG_GRND_NONBLOCK | TRNG_GRND_RANDOM | TRNG_GRND_INSECURE)
+
+/** @brief trng_getrandom(): hardware failure or not initialized, nothing written. */
+#define TRNG_EIO            (-5)
+/** @brief trng_getrandom(): TRNG_GRND_NONBLOCK and nothing buffered. */
+#define TRNG_EAGAIN         (-11)
+/** @brief trng_getrandom(): null buffer or unknown flag. */
+#define TRNG_EINVAL         (-22)
+
+/** @brief One segment of a trng_fillRandomV() request. */
+typedef struct {
+    void  *base;    /**< Start of the segment. */
+    size_t len;     /**< Length in bytes. */
+} trng_iovec;
+
+/** @brief Words in a 256-bit scalar of trng_randomScalarP256() / trng_randomScalarCurve25519(). */
+#define TRNG_SCALAR_WORDS   8U
+
+#ifndef TRNG_FRAME_PAYLOAD
+/** @brief Payload size in bytes of frames sent by trngClass::writeFrames(). */
+#define TRNG_FRAME_PAYLOAD  256U
+#endif
+
+#ifndef TRNG_WRITE_CHUNK
+/** @brief Chunk size in bytes used by trngClass::writeTo() (multiple of 16). */
+#define TRNG_WRITE_CHUNK    64U
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -40,10 +93,14 @@ uint8_t trng_begin(void);
 /**
  * @brief   Read 128 bits (4 x 32-bit words) of true random data.
  *
+ * A call from an interrupt that preempted another trng_read128() fails
+ * at once instead of re-entering the SCE5 read sequence; the preempted
+ * read completes normally.
+ *
  * @param[out] out  Pointer to an array of at least 4 uint32_t.
  *
  * @retval  0   Success.
- * @retval  1   Read failed or not initialized.
+ * @retval  1   Read failed, not initialized, or another read in progress.
  */
 uint8_t trng_read128(uint32_t *out);
 
@@ -90,17 +147,283 @@ uint8_t trng_random8(uint8_t *out);
  */
 uint8_t trng_randomRange(uint32_t *out, uint32_t min, uint32_t max);
 
+/**
+ * @brief   Generate a uniform random number in [0, bound) from the
+ *          buffered bit reservoir.
+ *
+ * Unlike trng_randomRange(), which reads a full hardware block per draw,
+ * this takes only ceil(log2(bound)) bits per attempt from the shared
+ * reservoir, so one SCE5 read serves many calls. Out-of-range values are
+ * redrawn, which keeps the result free of modulo bias.
+ *
+ * @param[out] out    Pointer to a uint32_t.
+ * @param      bound  Exclusive upper bound, 0 for the full 32-bit range.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or null pointer.
+ */
+uint8_t trng_randomBounded(uint32_t *out, uint32_t bound);
+
+/**
+ * @brief   Uniform multi-precision integer in [1, @p modulus), e.g. an ECC
+ *          private key or an RSA blinding value.
+ *
+ * Integers are arrays of 32-bit words, least significant word first.
+ * Only the bits the modulus needs are drawn: the words below its most
+ * significant nonzero word are read once in whole hardware blocks, and
+ * only that top word, of just its significant bits, is redrawn while it
+ * exceeds the modulus' top word. The lower words are drawn again only in
+ * the rare case where the top words are equal and the lower words are not
+ * below the modulus (or the result is 0), so the result is exactly
+ * uniform. A fill-and-compare loop instead rereads every byte on each
+ * rejection.
+ *
+ * @param[out] out      @p nwords words. Words above the modulus' top word
+ *                      are set to 0.
+ * @param      modulus  @p nwords words, at least 2.
+ * @param      nwords   Number of words.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, null pointer or modulus
+ *              below 2; @p out is zeroed.
+ */
+uint8_t trng_randomBelow(uint32_t *out, const uint32_t *modulus, size_t nwords);
+
+/**
+ * @brief   Uniform NIST P-256 private scalar in [1, n): trng_randomBelow()
+ *          on trng_orderP256, without scanning the modulus.
+ *
+ * @param[out] out  TRNG_SCALAR_WORDS words, least significant first
+ *                  (reverse the words and bytes for a big-endian key).
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or null pointer; @p out
+ *              (if not null) is zeroed, so no partly drawn key remains.
+ */
+uint8_t trng_randomScalarP256(uint32_t *out);
+
+/**
+ * @brief   Uniform scalar in [1, l) for the prime-order subgroup of
+ *          Curve25519 / Ed25519 (l = 2^252 + 2774...8493).
+ *
+ * @param[out] out  TRNG_SCALAR_WORDS words, least significant first (the
+ *                  little-endian byte order of Ed25519 on this MCU).
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or null pointer; @p out
+ *              (if not null) is zeroed, so no partly drawn key remains.
+ */
+uint8_t trng_randomScalarCurve25519(uint32_t *out);
+
+/** @brief Order n of the NIST P-256 group, least significant word first. */
+extern const uint32_t trng_orderP256[TRNG_SCALAR_WORDS];
+
+/** @brief Order l of the Curve25519 prime-order subgroup, least significant word first. */
+extern const uint32_t trng_orderCurve25519[TRNG_SCALAR_WORDS];
+
 /**
  * @brief   Fill a buffer with true random bytes.
  *
  * @param[out] buf   Pointer to the output buffer.
  * @param      len   Number of bytes to fill.
  *
+ * Reads through trng_read128(), so it fails rather than re-enter the
+ * hardware read when it preempts another read.
+ *
  * @retval  0   Success.
- * @retval  1   Read failed or not initialized.
+ * @retval  1   Read failed, not initialized, or a read in progress.
  */
 uint8_t trng_fillRandom(uint8_t *buf, size_t len);
 
+/**
+ * @brief   XOR true random bytes into a buffer in place.
+ *
+ * Masks @p buf in a single pass, without a temporary buffer and a second
+ * XOR loop: each hardware block is combined with the buffer a 32-bit word
+ * at a time, and the last partial block comes from the bit reservoir. The
+ * buffer needs no particular alignment.
+ *
+ * @param[in,out] buf  Buffer to mask.
+ * @param         len  Number of bytes.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or null pointer. The buffer
+ *              may be partly masked.
+ */
+uint8_t trng_xorRandom(uint8_t *buf, size_t len);
+
+/**
+ * @brief   Fill several buffers with true random bytes in one call.
+ *
+ * The segments are filled in order as one continuous stream, so a hardware
+ * block that ends part-way through a segment carries on into the next one.
+ * Calling trng_fillRandom() once per segment instead wastes the unused end
+ * of each segment's last block: filling a 12-byte nonce, a 16-byte IV and
+ * 4 bytes of padding takes 4 reads that way and 2 reads here.
+ *
+ * The last partial block is taken from the bit reservoir. Its remaining
+ * bits stay buffered for later calls rather than being discarded.
+ *
+ * @param      iov    Array of @p count segments. Segments of length 0 may
+ *                    have a null base.
+ * @param      count  Number of segments.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or null pointer. The
+ *              segments may be partly filled.
+ */
+uint8_t trng_fillRandomV(const trng_iovec *iov, size_t count);
+
+/**
+ * @brief   Fill a buffer like Linux getrandom(2).
+ *
+ * Bytes left in the pool and bit reservoir of the word-level functions are
+ * served first, then whole 128-bit hardware blocks, then the tail from a
+ * new pooled block whose remainder stays buffered. With
+ * TRNG_GRND_NONBLOCK only the buffered bytes (at most 15) are returned and
+ * the SCE5 is never waited on. TRNG_GRND_RANDOM and TRNG_GRND_INSECURE are
+ * accepted and ignored, as there is a single source.
+ *
+ * As with getrandom(), the result may be shorter than @p len: if the
+ * hardware fails after some bytes were written, or with
+ * TRNG_GRND_NONBLOCK. Requests above INT32_MAX are capped.
+ *
+ * @param[out] buf    Destination buffer.
+ * @param      len    Number of bytes requested.
+ * @param      flags  0 or a combination of TRNG_GRND_* flags.
+ *
+ * @return  Number of bytes written (0 only if @p len is 0), or
+ * @retval  TRNG_EINVAL  Null buffer or unknown flag.
+ * @retval  TRNG_EAGAIN  TRNG_GRND_NONBLOCK and nothing buffered.
+ * @retval  TRNG_EIO     Read failed or not initialized, nothing written.
+ */
+int32_t trng_getrandom(void *buf, size_t len, uint32_t flags);
+
+/**
+ * @brief   Fill a bitmap where each bit is set independently with
+ *          probability p.
+ *
+ * @param[out] out    Pointer to the output words.
+ * @param      words  Number of 32-bit words to fill.
+ * @param      p      Probability of a set bit in units of 2^-32,
+ *                    see TRNG_PROBABILITY().
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed or not initialized.
+ * @note    Uses bit-sliced comparison against the binary expansion of p:
+ *          each output word costs a handful of random words, not 32 draws.
+ */
+uint8_t trng_fillBernoulli(uint32_t *out, size_t words, uint32_t p);
+
+/**
+ * @brief   Generate RFC 9562 version 4 (random) UUIDs.
+ *
+ * @param[out] out    Pointer to at least count * TRNG_UUID_SIZE bytes.
+ * @param      count  Number of UUIDs to generate.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed or not initialized.
+ * @note    Each UUID consumes exactly its 122 random bits from buffered
+ *          hardware blocks; no random bits are discarded.
+ */
+uint8_t trng_uuid4(uint8_t *out, size_t count);
+
+/**
+ * @brief   Generate RFC 9562 version 7 (Unix time-ordered) UUIDs.
+ *
+ * @param[out] out     Pointer to at least count * TRNG_UUID_SIZE bytes.
+ * @param      count   Number of UUIDs to generate.
+ * @param      unixMs  Milliseconds since the Unix epoch, shared by all
+ *                     UUIDs in the batch.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed or not initialized.
+ * @note    Each UUID consumes exactly its 74 random bits.
+ */
+uint8_t trng_uuid7(uint8_t *out, size_t count, uint64_t unixMs);
+
+/**
+ * @brief   Format UUIDs as canonical lowercase text
+ *          ("xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx").
+ *
+ * @param[out] out    Pointer to at least count * TRNG_UUID_STR_SIZE chars.
+ *                    Each string is NUL-terminated.
+ * @param      uuids  Pointer to count binary UUIDs.
+ * @param      count  Number of UUIDs to format.
+ *
+ * @retval  0   Success.
+ * @retval  1   Null pointer.
+ */
+uint8_t trng_uuidToString(char *out, const uint8_t *uuids, size_t count);
+
+/**
+ * @brief   Generate a random string over an arbitrary alphabet, such as a
+ *          token or password.
+ *
+ * @param[out] out          Pointer to at least len + 1 chars. The string is
+ *                          NUL-terminated.
+ * @param      len          Number of characters to generate.
+ * @param      alphabet     Symbols to draw from (e.g. base32, base62).
+ * @param      alphabetLen  Number of symbols in @p alphabet (>= 1).
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or invalid argument.
+ * @note    Every symbol is equally likely. Power-of-two alphabets (hex,
+ *          base64url) need no rejection; other sizes pack several
+ *          characters per random word with rejection sampling.
+ */
+uint8_t trng_randomString(char *out, size_t len, const char *alphabet, size_t alphabetLen);
+
+/**
+ * @brief   Generate random bytes and write them as an uppercase hex string.
+ *
+ * @param[out] out     Pointer to at least TRNG_HEX_LEN(nBytes) chars. The
+ *                     string is NUL-terminated.
+ * @param      nBytes  Number of random bytes to encode.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed or not initialized.
+ * @note    Encodes through a lookup table in the same pass as generation,
+ *          with no intermediate byte buffer.
+ */
+uint8_t trng_fillHex(char *out, size_t nBytes);
+
+/**
+ * @brief   Generate random bytes and write them as a padded base64 string.
+ *
+ * @param[out] out     Pointer to at least TRNG_BASE64_LEN(nBytes) chars. The
+ *                     string is NUL-terminated.
+ * @param      nBytes  Number of random bytes to encode.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed or not initialized.
+ */
+uint8_t trng_fillBase64(char *out, size_t nBytes);
+
+/**
+ * @brief   Read the 128-bit unique ID of the MCU.
+ *
+ * @param[out] out  Pointer to at least 16 bytes.
+ *
+ * @retval  0   Success.
+ * @retval  1   Null pointer.
+ */
+uint8_t trng_deviceId(uint8_t *out);
+
+/**
+ * @brief   Key a Philox4x32-10 generator (see trng_philox.h) from the TRNG.
+ *
+ * One 128-bit hardware block supplies the 64-bit key and the 64-bit
+ * stream selector. Copy the result to every thread or board that must
+ * produce the same streams.
+ *
+ * @param[out] p  Generator parameters.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or null pointer.
+ */
+uint8_t trng_philoxSeed(trng_philox *p);
+
 #ifdef __cplusplus
 }
 #endif
@@ -138,8 +461,199 @@ public:
     /** @brief Write a random value in [min, max] into @p out. */
     bool randomRange(uint32_t *out, uint32_t min, uint32_t max)
                                                     { return trng_randomRange(out, min, max) == TRNG_OK; }
+    /** @brief Write a random value in [0, bound) into @p out, from the bit reservoir. */
+    bool randomBounded(uint32_t *out, uint32_t bound)
+                                                    { return trng_randomBounded(out, bound) == TRNG_OK; }
+    /** @brief Write a uniform integer in [1, modulus) of @p nwords words, least significant first. */
+    bool randomBelow(uint32_t *out, const uint32_t *modulus, size_t nwords)
+                                                    { return trng_randomBelow(out, modulus, nwords) == TRNG_OK; }
+    /** @brief Write a uniform P-256 private scalar (TRNG_SCALAR_WORDS words). */
+    bool randomScalarP256(uint32_t *out)            { return trng_randomScalarP256(out) == TRNG_OK; }
+    /** @brief Write a uniform Curve25519 subgroup scalar (TRNG_SCALAR_WORDS words). */
+    bool randomScalarCurve25519(uint32_t *out)      { return trng_randomScalarCurve25519(out) == TRNG_OK; }
     /** @brief Fill a buffer with random bytes. */
     bool fillRandom(uint8_t *buf, size_t len)       { return trng_fillRandom(buf, len) == TRNG_OK; }
+    /** @brief XOR random bytes into @p buf in place. */
+    bool xorRandom(uint8_t *buf, size_t len)        { return trng_xorRandom(buf, len) == TRNG_OK; }
+    /** @brief Fill @p count buffers as one stream, sharing hardware blocks across them. */
+    bool fillRandomV(const trng_iovec *iov, size_t count)
+                                                    { return trng_fillRandomV(iov, count) == TRNG_OK; }
+    /** @brief getrandom(2)-style fill: bytes written, or TRNG_EINVAL / TRNG_EAGAIN / TRNG_EIO. */
+    int32_t getrandom(void *buf, size_t len, uint32_t flags = 0U)
+                                                    { return trng_getrandom(buf, len, flags); }
+    /** @brief Fill a bitmap with bits set with probability @p p (2^-32 units). */
+    bool fillBernoulli(uint32_t *out, size_t words, uint32_t p)
+                                                    { return trng_fillBernoulli(out, words, p) == TRNG_OK; }
+    /** @brief Generate @p count version 4 UUIDs (16 bytes each). */
+    bool uuid4(uint8_t *out, size_t count)          { return trng_uuid4(out, count) == TRNG_OK; }
+    /** @brief Generate @p count version 7 UUIDs stamped with @p unixMs. */
+    bool uuid7(uint8_t *out, size_t count, uint64_t unixMs)
+                                                    { return trng_uuid7(out, count, unixMs) == TRNG_OK; }
+    /** @brief Format @p count UUIDs as text (37 chars each, with NUL). */
+    bool uuidToString(char *out, const uint8_t *uuids, size_t count)
+                                                    { return trng_uuidToString(out, uuids, count) == TRNG_OK; }
+    /** @brief Write @p len random symbols from @p alphabet, plus a NUL, into @p out. */
+    bool randomString(char *out, size_t len, const char *alphabet, size_t alphabetLen)
+                                                    { return trng_randomString(out, len, alphabet, alphabetLen) == TRNG_OK; }
+    /** @brief Write @p nBytes random bytes as an uppercase hex string. */
+    bool fillHex(char *out, size_t nBytes)          { return trng_fillHex(out, nBytes) == TRNG_OK; }
+    /** @brief Write @p nBytes random bytes as a padded base64 string. */
+    bool fillBase64(char *out, size_t nBytes)       { return trng_fillBase64(out, nBytes) == TRNG_OK; }
+    /** @brief Key a Philox4x32-10 generator from the TRNG. */
+    bool philoxSeed(trng_philox *p)                 { return trng_philoxSeed(p) == TRNG_OK; }
+
+    /**
+     * @brief  Stream @p nBytes random bytes to a Print or Stream sink
+     *         (Serial, WiFiClient, File, ...).
+     *
+     * Hardware blocks are read straight into one of two TRNG_WRITE_CHUNK
+     * staging chunks and passed to @p out.write(). When the sink accepts
+     * only part of a chunk (a full transmit buffer or TCP window), the
+     * next chunk is generated into the other one before the rest is
+     * retried, so generation overlaps the drain. Sinks whose write()
+     * blocks until all data is sent or stored (File, most WiFiClient
+     * cores) never return short, so for them chunks alternate without
+     * overlap. Both chunks are wiped before returning. Works with any type
+     * providing write(const uint8_t *, size_t), so the loop can run
+     * against a mock.
+     *
+     * @return Number of bytes written; less than @p nBytes if the TRNG
+     *         failed or the sink stopped accepting data.
+     */
+    template <typename Sink>
+    size_t writeTo(Sink &out, size_t nBytes) {
+        static_assert((TRNG_WRITE_CHUNK % 16U) == 0U, "TRNG_WRITE_CHUNK must be a multiple of 16");
+        uint32_t chunk[2U][TRNG_WRITE_CHUNK / 4U];
+        size_t cur = 0U;
+        size_t curLen = chunkLen(nBytes, 0U);
+        size_t spareLen = 0U;
+        size_t sent = 0U;
+        bool ok = fillChunk(chunk[0U], curLen);
+
+        while (ok && (sent < nBytes)) {
+            const uint8_t *bytes = reinterpret_cast<const uint8_t *>(chunk[cur]);
+            size_t off = 0U;
+            while (ok && (off < curLen)) {
+                size_t n = out.write(&bytes[off], curLen - off);
+                off += n;
+                ok = (n != 0U);
+                if (ok && (off < curLen) && (spareLen == 0U) && ((sent + curLen) < nBytes)) {
+                    /* Short write: the sink is draining, stage the next chunk meanwhile. */
+                    spareLen = chunkLen(nBytes, sent + curLen);
+                    ok = fillChunk(chunk[cur ^ 1U], spareLen);
+                }
+            }
+            sent += off;
+            if (ok && (sent < nBytes)) {
+                if (spareLen == 0U) {
+                    spareLen = chunkLen(nBytes, sent);
+                    ok = fillChunk(chunk[cur ^ 1U], spareLen);
+                }
+                cur ^= 1U;
+                curLen = spareLen;
+                spareLen = 0U;
+            }
+        }
+        for (size_t i = 0U; i < (TRNG_WRITE_CHUNK / 4U); i++) {
+            chunk[0U][i] = 0U;
+            chunk[1U][i] = 0U;
+        }
+
+        return sent;
+    }
+
+    /**
+     * @brief  Send @p nFrames export frames (see trng_frame.h) to a Print
+     *         or Stream sink.
+     *
+     * Each frame carries TRNG_FRAME_PAYLOAD random bytes, the result of
+     * trng_frameHealth() and the next sequence number. The sequence counter
+     * persists across calls so a host can detect dropped frames.
+     *
+     * @return Number of frames sent completely.
+     */
+    template <typename Sink>
+    size_t writeFrames(Sink &out, size_t nFrames) {
+        static_assert(TRNG_FRAME_PAYLOAD <= TRNG_FRAME_MAX_PAYLOAD, "TRNG_FRAME_PAYLOAD too large");
+        uint8_t frame[TRNG_FRAME_SIZE(TRNG_FRAME_PAYLOAD)];
+        uint8_t *payload = &frame[TRNG_FRAME_HEADER_SIZE];
+        size_t sent = 0U;
+        bool ok = true;
+
+        while (ok && (sent < nFrames)) {
+            ok = (trng_fillRandom(payload, TRNG_FRAME_PAYLOAD) == TRNG_OK);
+            if (ok) {
+                size_t size = trng_frameEncode(frame, _frameSeq, trng_frameHealth(payload, TRNG_FRAME_PAYLOAD),
+                                               TRNG_FRAME_PAYLOAD);
+                size_t off = 0U;
+                _frameSeq++;
+                while (ok && (off < size)) {
+                    size_t n = out.write(&frame[off], size - off);
+                    off += n;
+                    ok = (n != 0U);
+                }
+                if (ok) {
+                    sent++;
+                }
+            }
+        }
+
+        return sent;
+    }
+
+    /**
+     * @brief  Send a device information frame (TRNG_FRAME_FLAG_INFO) to a
+     *         Print or Stream sink.
+     *
+     * Tells a host capture tool which device and configuration the
+     * following entropy frames come from. The frame takes the next
+     * sequence number, so the stream stays gap-free.
+     *
+     * @param  out       Sink.
+     * @param  uptimeMs  Current time since reset, e.g. millis().
+     * @return true if the whole frame was written.
+     */
+    template <typename Sink>
+    bool writeInfoFrame(Sink &out, uint32_t uptimeMs) {
+        uint8_t frame[TRNG_FRAME_SIZE(TRNG_INFO_SIZE)];
+        trng_info info;
+        bool ok = (trng_deviceId(info.deviceId) == TRNG_OK);
+
+        if (ok) {
+            info.uptimeMs = uptimeMs;
+            info.source = TRNG_SOURCE_CONDITIONED;
+            info.payloadSize = TRNG_FRAME_PAYLOAD;
+            trng_infoEncode(&frame[TRNG_FRAME_HEADER_SIZE], &info);
+            size_t size = trng_frameEncode(frame, _frameSeq, TRNG_FRAME_FLAG_INFO, TRNG_INFO_SIZE);
+            size_t off = 0U;
+            _frameSeq++;
+            while (ok && (off < size)) {
+                size_t n = out.write(&frame[off], size - off);
+                off += n;
+                ok = (n != 0U);
+            }
+        }
+
+        return ok;
+    }
+
+private:
+    /** @brief Bytes of the writeTo() chunk starting at @p done of @p nBytes. */
+    static size_t chunkLen(size_t nBytes, size_t done) {
+        return ((nBytes - done) < TRNG_WRITE_CHUNK) ? (nBytes - done) : TRNG_WRITE_CHUNK;
+    }
+
+    /** @brief Read whole hardware blocks into a chunk until @p len bytes are covered. */
+    static bool fillChunk(uint32_t *chunk, size_t len) {
+        bool ok = true;
+        for (size_t w = 0U; ok && ((w * 4U) < len); w += 4U) {
+            ok = (trng_read128(&chunk[w]) == TRNG_OK);
+        }
+        return ok;
+    }
+
+    /** @brief Sequence number of the next export frame. */
+    uint32_t _frameSeq = 0U;
 };
 
 /** @brief Global TRNG instance. */
@@ -0,0 +1,194 @@
+/*******************************************************************************
+ * @file    trng_delay.c
+ * @brief   Random delays and dummy operations for side-channel hardening.
+ *
+ * The only hardware dependency is trng_read128(), so the module builds on
+ * a host with a stand-in for that function.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_delay.h"
+
+/**
+ * @brief  Replace the buffered block with a new hardware block.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ */
+static uint8_t trng_delayBlock(trng_delay *d) {
+    uint8_t result = trng_read128(d->block);
+
+    if (result == TRNG_OK) {
+        d->blockPos = 0U;
+        d->hwReads++;
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Take @p n bits (1..30) from the reservoir, moving in the next
+ *         buffered word when it runs short.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ */
+static uint8_t trng_delayBits(trng_delay *d, uint8_t n, uint32_t *out) {
+    uint8_t result = TRNG_OK;
+
+    if (d->count < n) {
+        if (d->blockPos >= 4U) {
+            result = trng_delayBlock(d);
+        }
+        if (result == TRNG_OK) {
+            d->reservoir |= (uint64_t)d->block[d->blockPos] << d->count;
+            d->block[d->blockPos] = 0U;
+            d->blockPos++;
+            d->count = (uint8_t)(d->count + 32U);
+        }
+    }
+
+    if (result == TRNG_OK) {
+        *out = (uint32_t)(d->reservoir & ((1ULL << n) - 1ULL));
+        d->reservoir >>= n;
+        d->count = (uint8_t)(d->count - n);
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Initialize a sampler.
+ * @param[out] d      Context.
+ * @param      bits   Delay bound in bits.
+ * @param      shape  Distribution.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Null pointer, bound out of range or unknown shape.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_delayInit(trng_delay *d, uint8_t bits, uint8_t shape) {
+    uint8_t result = TRNG_NOK;
+
+    if ((d != NULL) && (bits <= TRNG_DELAY_MAX_BITS) &&
+        (((shape == TRNG_DELAY_UNIFORM) && (bits >= 1U)) || ((shape == TRNG_DELAY_TRIANGLE) && (bits >= 2U)))) {
+        uint8_t i;
+        for (i = 0U; i < 4U; i++) {
+            d->block[i] = 0U;
+        }
+        d->reservoir = 0U;
+        d->blockPos = 4U;
+        d->count = 0U;
+        d->bits = bits;
+        d->shape = shape;
+        d->hwReads = 0U;
+        result = TRNG_OK;
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Read a fresh block unless the buffered one is untouched.
+ * @param  d  Context.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_delayRefill(trng_delay *d) {
+    uint8_t result = TRNG_NOK;
+
+    if (d != NULL) {
+        result = TRNG_OK;
+        if (d->blockPos != 0U) {
+            result = trng_delayBlock(d);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Draw one delay length.
+ * @param      d    Context.
+ * @param[out] out  Number of iterations.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_delaySample(trng_delay *d, uint32_t *out) {
+    uint8_t result = TRNG_NOK;
+
+    if ((d != NULL) && (out != NULL) && (d->bits != 0U)) {
+        uint32_t v;
+        if (d->shape == TRNG_DELAY_TRIANGLE) {
+            uint8_t half = (uint8_t)(d->bits - 1U);
+            /* One draw of both halves: a single reservoir step per delay. */
+            result = trng_delayBits(d, (uint8_t)(2U * half), &v);
+            if (result == TRNG_OK) {
+                *out = (v & ((1U << half) - 1U)) + (v >> half);
+            }
+        } else {
+            result = trng_delayBits(d, d->bits, &v);
+            if (result == TRNG_OK) {
+                *out = v;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Spin for @p n iterations.
+ * @param  n  Iterations.
+ */
+// cppcheck-suppress unusedFunction
+void trng_delaySpin(uint32_t n) {
+    volatile uint32_t i = n;
+
+    while (i != 0U) {
+        i--;
+    }
+}
+
+/**
+ * @brief  Draw a delay and spin for it.
+ * @param  d  Context.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_delayWait(trng_delay *d) {
+    uint32_t n = 0U;
+    uint8_t result = trng_delaySample(d, &n);
+
+    if (result == TRNG_OK) {
+        trng_delaySpin(n);
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Draw a delay and call a dummy operation that many times.
+ * @param  d    Context.
+ * @param  op   Dummy operation.
+ * @param  arg  Argument of @p op.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_delayDummy(trng_delay *d, trng_delayOp op, void *arg) {
+    uint32_t n = 0U;
+    uint8_t result = TRNG_NOK;
+
+    if (op != NULL) {
+        result = trng_delaySample(d, &n);
+        if (result == TRNG_OK) {
+            uint32_t i;
+            for (i = 0U; i < n; i++) {
+                op(arg);
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,148 @@
+/*******************************************************************************
+ * @file    trng_delay.h
+ * @brief   Random delays and dummy operations for side-channel hardening.
+ *
+ * Random delays between the steps of a cipher break the alignment of power
+ * or EM traces. Drawing each delay with trng_random32() costs a hardware
+ * read of variable latency, which itself disturbs the cycle budget. A
+ * trng_delay context instead draws only the few bits a delay needs from a
+ * reservoir of its own, refilled a 128-bit block at a time:
+ * - TRNG_DELAY_UNIFORM: @p bits bits, a delay in [0, 2^bits);
+ * - TRNG_DELAY_TRIANGLE: the sum of two draws of @p bits - 1 bits, in
+ *   [0, 2^bits - 2] with a triangular distribution. Its variance is half
+ *   that of the uniform shape, for a tighter bound on the total delay of
+ *   many calls.
+ *
+ * trng_delayWait() spins for the drawn number of iterations of a fixed
+ * loop, trng_delayDummy() calls a dummy operation that many times instead
+ * (e.g. a fake S-box lookup). Call trng_delayRefill() before a
+ * time-critical section: at least the next 128 bits then come from the
+ * buffer, so short sections never wait on the SCE5.
+ *
+ * @code
+ *   #include <trng.h>
+ *   #include <trng_delay.h>
+ *
+ *   static trng_delay jitter;
+ *
+ *   void setup() {
+ *       TRNG.begin();
+ *       (void)trng_delayInit(&jitter, 6U, TRNG_DELAY_TRIANGLE);
+ *   }
+ *
+ *   void encrypt() {
+ *       (void)trng_delayRefill(&jitter);
+ *       for (uint8_t r = 0U; r < 10U; r++) {
+ *           (void)trng_delayWait(&jitter);
+ *           round(r);
+ *       }
+ *   }
+ * @endcode
+ *
+ * The only hardware dependency is trng_read128(). A context is not
+ * thread-safe; use one per task or interrupt level.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_DELAY_H
+#define TRNG_DELAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "trng.h"
+
+/** @brief Delays uniform in [0, 2^bits). */
+#define TRNG_DELAY_UNIFORM      0U
+/** @brief Delays triangular in [0, 2^bits - 2], the sum of two uniform draws. */
+#define TRNG_DELAY_TRIANGLE     1U
+
+/** @brief Largest delay bound, in bits. */
+#define TRNG_DELAY_MAX_BITS     16U
+
+/** @brief Random delay sampler state. */
+typedef struct {
+    uint32_t block[4U];     /**< Buffered hardware block. */
+    uint64_t reservoir;     /**< Unused random bits, right-aligned. */
+    uint8_t  blockPos;      /**< Next unused word of @c block, 4 when empty. */
+    uint8_t  count;         /**< Number of bits in @c reservoir. */
+    uint8_t  bits;          /**< Delay bound in bits, 1 to TRNG_DELAY_MAX_BITS. */
+    uint8_t  shape;         /**< TRNG_DELAY_UNIFORM or TRNG_DELAY_TRIANGLE. */
+    uint32_t hwReads;       /**< Hardware blocks read. */
+} trng_delay;
+
+/** @brief Dummy operation for trng_delayDummy(). */
+typedef void (*trng_delayOp)(void *arg);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Initialize a sampler. Reads nothing from the hardware.
+ *
+ * @param[out] d      Context.
+ * @param      bits   Delay bound in bits, 1 to TRNG_DELAY_MAX_BITS
+ *                    (2 to TRNG_DELAY_MAX_BITS for TRNG_DELAY_TRIANGLE).
+ * @param      shape  TRNG_DELAY_UNIFORM or TRNG_DELAY_TRIANGLE.
+ *
+ * @retval  0   Success.
+ * @retval  1   Null pointer, bound out of range or unknown shape.
+ */
+uint8_t trng_delayInit(trng_delay *d, uint8_t bits, uint8_t shape);
+
+/**
+ * @brief   Read a fresh hardware block unless the buffered one is
+ *          untouched, so that at least the next 128 bits drawn do not
+ *          touch the SCE5. The unused words of a partly used block are
+ *          dropped.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or null pointer.
+ */
+uint8_t trng_delayRefill(trng_delay *d);
+
+/**
+ * @brief   Draw one delay length.
+ *
+ * @param      d    Context.
+ * @param[out] out  Number of iterations, distributed as configured.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or null pointer.
+ */
+uint8_t trng_delaySample(trng_delay *d, uint32_t *out);
+
+/**
+ * @brief   Spin for @p n iterations of a loop the compiler cannot remove.
+ *
+ * One iteration costs a fixed number of cycles on a given core and build;
+ * measure it once with the DWT cycle counter.
+ */
+void trng_delaySpin(uint32_t n);
+
+/**
+ * @brief   Draw a delay and spin for it.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or null pointer; no delay.
+ */
+uint8_t trng_delayWait(trng_delay *d);
+
+/**
+ * @brief   Draw a delay and call @p op that many times.
+ *
+ * @param   d    Context.
+ * @param   op   Dummy operation.
+ * @param   arg  Passed to @p op.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or null pointer; @p op is not
+ *              called.
+ */
+uint8_t trng_delayDummy(trng_delay *d, trng_delayOp op, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRNG_DELAY_H */
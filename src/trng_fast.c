@@ -0,0 +1,362 @@
+/*******************************************************************************
+ * @file    trng_fast.c
+ * @brief   Fast non-cryptographic generators seeded from the hardware TRNG.
+ *
+ * xoshiro256** 1.0 (Blackman and Vigna) and PCG32 XSH RR 64/32 (O'Neill).
+ * The only hardware dependency is trng_read128(), used for seeding.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_fast.h"
+#include "trng.h"
+#include <string.h>
+
+/** @brief PCG32 multiplier. */
+#define TRNG_PCG_MULT   6364136223846793005ULL
+
+/** @brief xoshiro256** jump polynomial for 2^128 steps. */
+static const uint64_t _jump[4U] = {
+    0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL
+};
+
+/** @brief xoshiro256** jump polynomial for 2^192 steps. */
+static const uint64_t _longJump[4U] = {
+    0x76E15D3EFEFDCBBFULL, 0xC5004E441C522FB3ULL, 0x77710069854EE241ULL, 0x39109BB02ACBE635ULL
+};
+
+/**
+ * @brief  Rotate a 64-bit value left.
+ */
+static uint64_t trng_rotl64(uint64_t x, uint32_t k) {
+    return (x << k) | (x >> (64U - k));
+}
+
+/**
+ * @brief  XOR 256 fresh TRNG bits into a xoshiro state.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed; the state is unchanged.
+ */
+static uint8_t trng_xoshiroMix(trng_xoshiro *g) {
+    uint8_t result = TRNG_NOK;
+    uint32_t buf[8U];
+
+    if ((trng_read128(&buf[0U]) == TRNG_OK) && (trng_read128(&buf[4U]) == TRNG_OK)) {
+        uint8_t i;
+        for (i = 0U; i < 4U; i++) {
+            g->s[i] ^= ((uint64_t)buf[2U * i] << 32U) | buf[(2U * i) + 1U];
+        }
+        /* The all-zero state is a fixed point. */
+        if ((g->s[0U] | g->s[1U] | g->s[2U] | g->s[3U]) == 0U) {
+            g->s[0U] = 1U;
+        }
+        result = TRNG_OK;
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Seed a xoshiro256** generator.
+ * @param[out] g            Generator.
+ * @param      reseedEvery  Outputs between reseeds, 0 = never.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_xoshiroSeed(trng_xoshiro *g, uint32_t reseedEvery) {
+    uint8_t result = TRNG_NOK;
+
+    if (g != NULL) {
+        g->s[0U] = 0U;
+        g->s[1U] = 0U;
+        g->s[2U] = 0U;
+        g->s[3U] = 0U;
+        g->reseedEvery = reseedEvery;
+        g->untilReseed = reseedEvery;
+        result = trng_xoshiroMix(g);
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Next 64-bit xoshiro256** output.
+ * @param  g  Generator.
+ * @return Output.
+ */
+uint64_t trng_xoshiroNext64(trng_xoshiro *g) {
+    uint64_t result = trng_rotl64(g->s[1U] * 5U, 7U) * 9U;
+    uint64_t t = g->s[1U] << 17U;
+
+    if (g->reseedEvery != 0U) {
+        if (g->untilReseed == 0U) {
+            /* A failed read keeps the current state. */
+            (void)trng_xoshiroMix(g);
+            g->untilReseed = g->reseedEvery;
+        }
+        g->untilReseed--;
+    }
+
+    g->s[2U] ^= g->s[0U];
+    g->s[3U] ^= g->s[1U];
+    g->s[1U] ^= g->s[2U];
+    g->s[0U] ^= g->s[3U];
+    g->s[2U] ^= t;
+    g->s[3U] = trng_rotl64(g->s[3U], 45U);
+
+    return result;
+}
+
+/**
+ * @brief  Next 32-bit xoshiro256** output.
+ * @param  g  Generator.
+ * @return Upper half of the next 64-bit output.
+ */
+// cppcheck-suppress unusedFunction
+uint32_t trng_xoshiroNext32(trng_xoshiro *g) {
+    return (uint32_t)(trng_xoshiroNext64(g) >> 32U);
+}
+
+/**
+ * @brief  Fill a buffer from a xoshiro256** generator.
+ * @param  g    Generator.
+ * @param  buf  Destination.
+ * @param  len  Number of bytes.
+ */
+// cppcheck-suppress unusedFunction
+void trng_xoshiroFill(trng_xoshiro *g, uint8_t *buf, size_t len) {
+    if ((g != NULL) && (buf != NULL)) {
+        size_t i = 0U;
+        while (i < len) {
+            uint64_t v = trng_xoshiroNext64(g);
+            uint8_t k;
+            for (k = 0U; (k < 8U) && (i < len); k++) {
+                buf[i] = (uint8_t)(v & 0xFFU);
+                v >>= 8U;
+                i++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief  XOR xoshiro256** output into a buffer, the same bytes as
+ *         trng_xoshiroFill() would write.
+ * @param  g    Generator.
+ * @param  buf  Buffer to mask.
+ * @param  len  Number of bytes.
+ */
+// cppcheck-suppress unusedFunction
+void trng_xoshiroXor(trng_xoshiro *g, uint8_t *buf, size_t len) {
+    if ((g != NULL) && (buf != NULL)) {
+        size_t i = 0U;
+        while ((len - i) >= 8U) {
+            uint64_t v = trng_xoshiroNext64(g);
+            uint64_t w;
+            (void)memcpy(&w, &buf[i], 8U);
+            w ^= v;
+            (void)memcpy(&buf[i], &w, 8U);
+            i += 8U;
+        }
+        if (i < len) {
+            uint64_t v = trng_xoshiroNext64(g);
+            while (i < len) {
+                buf[i] ^= (uint8_t)(v & 0xFFU);
+                v >>= 8U;
+                i++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief  Apply a jump polynomial to a xoshiro256** state.
+ */
+static void trng_xoshiroApply(trng_xoshiro *g, const uint64_t *poly) {
+    uint64_t s[4U] = { 0U, 0U, 0U, 0U };
+    uint32_t saved = g->reseedEvery;
+    uint8_t i;
+    uint8_t b;
+
+    /* Jumping must not trigger a reseed. */
+    g->reseedEvery = 0U;
+    for (i = 0U; i < 4U; i++) {
+        for (b = 0U; b < 64U; b++) {
+            if ((poly[i] & (1ULL << b)) != 0U) {
+                s[0U] ^= g->s[0U];
+                s[1U] ^= g->s[1U];
+                s[2U] ^= g->s[2U];
+                s[3U] ^= g->s[3U];
+            }
+            (void)trng_xoshiroNext64(g);
+        }
+    }
+    g->s[0U] = s[0U];
+    g->s[1U] = s[1U];
+    g->s[2U] = s[2U];
+    g->s[3U] = s[3U];
+    g->reseedEvery = saved;
+}
+
+/**
+ * @brief  Advance a xoshiro256** generator by 2^128 outputs.
+ * @param  g  Generator.
+ */
+// cppcheck-suppress unusedFunction
+void trng_xoshiroJump(trng_xoshiro *g) {
+    if (g != NULL) {
+        trng_xoshiroApply(g, _jump);
+    }
+}
+
+/**
+ * @brief  Advance a xoshiro256** generator by 2^192 outputs.
+ * @param  g  Generator.
+ */
+// cppcheck-suppress unusedFunction
+void trng_xoshiroLongJump(trng_xoshiro *g) {
+    if (g != NULL) {
+        trng_xoshiroApply(g, _longJump);
+    }
+}
+
+/**
+ * @brief  Seed a PCG32 generator.
+ * @param[out] g            Generator.
+ * @param      reseedEvery  Outputs between reseeds, 0 = never.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_pcgSeed(trng_pcg *g, uint32_t reseedEvery) {
+    uint8_t result = TRNG_NOK;
+
+    if (g != NULL) {
+        uint32_t buf[4U];
+        if (trng_read128(buf) == TRNG_OK) {
+            /* pcg32_srandom_r(): stream from one half, state from the other. */
+            g->inc = (((uint64_t)buf[2U] << 32U) | buf[3U]) << 1U;
+            g->inc |= 1U;
+            g->state = 0U;
+            g->reseedEvery = 0U;
+            (void)trng_pcgNext32(g);
+            g->state += ((uint64_t)buf[0U] << 32U) | buf[1U];
+            (void)trng_pcgNext32(g);
+            g->reseedEvery = reseedEvery;
+            g->untilReseed = reseedEvery;
+            result = TRNG_OK;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Next 32-bit PCG32 output.
+ * @param  g  Generator.
+ * @return Output.
+ */
+uint32_t trng_pcgNext32(trng_pcg *g) {
+    uint64_t old;
+    uint32_t xorshifted;
+    uint32_t rot;
+
+    if (g->reseedEvery != 0U) {
+        if (g->untilReseed == 0U) {
+            uint32_t buf[4U];
+            /* Fresh state on the same stream; a failed read keeps the state. */
+            if (trng_read128(buf) == TRNG_OK) {
+                g->state ^= ((uint64_t)buf[0U] << 32U) | buf[1U];
+            }
+            g->untilReseed = g->reseedEvery;
+        }
+        g->untilReseed--;
+    }
+
+    old = g->state;
+    g->state = (old * TRNG_PCG_MULT) + g->inc;
+    xorshifted = (uint32_t)(((old >> 18U) ^ old) >> 27U);
+    rot = (uint32_t)(old >> 59U);
+
+    return (xorshifted >> rot) | (xorshifted << ((32U - rot) & 31U));
+}
+
+/**
+ * @brief  Fill a buffer from a PCG32 generator.
+ * @param  g    Generator.
+ * @param  buf  Destination.
+ * @param  len  Number of bytes.
+ */
+// cppcheck-suppress unusedFunction
+void trng_pcgFill(trng_pcg *g, uint8_t *buf, size_t len) {
+    if ((g != NULL) && (buf != NULL)) {
+        size_t i = 0U;
+        while (i < len) {
+            uint32_t v = trng_pcgNext32(g);
+            uint8_t k;
+            for (k = 0U; (k < 4U) && (i < len); k++) {
+                buf[i] = (uint8_t)(v & 0xFFU);
+                v >>= 8U;
+                i++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief  XOR PCG32 output into a buffer, the same bytes as
+ *         trng_pcgFill() would write.
+ * @param  g    Generator.
+ * @param  buf  Buffer to mask.
+ * @param  len  Number of bytes.
+ */
+// cppcheck-suppress unusedFunction
+void trng_pcgXor(trng_pcg *g, uint8_t *buf, size_t len) {
+    if ((g != NULL) && (buf != NULL)) {
+        size_t i = 0U;
+        while ((len - i) >= 4U) {
+            uint32_t v = trng_pcgNext32(g);
+            uint32_t w;
+            (void)memcpy(&w, &buf[i], 4U);
+            w ^= v;
+            (void)memcpy(&buf[i], &w, 4U);
+            i += 4U;
+        }
+        if (i < len) {
+            uint32_t v = trng_pcgNext32(g);
+            while (i < len) {
+                buf[i] ^= (uint8_t)(v & 0xFFU);
+                v >>= 8U;
+                i++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief  Advance a PCG32 generator by @p delta outputs (Brown, "Random
+ *         number generation with arbitrary strides", 1994).
+ * @param  g      Generator.
+ * @param  delta  Number of outputs to skip.
+ */
+// cppcheck-suppress unusedFunction
+void trng_pcgAdvance(trng_pcg *g, uint64_t delta) {
+    if (g != NULL) {
+        uint64_t curMult = TRNG_PCG_MULT;
+        uint64_t curPlus = g->inc;
+        uint64_t accMult = 1U;
+        uint64_t accPlus = 0U;
+        uint64_t d = delta;
+
+        while (d > 0U) {
+            if ((d & 1U) != 0U) {
+                accMult *= curMult;
+                accPlus = (accPlus * curMult) + curPlus;
+            }
+            curPlus = (curMult + 1U) * curPlus;
+            curMult *= curMult;
+            d >>= 1U;
+        }
+        g->state = (accMult * g->state) + accPlus;
+    }
+}
@@ -0,0 +1,197 @@
+/*******************************************************************************
+ * @file    trng_fast.h
+ * @brief   Fast non-cryptographic generators seeded from the hardware TRNG.
+ *
+ * For randomness that needs speed rather than unpredictability (LED
+ * effects, test data, simulation), xoshiro256** and PCG32 produce output
+ * in a few cycles per word, without reading the SCE5 for every value.
+ * Both are seeded from trng_read128() and can be reseeded from it every
+ * @p reseedEvery outputs.
+ *
+ * @warning These generators are predictable from a few outputs. Never use
+ *          them for keys, nonces, tokens or anything an attacker may
+ *          observe; use the TRNG functions of trng.h for those.
+ *
+ * Streams: trng_xoshiroJump() advances a generator by 2^128 outputs and
+ * trng_pcgAdvance() by any distance, so copies of one seeded generator
+ * give non-overlapping streams. Set @p reseedEvery to 0 for such split or
+ * reproducible streams, since a reseed leaves the jumped-to sequence.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_FAST_H
+#define TRNG_FAST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef TRNG_FAST_RESEED
+/** @brief Default number of outputs between reseeds from the TRNG. */
+#define TRNG_FAST_RESEED    1048576UL
+#endif
+
+/** @brief xoshiro256** state. */
+typedef struct {
+    uint64_t s[4U];         /**< Generator state, never all zero. */
+    uint32_t reseedEvery;   /**< Outputs between reseeds, 0 = never. */
+    uint32_t untilReseed;   /**< Outputs left before the next reseed. */
+} trng_xoshiro;
+
+/** @brief PCG32 (XSH RR 64/32) state. */
+typedef struct {
+    uint64_t state;         /**< LCG state. */
+    uint64_t inc;           /**< Stream increment, always odd. */
+    uint32_t reseedEvery;   /**< Outputs between reseeds, 0 = never. */
+    uint32_t untilReseed;   /**< Outputs left before the next reseed. */
+} trng_pcg;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Seed a xoshiro256** generator from two TRNG blocks.
+ *
+ * @param[out] g            Generator.
+ * @param      reseedEvery  Outputs between reseeds, 0 to never reseed.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or null pointer.
+ */
+uint8_t trng_xoshiroSeed(trng_xoshiro *g, uint32_t reseedEvery);
+
+/**
+ * @brief   Next 64-bit output.
+ */
+uint64_t trng_xoshiroNext64(trng_xoshiro *g);
+
+/**
+ * @brief   Next 32-bit output (upper half of a 64-bit output).
+ */
+uint32_t trng_xoshiroNext32(trng_xoshiro *g);
+
+/**
+ * @brief   Fill a buffer, eight bytes per output.
+ */
+void trng_xoshiroFill(trng_xoshiro *g, uint8_t *buf, size_t len);
+
+/**
+ * @brief   XOR the bytes trng_xoshiroFill() would write into a buffer, a
+ *          64-bit word at a time. XOR again from the same state to undo.
+ */
+void trng_xoshiroXor(trng_xoshiro *g, uint8_t *buf, size_t len);
+
+/**
+ * @brief   Advance by 2^128 outputs: up to 2^128 non-overlapping streams.
+ */
+void trng_xoshiroJump(trng_xoshiro *g);
+
+/**
+ * @brief   Advance by 2^192 outputs: 2^64 groups of jump() streams.
+ */
+void trng_xoshiroLongJump(trng_xoshiro *g);
+
+/**
+ * @brief   Seed a PCG32 generator (state and stream) from one TRNG block.
+ *
+ * @param[out] g            Generator.
+ * @param      reseedEvery  Outputs between reseeds, 0 to never reseed.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or null pointer.
+ */
+uint8_t trng_pcgSeed(trng_pcg *g, uint32_t reseedEvery);
+
+/**
+ * @brief   Next 32-bit output.
+ */
+uint32_t trng_pcgNext32(trng_pcg *g);
+
+/**
+ * @brief   Fill a buffer, four bytes per output.
+ */
+void trng_pcgFill(trng_pcg *g, uint8_t *buf, size_t len);
+
+/**
+ * @brief   XOR the bytes trng_pcgFill() would write into a buffer, a
+ *          32-bit word at a time. XOR again from the same state to undo.
+ */
+void trng_pcgXor(trng_pcg *g, uint8_t *buf, size_t len);
+
+/**
+ * @brief   Advance by @p delta outputs in O(log delta) steps.
+ */
+void trng_pcgAdvance(trng_pcg *g, uint64_t delta);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* ---- C++ wrapper classes ---- */
+#ifdef __cplusplus
+
+/**
+ * @class   trngXoshiro
+ * @brief   xoshiro256** seeded from the TRNG. Not for cryptographic use.
+ *
+ * Usage:
+ * @code
+ *   #include <trng.h>
+ *   #include <trng_fast.h>
+ *
+ *   trngXoshiro fast;
+ *
+ *   void setup() {
+ *       TRNG.begin();
+ *       fast.begin();
+ *       uint32_t hue = fast.next32() % 360U;
+ *   }
+ * @endcode
+ */
+class trngXoshiro {
+public:
+    /** @brief Seed from the TRNG, reseeding every @p reseedEvery outputs (0 = never). */
+    bool begin(uint32_t reseedEvery = TRNG_FAST_RESEED)
+                                                    { return trng_xoshiroSeed(&_g, reseedEvery) == 0U; }
+    /** @brief Next 32-bit output. */
+    uint32_t next32()                               { return trng_xoshiroNext32(&_g); }
+    /** @brief Next 64-bit output. */
+    uint64_t next64()                               { return trng_xoshiroNext64(&_g); }
+    /** @brief Fill a buffer. */
+    void fill(uint8_t *buf, size_t len)             { trng_xoshiroFill(&_g, buf, len); }
+    /** @brief XOR output into a buffer in place. */
+    void xorInto(uint8_t *buf, size_t len)          { trng_xoshiroXor(&_g, buf, len); }
+    /** @brief Advance by 2^128 outputs. */
+    void jump()                                     { trng_xoshiroJump(&_g); }
+    /** @brief Advance by 2^192 outputs. */
+    void longJump()                                 { trng_xoshiroLongJump(&_g); }
+
+private:
+    trng_xoshiro _g = {};
+};
+
+/**
+ * @class   trngPcg
+ * @brief   PCG32 seeded from the TRNG. Not for cryptographic use.
+ */
+class trngPcg {
+public:
+    /** @brief Seed from the TRNG, reseeding every @p reseedEvery outputs (0 = never). */
+    bool begin(uint32_t reseedEvery = TRNG_FAST_RESEED)
+                                                    { return trng_pcgSeed(&_g, reseedEvery) == 0U; }
+    /** @brief Next 32-bit output. */
+    uint32_t next32()                               { return trng_pcgNext32(&_g); }
+    /** @brief Fill a buffer. */
+    void fill(uint8_t *buf, size_t len)             { trng_pcgFill(&_g, buf, len); }
+    /** @brief XOR output into a buffer in place. */
+    void xorInto(uint8_t *buf, size_t len)          { trng_pcgXor(&_g, buf, len); }
+    /** @brief Advance by @p delta outputs. */
+    void advance(uint64_t delta)                    { trng_pcgAdvance(&_g, delta); }
+
+private:
+    trng_pcg _g = {};
+};
+
+#endif /* __cplusplus */
+
+#endif /* TRNG_FAST_H */
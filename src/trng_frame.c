@@ -0,0 +1,296 @@
+/*******************************************************************************
+ * @file    trng_frame.c
+ * @brief   Framed binary protocol for continuous TRNG export.
+ *
+ * Frame encoding, CRC-32, per-frame health tests and a streaming decoder
+ * that resynchronizes on the magic bytes after corruption or data loss.
+ * Depends only on the C standard library.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_frame.h"
+#include <string.h>
+
+/** @brief Adaptive proportion cutoff for a 256-byte window (P < 2^-30). */
+#define TRNG_APT_CUTOFF     13U
+/** @brief Adaptive proportion window in bytes. */
+#define TRNG_APT_WINDOW     256U
+
+/** @brief CRC-32 table, one entry per nibble (reflected polynomial 0xEDB88320). */
+static const uint32_t _crcTable[16U] = {
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+    0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+    0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
+};
+
+/**
+ * @brief  Read a little-endian 32-bit value.
+ */
+static uint32_t trng_getLe32(const uint8_t *p) {
+    return (uint32_t)p[0U] | ((uint32_t)p[1U] << 8U) |
+           ((uint32_t)p[2U] << 16U) | ((uint32_t)p[3U] << 24U);
+}
+
+/**
+ * @brief  Write a little-endian 32-bit value.
+ */
+static void trng_putLe32(uint8_t *p, uint32_t v) {
+    p[0U] = (uint8_t)(v & 0xFFU);
+    p[1U] = (uint8_t)((v >> 8U) & 0xFFU);
+    p[2U] = (uint8_t)((v >> 16U) & 0xFFU);
+    p[3U] = (uint8_t)(v >> 24U);
+}
+
+/**
+ * @brief  Update a CRC-32 over @p len bytes.
+ * @param  crc   Previous value, 0 to start.
+ * @param  data  Bytes to process.
+ * @param  len   Number of bytes.
+ * @return Updated CRC.
+ */
+uint32_t trng_crc32(uint32_t crc, const uint8_t *data, size_t len) {
+    uint32_t c = ~crc;
+    size_t i;
+
+    for (i = 0U; i < len; i++) {
+        c ^= data[i];
+        c = (c >> 4U) ^ _crcTable[c & 0x0FU];
+        c = (c >> 4U) ^ _crcTable[c & 0x0FU];
+    }
+
+    return ~c;
+}
+
+/**
+ * @brief  Run the repetition count and adaptive proportion tests.
+ * @param  payload  Payload bytes.
+ * @param  len      Payload length.
+ * @return TRNG_FRAME_FLAG_* bits for the failed tests.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_frameHealth(const uint8_t *payload, size_t len) {
+    uint8_t flags = 0U;
+
+    if (payload != NULL) {
+        size_t i;
+        size_t window = (len < TRNG_APT_WINDOW) ? len : TRNG_APT_WINDOW;
+        uint32_t count = 0U;
+
+        /* Any repeated 32-bit word is a 2^-32 event on healthy output. */
+        for (i = 4U; (i + 4U) <= len; i += 4U) {
+            if (trng_getLe32(&payload[i]) == trng_getLe32(&payload[i - 4U])) {
+                flags |= TRNG_FRAME_FLAG_RCT;
+            }
+        }
+
+        for (i = 0U; i < window; i++) {
+            if (payload[i] == payload[0U]) {
+                count++;
+            }
+        }
+        if ((window == TRNG_APT_WINDOW) && (count >= TRNG_APT_CUTOFF)) {
+            flags |= TRNG_FRAME_FLAG_APT;
+        }
+    }
+
+    return flags;
+}
+
+/**
+ * @brief  Write header and CRC around an in-place payload.
+ * @param  frame  Frame buffer, payload at offset TRNG_FRAME_HEADER_SIZE.
+ * @param  seq    Sequence number.
+ * @param  flags  Health flags.
+ * @param  len    Payload length.
+ * @return Frame size, 0 on invalid argument.
+ */
+// cppcheck-suppress unusedFunction
+size_t trng_frameEncode(uint8_t *frame, uint32_t seq, uint8_t flags, size_t len) {
+    size_t size = 0U;
+
+    if ((frame != NULL) && (len <= TRNG_FRAME_MAX_PAYLOAD)) {
+        uint32_t crc;
+        frame[0U] = TRNG_FRAME_MAGIC0;
+        frame[1U] = TRNG_FRAME_MAGIC1;
+        frame[2U] = TRNG_FRAME_VERSION;
+        frame[3U] = flags;
+        trng_putLe32(&frame[4U], seq);
+        frame[8U] = (uint8_t)(len & 0xFFU);
+        frame[9U] = (uint8_t)(len >> 8U);
+        crc = trng_crc32(0U, &frame[2U], (TRNG_FRAME_HEADER_SIZE - 2U) + len);
+        trng_putLe32(&frame[TRNG_FRAME_HEADER_SIZE + len], crc);
+        size = TRNG_FRAME_SIZE(len);
+    }
+
+    return size;
+}
+
+/**
+ * @brief  Encode a device information record.
+ * @param  out   Destination, TRNG_INFO_SIZE bytes.
+ * @param  info  Record.
+ */
+// cppcheck-suppress unusedFunction
+void trng_infoEncode(uint8_t *out, const trng_info *info) {
+    if ((out != NULL) && (info != NULL)) {
+        (void)memcpy(out, info->deviceId, sizeof(info->deviceId));
+        trng_putLe32(&out[16U], info->uptimeMs);
+        out[20U] = info->source;
+        out[21U] = 0U;
+        out[22U] = (uint8_t)(info->payloadSize & 0xFFU);
+        out[23U] = (uint8_t)(info->payloadSize >> 8U);
+    }
+}
+
+/**
+ * @brief  Decode a device information record.
+ * @param  info  Destination record.
+ * @param  in    Payload.
+ * @param  len   Payload length.
+ * @retval 0  Success.
+ * @retval 1  Payload too short or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_infoDecode(trng_info *info, const uint8_t *in, size_t len) {
+    uint8_t result = 1U;
+
+    if ((info != NULL) && (in != NULL) && (len >= TRNG_INFO_SIZE)) {
+        (void)memcpy(info->deviceId, in, sizeof(info->deviceId));
+        info->uptimeMs = trng_getLe32(&in[16U]);
+        info->source = in[20U];
+        info->payloadSize = (uint16_t)((uint16_t)in[22U] | ((uint16_t)in[23U] << 8U));
+        result = 0U;
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Reset a decoder and its counters.
+ * @param  d  Decoder.
+ */
+// cppcheck-suppress unusedFunction
+void trng_frameDecoderInit(trng_frame_decoder *d) {
+    if (d != NULL) {
+        (void)memset(d, 0, sizeof(*d));
+    }
+}
+
+/**
+ * @brief  Drop the first buffered byte and shift to the next magic candidate.
+ * @param  d  Decoder.
+ */
+static void trng_frameResync(trng_frame_decoder *d) {
+    size_t i = 1U;
+
+    while ((i < d->fill) && (d->buf[i] != TRNG_FRAME_MAGIC0)) {
+        i++;
+    }
+    d->skipped += (uint32_t)i;
+    d->fill -= i;
+    (void)memmove(d->buf, &d->buf[i], d->fill);
+}
+
+/**
+ * @brief  Check the buffered bytes against the frame format.
+ * @param  d  Decoder.
+ * @return 1 if a complete valid frame is buffered, 0 if more bytes are
+ *         needed. Invalid prefixes are dropped by resynchronizing.
+ */
+static uint8_t trng_frameCheck(trng_frame_decoder *d) {
+    uint8_t ready = 0U;
+    uint8_t more = 0U;
+
+    while ((ready == 0U) && (more == 0U) && (d->fill != 0U)) {
+        if ((d->buf[0U] != TRNG_FRAME_MAGIC0) ||
+            ((d->fill >= 2U) && (d->buf[1U] != TRNG_FRAME_MAGIC1)) ||
+            ((d->fill >= 3U) && (d->buf[2U] != TRNG_FRAME_VERSION))) {
+            trng_frameResync(d);
+        } else if (d->fill < TRNG_FRAME_HEADER_SIZE) {
+            more = 1U;
+        } else {
+            size_t len = (size_t)d->buf[8U] | ((size_t)d->buf[9U] << 8U);
+            if (len > TRNG_FRAME_MAX_PAYLOAD) {
+                trng_frameResync(d);
+            } else if (d->fill < TRNG_FRAME_SIZE(len)) {
+                more = 1U;
+            } else {
+                uint32_t crc = trng_crc32(0U, &d->buf[2U], (TRNG_FRAME_HEADER_SIZE - 2U) + len);
+                if (crc != trng_getLe32(&d->buf[TRNG_FRAME_HEADER_SIZE + len])) {
+                    d->crcErrors++;
+                    trng_frameResync(d);
+                } else {
+                    d->seq = trng_getLe32(&d->buf[4U]);
+                    d->flags = d->buf[3U];
+                    d->payload = &d->buf[TRNG_FRAME_HEADER_SIZE];
+                    d->payloadLen = len;
+                    if ((d->synced != 0U) && (d->seq != d->nextSeq)) {
+                        uint32_t gap = d->seq - d->nextSeq;
+                        if (gap <= TRNG_FRAME_MAX_GAP) {
+                            d->lostFrames += gap;
+                        } else {
+                            /* The sender restarted its numbering. */
+                            d->resyncs++;
+                        }
+                    }
+                    d->synced = 1U;
+                    d->nextSeq = d->seq + 1U;
+                    d->frames++;
+                    if ((d->flags & TRNG_FRAME_FLAG_HEALTH) != 0U) {
+                        d->flagged++;
+                    }
+                    if ((d->flags & TRNG_FRAME_FLAG_INFO) != 0U) {
+                        d->infoFrames++;
+                    }
+                    ready = 1U;
+                }
+            }
+        }
+    }
+
+    return ready;
+}
+
+/**
+ * @brief  Feed received bytes until a frame completes.
+ * @param  d      Decoder.
+ * @param  data   Received bytes.
+ * @param  len    Number of received bytes.
+ * @param  ready  Set to 1 when a frame is available.
+ * @return Number of bytes consumed.
+ */
+// cppcheck-suppress unusedFunction
+size_t trng_frameFeed(trng_frame_decoder *d, const uint8_t *data, size_t len, uint8_t *ready) {
+    size_t used = 0U;
+    uint8_t done = 0U;
+
+    if ((d != NULL) && (data != NULL) && (ready != NULL)) {
+        /* Release the frame returned by the previous call. */
+        if ((d->payload != NULL) && (d->fill >= TRNG_FRAME_SIZE(d->payloadLen))) {
+            size_t size = TRNG_FRAME_SIZE(d->payloadLen);
+            d->fill -= size;
+            (void)memmove(d->buf, &d->buf[size], d->fill);
+        }
+        d->payload = NULL;
+        d->payloadLen = 0U;
+
+        done = trng_frameCheck(d);
+        while ((done == 0U) && (used < len)) {
+            /* Copy only up to the end of the header or frame in progress. */
+            size_t want = TRNG_FRAME_HEADER_SIZE;
+            size_t take;
+            if (d->fill >= TRNG_FRAME_HEADER_SIZE) {
+                want = TRNG_FRAME_SIZE((size_t)d->buf[8U] | ((size_t)d->buf[9U] << 8U));
+            }
+            take = ((want - d->fill) < (len - used)) ? (want - d->fill) : (len - used);
+            (void)memcpy(&d->buf[d->fill], &data[used], take);
+            d->fill += take;
+            used += take;
+            done = trng_frameCheck(d);
+        }
+        *ready = done;
+    }
+
+    return used;
+}
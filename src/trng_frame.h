@@ -0,0 +1,202 @@
+/*******************************************************************************
+ * @file    trng_frame.h
+ * @brief   Framed binary protocol for continuous TRNG export.
+ *
+ * Each frame carries a sequence number, health-status flags and a CRC-32 so
+ * that a host can reassemble a continuous entropy stream, detect lost or
+ * corrupted frames and discard output flagged by the on-board health tests.
+ *
+ * Frame layout (multi-byte fields little-endian):
+ *
+ * | Offset | Size | Field                                        |
+ * |--------|------|----------------------------------------------|
+ * | 0      | 2    | Magic 0xA5 0x5A                              |
+ * | 2      | 1    | Protocol version (TRNG_FRAME_VERSION)         |
+ * | 3      | 1    | Health flags (TRNG_FRAME_FLAG_*)              |
+ * | 4      | 4    | Sequence number, +1 per frame                 |
+ * | 8      | 2    | Payload length N (<= TRNG_FRAME_MAX_PAYLOAD)  |
+ * | 10     | N    | Payload (TRNG output)                         |
+ * | 10 + N | 4    | CRC-32 (IEEE 802.3) of bytes 2 .. 10 + N - 1  |
+ *
+ * A frame with TRNG_FRAME_FLAG_INFO set carries a device information
+ * record (see trng_info) instead of entropy. Its payload must never be used
+ * as random data, but it is not a health failure either: receivers test
+ * TRNG_FRAME_FLAG_HEALTH for that, never the flags byte as a whole.
+ *
+ * The decoder counts a forward sequence jump of up to TRNG_FRAME_MAX_GAP
+ * as lost frames. A backward jump, as after a board reset or reconnect,
+ * or a larger one is a resync: it is counted in @c resyncs and restarts
+ * the numbering without adding to @c lostFrames.
+ *
+ * This module has no hardware dependency and builds unchanged on a host,
+ * where the decoder is used by the receiver in extras/host.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_FRAME_H
+#define TRNG_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @brief First magic byte. */
+#define TRNG_FRAME_MAGIC0           0xA5U
+/** @brief Second magic byte. */
+#define TRNG_FRAME_MAGIC1           0x5AU
+/** @brief Protocol version carried in every frame. */
+#define TRNG_FRAME_VERSION          1U
+/** @brief Bytes before the payload. */
+#define TRNG_FRAME_HEADER_SIZE      10U
+/** @brief Bytes after the payload (CRC-32). */
+#define TRNG_FRAME_TRAILER_SIZE     4U
+/** @brief Largest payload accepted by the decoder. */
+#define TRNG_FRAME_MAX_PAYLOAD      1024U
+/** @brief Total frame size for a payload of @p n bytes. */
+#define TRNG_FRAME_SIZE(n)          ((n) + TRNG_FRAME_HEADER_SIZE + TRNG_FRAME_TRAILER_SIZE)
+/** @brief Largest forward sequence jump counted as lost frames. */
+#define TRNG_FRAME_MAX_GAP          65536U
+
+/** @brief Repetition count test failed (two equal consecutive words). */
+#define TRNG_FRAME_FLAG_RCT         0x01U
+/** @brief Adaptive proportion test failed (one byte value too frequent). */
+#define TRNG_FRAME_FLAG_APT         0x02U
+/** @brief Payload is a device information record, not entropy. */
+#define TRNG_FRAME_FLAG_INFO        0x80U
+/** @brief Flags that report a health test failure. */
+#define TRNG_FRAME_FLAG_HEALTH      (TRNG_FRAME_FLAG_RCT | TRNG_FRAME_FLAG_APT)
+
+/** @brief Size of an encoded trng_info record. */
+#define TRNG_INFO_SIZE              24U
+/** @brief Samples taken from the noise source before any conditioning. */
+#define TRNG_SOURCE_RAW             1U
+/** @brief Conditioned output, as returned by HW_SCE_RNG_Read(). */
+#define TRNG_SOURCE_CONDITIONED     2U
+
+/**
+ * @brief   Device information record sent in TRNG_FRAME_FLAG_INFO frames.
+ *
+ * Encoded little-endian as: device ID (16 bytes), uptime (4), source (1),
+ * reserved (1), entropy payload size (2).
+ */
+typedef struct {
+    uint8_t  deviceId[16];  /**< MCU unique ID. */
+    uint32_t uptimeMs;      /**< Milliseconds since reset when sent. */
+    uint8_t  source;        /**< TRNG_SOURCE_* of the entropy frames. */
+    uint16_t payloadSize;   /**< Payload size of the entropy frames. */
+} trng_info;
+
+/**
+ * @brief   Streaming frame decoder state.
+ *
+ * Initialize with trng_frameDecoderInit(), then feed raw bytes with
+ * trng_frameFeed(). The counters accumulate over the life of the decoder.
+ */
+typedef struct {
+    uint8_t  buf[TRNG_FRAME_SIZE(TRNG_FRAME_MAX_PAYLOAD)]; /**< Frame being assembled. */
+    size_t   fill;          /**< Bytes held in buf. */
+    uint32_t nextSeq;       /**< Sequence number expected next. */
+    uint8_t  synced;        /**< 1 once a first valid frame has been seen. */
+    uint32_t seq;           /**< Sequence number of the last frame. */
+    uint8_t  flags;         /**< Health flags of the last frame. */
+    const uint8_t *payload; /**< Payload of the last frame (inside buf). */
+    size_t   payloadLen;    /**< Payload length of the last frame. */
+    uint32_t frames;        /**< Valid frames decoded. */
+    uint32_t crcErrors;     /**< Candidate frames rejected by the CRC. */
+    uint32_t lostFrames;    /**< Frames missing according to sequence numbers. */
+    uint32_t resyncs;       /**< Backward or larger than TRNG_FRAME_MAX_GAP sequence jumps. */
+    uint32_t flagged;       /**< Valid frames with a TRNG_FRAME_FLAG_HEALTH bit set. */
+    uint32_t infoFrames;    /**< Valid TRNG_FRAME_FLAG_INFO frames. */
+    uint32_t skipped;       /**< Bytes discarded while resynchronizing. */
+} trng_frame_decoder;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Update a CRC-32 (IEEE 802.3, reflected) over @p len bytes.
+ *
+ * @param      crc   Previous value; 0 to start a new CRC.
+ * @param      data  Pointer to the bytes.
+ * @param      len   Number of bytes.
+ *
+ * @return  Updated CRC.
+ */
+uint32_t trng_crc32(uint32_t crc, const uint8_t *data, size_t len);
+
+/**
+ * @brief   Run the per-frame health tests on a payload.
+ *
+ * Repetition count test on consecutive 32-bit words, and adaptive
+ * proportion test counting the first byte value over a 256-byte window.
+ * On full-entropy input, a 256-byte payload raises a false alarm with
+ * probability below 2^-25.
+ *
+ * @param      payload  Pointer to the payload.
+ * @param      len      Payload length in bytes.
+ *
+ * @return  Combination of TRNG_FRAME_FLAG_* bits, 0 if all tests pass.
+ */
+uint8_t trng_frameHealth(const uint8_t *payload, size_t len);
+
+/**
+ * @brief   Write header and CRC around a payload already placed at
+ *          @p frame + TRNG_FRAME_HEADER_SIZE.
+ *
+ * @param[in,out] frame  Pointer to at least TRNG_FRAME_SIZE(len) bytes.
+ * @param         seq    Sequence number.
+ * @param         flags  Health flags (TRNG_FRAME_FLAG_*).
+ * @param         len    Payload length (<= TRNG_FRAME_MAX_PAYLOAD).
+ *
+ * @return  Total frame size in bytes, 0 on invalid argument.
+ */
+size_t trng_frameEncode(uint8_t *frame, uint32_t seq, uint8_t flags, size_t len);
+
+/**
+ * @brief   Encode a device information record.
+ *
+ * @param[out] out   Pointer to at least TRNG_INFO_SIZE bytes.
+ * @param      info  Record to encode.
+ */
+void trng_infoEncode(uint8_t *out, const trng_info *info);
+
+/**
+ * @brief   Decode a device information record.
+ *
+ * @param[out] info  Decoded record.
+ * @param      in    Pointer to the frame payload.
+ * @param      len   Payload length.
+ *
+ * @retval  0   Success.
+ * @retval  1   Payload too short or null pointer.
+ */
+uint8_t trng_infoDecode(trng_info *info, const uint8_t *in, size_t len);
+
+/**
+ * @brief   Reset a decoder.
+ *
+ * @param[out] d  Pointer to the decoder.
+ */
+void trng_frameDecoderInit(trng_frame_decoder *d);
+
+/**
+ * @brief   Feed raw bytes to the decoder until a frame completes.
+ *
+ * Stops as soon as a valid frame is available and sets @p ready; the
+ * frame fields of @p d stay valid until the next call. Call again with the
+ * remaining bytes to continue.
+ *
+ * @param[in,out] d      Pointer to the decoder.
+ * @param         data   Pointer to the received bytes.
+ * @param         len    Number of received bytes.
+ * @param[out]    ready  Set to 1 when a frame is available, 0 otherwise.
+ *
+ * @return  Number of bytes consumed from @p data.
+ */
+size_t trng_frameFeed(trng_frame_decoder *d, const uint8_t *data, size_t len, uint8_t *ready);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRNG_FRAME_H */
@@ -0,0 +1,130 @@
+/*******************************************************************************
+ * @file    trng_mask.c
+ * @brief   Precomputed 32-bit mask stream for masked cipher implementations.
+ *
+ * The only hardware dependency is trng_read128(), so the module builds on
+ * a host with a stand-in for that function.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_mask.h"
+
+/**
+ * @brief  Initialize a context on caller storage.
+ * @param[out] m        Context.
+ * @param      storage  Ring storage.
+ * @param      size     Ring size in words, a power of two >= 4.
+ * @param      reserve  Low-level threshold, at most @p size.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Null pointer or invalid size or reserve.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_maskInit(trng_mask *m, uint32_t *storage, uint32_t size, uint32_t reserve) {
+    uint8_t result = TRNG_NOK;
+
+    if ((m != NULL) && (storage != NULL) && (size >= 4U) && ((size & (size - 1U)) == 0U) &&
+        (reserve <= size)) {
+        m->ring = storage;
+        m->size = size;
+        m->reserve = reserve;
+        trng_maskFree(m);
+        result = TRNG_OK;
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Append whole hardware blocks while four words fit.
+ * @param  m          Context.
+ * @param  maxBlocks  Block limit, 0 for none.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_maskRefill(trng_mask *m, uint32_t maxBlocks) {
+    uint8_t result = TRNG_NOK;
+
+    if ((m != NULL) && (m->ring != NULL)) {
+        uint32_t head = m->head;
+        uint32_t level = head - m->tail;
+        uint32_t blocks = 0U;
+        result = TRNG_OK;
+
+        /* The ring is expected to be empty until the first mask is taken. */
+        if ((m->tail != 0U) && (level < m->lowWater)) {
+            m->lowWater = level;
+        }
+        /* head only moves in steps of 4 and size is a multiple of 4, so a
+           block never wraps inside the ring. */
+        while ((result == TRNG_OK) && ((m->size - (head - m->tail)) >= 4U) &&
+               ((maxBlocks == 0U) || (blocks < maxBlocks))) {
+            uint32_t block[4U];
+            result = trng_read128(block);
+            if (result == TRNG_OK) {
+                uint32_t i = head & (m->size - 1U);
+                uint32_t k;
+                for (k = 0U; k < 4U; k++) {
+                    m->ring[i + k] = block[k];
+                    block[k] = 0U;
+                }
+                head += 4U;
+                /* Publish only once the words are stored. */
+                m->head = head;
+                blocks++;
+            } else {
+                m->failures++;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Read one mask from the hardware for an empty ring.
+ * @param      m    Context.
+ * @param[out] out  The mask, 0 on failure.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_maskUnderflow(trng_mask *m, uint32_t *out) {
+    uint32_t block[4U] = { 0U, 0U, 0U, 0U };
+    uint8_t result = TRNG_NOK;
+
+    if ((m != NULL) && (out != NULL)) {
+        m->underflows++;
+        result = trng_read128(block);
+        if (result != TRNG_OK) {
+            m->failures++;
+            block[0] = 0U;
+        }
+        *out = block[0];
+        block[0] = 0U;
+        block[1] = 0U;
+        block[2] = 0U;
+        block[3] = 0U;
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Wipe the ring and reset the counters.
+ * @param  m  Context.
+ */
+// cppcheck-suppress unusedFunction
+void trng_maskFree(trng_mask *m) {
+    if ((m != NULL) && (m->ring != NULL)) {
+        uint32_t i;
+        for (i = 0U; i < m->size; i++) {
+            m->ring[i] = 0U;
+        }
+        m->head = 0U;
+        m->tail = 0U;
+        m->underflows = 0U;
+        m->failures = 0U;
+        m->lowWater = m->size;
+    }
+}
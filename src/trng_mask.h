@@ -0,0 +1,183 @@
+/*******************************************************************************
+ * @file    trng_mask.h
+ * @brief   Precomputed 32-bit mask stream for masked cipher implementations.
+ *
+ * A masked AES draws a fresh mask every few hundred cycles. One
+ * trng_random32() per mask costs an SCE5 block read at an unpredictable
+ * moment. A trng_mask context instead keeps hardware words in a ring in
+ * caller storage:
+ * - trng_maskNext() is inline and takes a mask from the ring in a fixed,
+ *   short sequence of loads and stores, with no call and no hardware
+ *   access;
+ * - trng_maskRefill() tops the ring up in whole 128-bit blocks. Call it
+ *   in the background, from loop(), an idle hook or a periodic timer
+ *   interrupt, whenever trng_maskLow() reports fewer than the configured
+ *   reserve of masks.
+ *
+ * The ring is single-producer, single-consumer. Refill may run in an
+ * interrupt that preempts the consumer, or the other way round, without
+ * a lock. An empty ring is an underflow: the mask is then read from the
+ * hardware in the consumer, which is slow, and counted in @c underflows.
+ * Size the ring and the reserve so that this count stays at zero.
+ *
+ * With refill in a timer interrupt, the interrupt can preempt any other
+ * SCE5 user on the main path: trng_maskUnderflow(), TRNG.random32(),
+ * trng_fillRandom(), writeTo() or the frame export. All of them read the
+ * hardware through trng_read128(), which does not re-enter the hardware
+ * read: a refill that preempts a read gets TRNG_NOK, stops and counts a
+ * failure, and the next tick tops the ring up. The reverse case, a
+ * consumer in an interrupt that preempts a refill on the main path, finds
+ * the hardware busy if the ring is empty: trng_maskNext() then fails and
+ * hands out no mask, so check its result, and keep the consumer at the
+ * refill priority or below. The word-level pool behind TRNG.random32()
+ * and friends is not re-entrant at all: do not call those from the refill
+ * interrupt.
+ *
+ * @code
+ *   #include <trng.h>
+ *   #include <trng_mask.h>
+ *
+ *   static uint32_t maskRing[256];
+ *   static trng_mask masks;
+ *
+ *   void setup() {
+ *       TRNG.begin();
+ *       (void)trng_maskInit(&masks, maskRing, 256U, 64U);
+ *   }
+ *
+ *   void loop() {
+ *       if (trng_maskLow(&masks) != 0U) {
+ *           (void)trng_maskRefill(&masks, 0U);
+ *       }
+ *       uint32_t m;
+ *       if (trng_maskNext(&masks, &m) != 0U) {
+ *           ... abort the masked operation: no mask is available
+ *       }
+ *       ...
+ *   }
+ * @endcode
+ *
+ * The only hardware dependency is trng_read128().
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_MASK_H
+#define TRNG_MASK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "trng.h"
+
+/** @brief Mask ring state. The indices run freely and wrap at 2^32. */
+typedef struct {
+    volatile uint32_t *ring;            /**< Caller storage, @c size words. */
+    uint32_t size;                      /**< Ring size in words (power of two, at least 4). */
+    uint32_t reserve;                   /**< Level below which trng_maskLow() is true. */
+    volatile uint32_t head;             /**< Next word written by refill. */
+    volatile uint32_t tail;             /**< Next word taken by the consumer. */
+    volatile uint32_t underflows;       /**< Masks read from the hardware because the ring was empty. */
+    volatile uint32_t failures;         /**< Hardware reads that failed (underflow or refill). */
+    uint32_t lowWater;                  /**< Fewest words a refill found once masks were taken. */
+} trng_mask;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Initialize a context on caller storage. The ring starts empty.
+ *
+ * @param[out] m        Context.
+ * @param      storage  Ring storage of @p size words, used only through
+ *                      @p m from then on.
+ * @param      size     Ring size in words: a power of two, at least 4.
+ * @param      reserve  Masks to keep available; trng_maskLow() is true
+ *                      below it. At most @p size.
+ *
+ * @retval  0   Success.
+ * @retval  1   Null pointer or invalid size or reserve.
+ */
+uint8_t trng_maskInit(trng_mask *m, uint32_t *storage, uint32_t size, uint32_t reserve);
+
+/**
+ * @brief   Add hardware blocks to the ring (producer side).
+ *
+ * @param   m          Context.
+ * @param   maxBlocks  Most 128-bit blocks to read, to bound the time spent
+ *                     in an interrupt; 0 to fill the ring.
+ *
+ * @retval  0   Success (also when the ring was already full).
+ * @retval  1   Read failed, not initialized, or null pointer; the blocks
+ *              read before the failure are kept.
+ */
+uint8_t trng_maskRefill(trng_mask *m, uint32_t maxBlocks);
+
+/**
+ * @brief   Mask read from the hardware when the ring is empty, called by
+ *          trng_maskNext(). Counts the underflow.
+ *
+ * @param      m    Context.
+ * @param[out] out  The mask; 0 on failure, which is not a mask.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed (counted in @c failures), e.g. because the
+ *              call preempted a refill, or null pointer.
+ */
+uint8_t trng_maskUnderflow(trng_mask *m, uint32_t *out);
+
+/**
+ * @brief   Wipe the ring and reset the context to empty.
+ */
+void trng_maskFree(trng_mask *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @brief   Number of masks in the ring.
+ */
+static inline uint32_t trng_maskAvailable(const trng_mask *m) {
+    return m->head - m->tail;
+}
+
+/**
+ * @brief   1 when fewer than the reserve of masks are available and the
+ *          ring should be refilled, else 0.
+ */
+static inline uint8_t trng_maskLow(const trng_mask *m) {
+    return ((m->head - m->tail) < m->reserve) ? 1U : 0U;
+}
+
+/**
+ * @brief   Next mask (consumer side). The slot is wiped once taken.
+ *
+ * The result must be checked: with an empty ring whose hardware read
+ * fails, there is no mask, and masking with the 0 left in @p out would
+ * leave the data unmasked.
+ *
+ * @param      m    Context.
+ * @param[out] out  A random word from the ring, or from
+ *                  trng_maskUnderflow() if the ring is empty; 0 on
+ *                  failure.
+ *
+ * @retval  0   Success.
+ * @retval  1   The ring was empty and the hardware read failed.
+ */
+static inline uint8_t trng_maskNext(trng_mask *m, uint32_t *out) {
+    uint32_t tail = m->tail;
+    uint8_t result = TRNG_OK;
+
+    if (tail != m->head) {
+        uint32_t i = tail & (m->size - 1U);
+        *out = m->ring[i];
+        m->ring[i] = 0U;
+        m->tail = tail + 1U;
+    } else {
+        result = trng_maskUnderflow(m, out);
+    }
+
+    return result;
+}
+
+#endif /* TRNG_MASK_H */
@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * @file    trng_mbedtls.c
+ * @brief   mbedTLS entropy source backed by a prebuffered TRNG pool.
+ *
+ * The only hardware dependency is trng_read128(), so the module builds
+ * without mbedTLS and on a host with a stand-in for that function.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_mbedtls.h"
+
+/**
+ * @brief  Move the unread bytes to the front, then append hardware blocks
+ *         until at least @p want bytes are buffered or no block fits.
+ * @retval TRNG_OK   @p want bytes are buffered.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ */
+static uint8_t trng_mbedtlsFill(trng_mbedtls *ctx, size_t want) {
+    size_t i;
+    uint8_t result = TRNG_OK;
+
+    if (ctx->pos != 0U) {
+        for (i = ctx->pos; i < ctx->end; i++) {
+            ctx->buf[i - ctx->pos] = ctx->buf[i];
+            ctx->buf[i] = 0U;
+        }
+        ctx->end -= ctx->pos;
+        ctx->pos = 0U;
+    }
+
+    while ((result == TRNG_OK) && (ctx->end < want) && ((ctx->end + 16U) <= TRNG_MBEDTLS_BUFFER)) {
+        uint32_t block[4U];
+        result = trng_read128(block);
+        if (result == TRNG_OK) {
+            const uint8_t *src = (const uint8_t *)block;
+            for (i = 0U; i < 16U; i++) {
+                ctx->buf[ctx->end] = src[i];
+                ctx->end++;
+            }
+            for (i = 0U; i < 4U; i++) {
+                block[i] = 0U;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Initialize an empty context.
+ * @param[out] ctx    Context.
+ * @param      chunk  Bytes per poll, 0 for the default.
+ */
+// cppcheck-suppress unusedFunction
+void trng_mbedtlsInit(trng_mbedtls *ctx, size_t chunk) {
+    if (ctx != NULL) {
+        size_t i;
+        for (i = 0U; i < TRNG_MBEDTLS_BUFFER; i++) {
+            ctx->buf[i] = 0U;
+        }
+        ctx->pos = 0U;
+        ctx->end = 0U;
+        ctx->chunk = (chunk == 0U) ? TRNG_MBEDTLS_CHUNK : chunk;
+        if (ctx->chunk > (TRNG_MBEDTLS_BUFFER - 16U)) {
+            ctx->chunk = TRNG_MBEDTLS_BUFFER - 16U;
+        }
+        ctx->polls = 0U;
+        ctx->hwPolls = 0U;
+    }
+}
+
+/**
+ * @brief  Fill the buffer completely.
+ * @param  ctx  Context.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_mbedtlsRefill(trng_mbedtls *ctx) {
+    uint8_t result = TRNG_NOK;
+
+    if (ctx != NULL) {
+        result = trng_mbedtlsFill(ctx, TRNG_MBEDTLS_BUFFER);
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Number of bytes buffered.
+ * @param  ctx  Context.
+ * @return Buffered bytes, 0 for a null pointer.
+ */
+// cppcheck-suppress unusedFunction
+size_t trng_mbedtlsAvailable(const trng_mbedtls *ctx) {
+    return (ctx != NULL) ? (ctx->end - ctx->pos) : 0U;
+}
+
+/**
+ * @brief  mbedTLS entropy source callback.
+ * @param      data    Context.
+ * @param[out] output  Destination.
+ * @param      len     Maximum number of bytes.
+ * @param[out] olen    Number of bytes written.
+ * @retval 0                               Success.
+ * @retval TRNG_MBEDTLS_ERR_SOURCE_FAILED  Read failed or null pointer.
+ */
+// cppcheck-suppress unusedFunction
+int trng_mbedtlsPoll(void *data, unsigned char *output, size_t len, size_t *olen) {
+    int result = TRNG_MBEDTLS_ERR_SOURCE_FAILED;
+    trng_mbedtls *ctx = (trng_mbedtls *)data;
+
+    if ((ctx != NULL) && (output != NULL) && (olen != NULL)) {
+        size_t n = (len < ctx->chunk) ? len : ctx->chunk;
+        uint8_t ok = TRNG_OK;
+
+        *olen = 0U;
+        if ((ctx->end - ctx->pos) < n) {
+            ctx->hwPolls++;
+            ok = trng_mbedtlsFill(ctx, n);
+        }
+        if (ok == TRNG_OK) {
+            size_t i;
+            for (i = 0U; i < n; i++) {
+                output[i] = ctx->buf[ctx->pos];
+                ctx->buf[ctx->pos] = 0U;
+                ctx->pos++;
+            }
+            ctx->polls++;
+            *olen = n;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Wipe the buffer.
+ * @param  ctx  Context.
+ */
+// cppcheck-suppress unusedFunction
+void trng_mbedtlsFree(trng_mbedtls *ctx) {
+    if (ctx != NULL) {
+        trng_mbedtlsInit(ctx, ctx->chunk);
+    }
+}
@@ -0,0 +1,186 @@
+/*******************************************************************************
+ * @file    trng_mbedtls.h
+ * @brief   mbedTLS entropy source backed by a prebuffered TRNG pool.
+ *
+ * mbedtls_entropy_func() polls every source with up to
+ * MBEDTLS_ENTROPY_MAX_GATHER (128) bytes until each strong source has
+ * reached its threshold and 64 strong bytes were gathered. A callback that
+ * reads the hardware for every poll puts SCE5 reads on the critical path of
+ * every DRBG seed or reseed, and so of TLS handshakes.
+ *
+ * trng_mbedtlsPoll() instead serves each poll from a buffer in the context,
+ * and returns only @p chunk bytes per poll (64 by default, what one
+ * entropy_func() call needs). The buffer is topped up outside the
+ * handshake with trng_mbedtlsRefill(), e.g. from loop(); a poll only reads
+ * the hardware for the bytes the buffer lacks. Served bytes are wiped.
+ *
+ * The module needs no mbedTLS header. With mbedtls/entropy.h (and
+ * mbedtls/ctr_drbg.h) included before this header, the helpers
+ * trng_mbedtlsAddSource() and trng_mbedtlsSeedDrbg() are also available:
+ *
+ * @code
+ *   #include <mbedtls/entropy.h>
+ *   #include <mbedtls/ctr_drbg.h>
+ *   #include <trng_mbedtls.h>
+ *
+ *   static trng_mbedtls src;
+ *   static mbedtls_entropy_context entropy;
+ *   static mbedtls_ctr_drbg_context drbg;
+ *
+ *   void setup() {
+ *       TRNG.begin();
+ *       trng_mbedtlsInit(&src, 0U);
+ *       (void)trng_mbedtlsRefill(&src);
+ *       mbedtls_entropy_init(&entropy);
+ *       mbedtls_ctr_drbg_init(&drbg);
+ *       trng_mbedtlsSeedDrbg(&drbg, &entropy, &src, NULL, 0U);
+ *   }
+ *
+ *   void loop() {
+ *       (void)trng_mbedtlsRefill(&src);
+ *   }
+ * @endcode
+ *
+ * For builds with MBEDTLS_ENTROPY_HARDWARE_ALT, define
+ * TRNG_MBEDTLS_HARDWARE_POLL before including this header in one file to
+ * get mbedtls_hardware_poll() on a context of its own,
+ * trng_mbedtlsHardware, which that file can refill.
+ *
+ * @note    A context is not thread-safe. Poll it only through one
+ *          mbedtls_entropy_context, which serializes its sources, and
+ *          refill it from the same thread or under the same lock.
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_MBEDTLS_H
+#define TRNG_MBEDTLS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "trng.h"
+
+#ifndef TRNG_MBEDTLS_BUFFER
+/** @brief Bytes buffered per context (at least 32). */
+#define TRNG_MBEDTLS_BUFFER     256U
+#endif
+
+/** @brief Default bytes returned per poll: the SHA-512 accumulator block. */
+#define TRNG_MBEDTLS_CHUNK      64U
+
+/** @brief Default threshold passed to mbedtls_entropy_add_source(). */
+#define TRNG_MBEDTLS_THRESHOLD  32U
+
+/** @brief Value of MBEDTLS_ERR_ENTROPY_SOURCE_FAILED. */
+#define TRNG_MBEDTLS_ERR_SOURCE_FAILED  (-0x003C)
+
+/** @brief Prebuffered entropy source state. */
+typedef struct {
+    uint8_t  buf[TRNG_MBEDTLS_BUFFER];         /**< Bytes [pos, end) are unread. */
+    size_t   pos;                               /**< First unread byte. */
+    size_t   end;                               /**< End of the unread bytes. */
+    size_t   chunk;                             /**< Bytes returned per poll. */
+    uint32_t polls;                             /**< Polls served. */
+    uint32_t hwPolls;                           /**< Polls that had to read the hardware. */
+} trng_mbedtls;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Initialize an empty context.
+ *
+ * @param[out] ctx    Context.
+ * @param      chunk  Bytes returned per poll, 0 for TRNG_MBEDTLS_CHUNK.
+ *                    Capped at TRNG_MBEDTLS_BUFFER - 16.
+ */
+void trng_mbedtlsInit(trng_mbedtls *ctx, size_t chunk);
+
+/**
+ * @brief   Fill the buffer completely. Call it when the TRNG is idle.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, or null pointer; the bytes
+ *              read before the failure are kept.
+ */
+uint8_t trng_mbedtlsRefill(trng_mbedtls *ctx);
+
+/**
+ * @brief   Number of bytes buffered.
+ */
+size_t trng_mbedtlsAvailable(const trng_mbedtls *ctx);
+
+/**
+ * @brief   mbedTLS entropy source callback (mbedtls_entropy_f_source_ptr).
+ *
+ * Writes min(@p len, chunk) bytes, reading the hardware only for the part
+ * the buffer lacks.
+ *
+ * @param      data    Context (trng_mbedtls *).
+ * @param[out] output  Destination.
+ * @param      len     Maximum number of bytes.
+ * @param[out] olen    Number of bytes written.
+ *
+ * @retval  0                               Success.
+ * @retval  TRNG_MBEDTLS_ERR_SOURCE_FAILED  Read failed or null pointer.
+ */
+int trng_mbedtlsPoll(void *data, unsigned char *output, size_t len, size_t *olen);
+
+/**
+ * @brief   Wipe the buffer.
+ */
+void trng_mbedtlsFree(trng_mbedtls *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef MBEDTLS_ENTROPY_H
+/**
+ * @brief   Register @p ctx as a strong source of @p entropy.
+ *
+ * @return  0, or the error of mbedtls_entropy_add_source().
+ */
+static inline int trng_mbedtlsAddSource(mbedtls_entropy_context *entropy, trng_mbedtls *ctx) {
+    return mbedtls_entropy_add_source(entropy, trng_mbedtlsPoll, ctx, TRNG_MBEDTLS_THRESHOLD,
+                                      MBEDTLS_ENTROPY_SOURCE_STRONG);
+}
+
+#ifdef MBEDTLS_CTR_DRBG_H
+/**
+ * @brief   Register @p ctx with @p entropy and seed @p drbg from it.
+ *
+ * Both contexts must have been initialized.
+ *
+ * @return  0, or the error of mbedtls_entropy_add_source() or
+ *          mbedtls_ctr_drbg_seed().
+ */
+static inline int trng_mbedtlsSeedDrbg(mbedtls_ctr_drbg_context *drbg, mbedtls_entropy_context *entropy,
+                                       trng_mbedtls *ctx, const unsigned char *pers, size_t persLen) {
+    int ret = trng_mbedtlsAddSource(entropy, ctx);
+
+    if (ret == 0) {
+        ret = mbedtls_ctr_drbg_seed(drbg, mbedtls_entropy_func, entropy, pers, persLen);
+    }
+
+    return ret;
+}
+#endif /* MBEDTLS_CTR_DRBG_H */
+#endif /* MBEDTLS_ENTROPY_H */
+
+#ifdef TRNG_MBEDTLS_HARDWARE_POLL
+/** @brief Context behind mbedtls_hardware_poll(). */
+static trng_mbedtls trng_mbedtlsHardware = { { 0U }, 0U, 0U, TRNG_MBEDTLS_CHUNK, 0U, 0U };
+
+#ifdef __cplusplus
+extern "C"
+#endif
+/**
+ * @brief   Entropy hook of MBEDTLS_ENTROPY_HARDWARE_ALT.
+ */
+int mbedtls_hardware_poll(void *data, unsigned char *output, size_t len, size_t *olen) {
+    (void)data;
+    return trng_mbedtlsPoll(&trng_mbedtlsHardware, output, len, olen);
+}
+#endif /* TRNG_MBEDTLS_HARDWARE_POLL */
+
+#endif /* TRNG_MBEDTLS_H */
@@ -0,0 +1,95 @@
+/*******************************************************************************
+ * @file    trng_philox.c
+ * @brief   Philox4x32-10 counter-based generator keyed by the TRNG.
+ *
+ * Portable scalar implementation. Depends only on the C standard library.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_philox.h"
+
+/** @brief Round multipliers. */
+#define PHILOX_M0   0xD2511F53UL
+#define PHILOX_M1   0xCD9E8D57UL
+/** @brief Key schedule increments (golden ratio, sqrt(3) - 1). */
+#define PHILOX_W0   0x9E3779B9UL
+#define PHILOX_W1   0xBB67AE85UL
+/** @brief Number of rounds. */
+#define PHILOX_ROUNDS   10U
+
+/**
+ * @brief  Compute one 128-bit block.
+ * @param  p      Key and stream.
+ * @param  block  Block index.
+ * @param  out    Four words.
+ */
+// cppcheck-suppress unusedFunction
+void trng_philoxBlock(const trng_philox *p, uint64_t block, uint32_t *out) {
+    if ((p != NULL) && (out != NULL)) {
+        uint32_t c0 = (uint32_t)block;
+        uint32_t c1 = (uint32_t)(block >> 32U);
+        uint32_t c2 = p->stream[0U];
+        uint32_t c3 = p->stream[1U];
+        uint32_t k0 = p->key[0U];
+        uint32_t k1 = p->key[1U];
+        uint8_t r;
+
+        for (r = 0U; r < PHILOX_ROUNDS; r++) {
+            uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+            uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+            c0 = (uint32_t)(p1 >> 32U) ^ c1 ^ k0;
+            c2 = (uint32_t)(p0 >> 32U) ^ c3 ^ k1;
+            c1 = (uint32_t)p1;
+            c3 = (uint32_t)p0;
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+        out[0U] = c0;
+        out[1U] = c1;
+        out[2U] = c2;
+        out[3U] = c3;
+    }
+}
+
+/**
+ * @brief  Compute a range of words of a stream.
+ * @param  p      Key and stream.
+ * @param  index  Index of the first word.
+ * @param  out    Destination.
+ * @param  words  Number of words.
+ */
+// cppcheck-suppress unusedFunction
+void trng_philoxFill(const trng_philox *p, uint64_t index, uint32_t *out, size_t words) {
+    if ((p != NULL) && (out != NULL)) {
+        uint64_t block = index >> 2U;
+        size_t skip = (size_t)(index & 3U);
+        size_t done = 0U;
+
+        while (done < words) {
+            uint32_t buf[4U];
+            size_t i;
+            trng_philoxBlock(p, block, buf);
+            for (i = skip; (i < 4U) && (done < words); i++) {
+                out[done] = buf[i];
+                done++;
+            }
+            skip = 0U;
+            block++;
+        }
+    }
+}
+
+/**
+ * @brief  Compute one word of a stream.
+ * @param  p      Key and stream.
+ * @param  index  Word index.
+ * @return The word, 0 for a null pointer.
+ */
+// cppcheck-suppress unusedFunction
+uint32_t trng_philoxAt(const trng_philox *p, uint64_t index) {
+    uint32_t buf[4U] = { 0U, 0U, 0U, 0U };
+
+    trng_philoxBlock(p, index >> 2U, buf);
+
+    return buf[index & 3U];
+}
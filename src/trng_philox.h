@@ -0,0 +1,66 @@
+/*******************************************************************************
+ * @file    trng_philox.h
+ * @brief   Philox4x32-10 counter-based generator keyed by the TRNG.
+ *
+ * Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+ * 3", SC 2011) maps a 128-bit counter and a 64-bit key to 128 output bits
+ * through ten multiply-xor rounds. Word i of a stream is word i % 4 of the
+ * block at counter { i / 4, stream }, so any word can be computed without
+ * the ones before it: threads or boards that share a key (from
+ * trng_philoxSeed()) split a stream by index range or take one stream
+ * each, without coordination, and any element can be regenerated later.
+ *
+ * Philox is a statistical generator for simulation and sampling, not a
+ * cryptographic one: use the TRNG functions directly for keys and nonces.
+ *
+ * This module has no hardware dependency and builds unchanged on a host.
+ * The scalar code is what runs on the Cortex-M4 (one UMULL per multiply);
+ * extras/host adds AVX2 and NEON versions with the same output.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_PHILOX_H
+#define TRNG_PHILOX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @brief Generator parameters: the key and the stream it produces. */
+typedef struct {
+    uint32_t key[2U];       /**< 64-bit key. */
+    uint32_t stream[2U];    /**< Upper 64 bits of the counter. */
+} trng_philox;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Compute one 128-bit block.
+ *
+ * @param      p      Key and stream.
+ * @param      block  Block index (lower 64 bits of the counter).
+ * @param[out] out    Four words.
+ */
+void trng_philoxBlock(const trng_philox *p, uint64_t block, uint32_t *out);
+
+/**
+ * @brief   Compute words @p index .. @p index + @p words - 1 of a stream.
+ *
+ * @param      p      Key and stream.
+ * @param      index  Index of the first word.
+ * @param[out] out    Destination, @p words words.
+ * @param      words  Number of words.
+ */
+void trng_philoxFill(const trng_philox *p, uint64_t index, uint32_t *out, size_t words);
+
+/**
+ * @brief   Compute word @p index of a stream.
+ */
+uint32_t trng_philoxAt(const trng_philox *p, uint64_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRNG_PHILOX_H */
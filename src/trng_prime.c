@@ -0,0 +1,645 @@
+/*******************************************************************************
+ * @file    trng_prime.c
+ * @brief   Random probable primes: incremental sieve and Miller-Rabin.
+ *
+ * The only hardware dependency is trng_read128(), so the module builds on
+ * a host with a stand-in for that function.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#include "trng_prime.h"
+
+/** @brief The first TRNG_PRIME_SIEVE odd primes. */
+static const uint16_t _sievePrimes[TRNG_PRIME_SIEVE] = {
+    3U, 5U, 7U, 11U, 13U, 17U, 19U, 23U, 29U, 31U, 37U, 41U, 43U, 47U, 53U, 59U,
+    61U, 67U, 71U, 73U, 79U, 83U, 89U, 97U, 101U, 103U, 107U, 109U, 113U, 127U, 131U, 137U,
+    139U, 149U, 151U, 157U, 163U, 167U, 173U, 179U, 181U, 191U, 193U, 197U, 199U, 211U, 223U, 227U,
+    229U, 233U, 239U, 241U, 251U, 257U, 263U, 269U, 271U, 277U, 281U, 283U, 293U, 307U, 311U, 313U,
+    317U, 331U, 337U, 347U, 349U, 353U, 359U, 367U, 373U, 379U, 383U, 389U, 397U, 401U, 409U, 419U,
+    421U, 431U, 433U, 439U, 443U, 449U, 457U, 461U, 463U, 467U, 479U, 487U, 491U, 499U, 503U, 509U,
+    521U, 523U, 541U, 547U, 557U, 563U, 569U, 571U, 577U, 587U, 593U, 599U, 601U, 607U, 613U, 617U,
+    619U, 631U, 641U, 643U, 647U, 653U, 659U, 661U, 673U, 677U, 683U, 691U, 701U, 709U, 719U, 727U,
+    733U, 739U, 743U, 751U, 757U, 761U, 769U, 773U, 787U, 797U, 809U, 811U, 821U, 823U, 827U, 829U,
+    839U, 853U, 857U, 859U, 863U, 877U, 881U, 883U, 887U, 907U, 911U, 919U, 929U, 937U, 941U, 947U,
+    953U, 967U, 971U, 977U, 983U, 991U, 997U, 1009U, 1013U, 1019U, 1021U, 1031U, 1033U, 1039U, 1049U, 1051U,
+    1061U, 1063U, 1069U, 1087U, 1091U, 1093U, 1097U, 1103U, 1109U, 1117U, 1123U, 1129U, 1151U, 1153U, 1163U, 1171U,
+    1181U, 1187U, 1193U, 1201U, 1213U, 1217U, 1223U, 1229U, 1231U, 1237U, 1249U, 1259U, 1277U, 1279U, 1283U, 1289U,
+    1291U, 1297U, 1301U, 1303U, 1307U, 1319U, 1321U, 1327U, 1361U, 1367U, 1373U, 1381U, 1399U, 1409U, 1423U, 1427U,
+    1429U, 1433U, 1439U, 1447U, 1451U, 1453U, 1459U, 1471U, 1481U, 1483U, 1487U, 1489U, 1493U, 1499U, 1511U, 1523U,
+    1531U, 1543U, 1549U, 1553U, 1559U, 1567U, 1571U, 1579U, 1583U, 1597U, 1601U, 1607U, 1609U, 1613U, 1619U, 1621U,
+};
+
+/**
+ * @brief  Add the clock ticks since @p mark to @p phase and restart the mark.
+ */
+static void trng_primeLap(const trng_prime *ctx, uint32_t *phase, uint32_t *mark) {
+    if (ctx->clock != NULL) {
+        uint32_t now = ctx->clock();
+        *phase += now - *mark;
+        *mark = now;
+    }
+}
+
+/**
+ * @brief  Compare two @p w-word numbers.
+ * @return -1, 0 or 1.
+ */
+static int32_t trng_primeCmp(const uint32_t *a, const uint32_t *b, size_t w) {
+    int32_t result = 0;
+    size_t i = w;
+
+    while ((result == 0) && (i > 0U)) {
+        i--;
+        if (a[i] != b[i]) {
+            result = (a[i] < b[i]) ? -1 : 1;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  r = a - b over @p w words (r may alias a or b).
+ * @return Borrow out.
+ */
+static uint32_t trng_primeSub(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t w) {
+    uint32_t borrow = 0U;
+    size_t i;
+
+    for (i = 0U; i < w; i++) {
+        uint64_t d = (uint64_t)a[i] - b[i] - borrow;
+        r[i] = (uint32_t)d;
+        borrow = (uint32_t)((d >> 32U) & 1U);
+    }
+
+    return borrow;
+}
+
+/**
+ * @brief  x = 2x over @p w words.
+ * @return Bit shifted out.
+ */
+static uint32_t trng_primeDouble(uint32_t *x, size_t w) {
+    uint32_t carry = 0U;
+    size_t i;
+
+    for (i = 0U; i < w; i++) {
+        uint32_t next = x[i] >> 31U;
+        x[i] = (x[i] << 1U) | carry;
+        carry = next;
+    }
+
+    return carry;
+}
+
+/**
+ * @brief  Bit @p i of @p x.
+ */
+static uint32_t trng_primeBit(const uint32_t *x, uint32_t i) {
+    return (x[i / 32U] >> (i % 32U)) & 1U;
+}
+
+/**
+ * @brief  Number of significant bits of a @p w-word number.
+ */
+static uint32_t trng_primeBitLength(const uint32_t *x, size_t w) {
+    uint32_t bits = 0U;
+    size_t i = w;
+
+    while ((bits == 0U) && (i > 0U)) {
+        i--;
+        if (x[i] != 0U) {
+            uint32_t v = x[i];
+            bits = (uint32_t)(32U * i);
+            while (v != 0U) {
+                bits++;
+                v >>= 1U;
+            }
+        }
+    }
+
+    return bits;
+}
+
+/**
+ * @brief  Next word of the buffered witness block.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ */
+static uint8_t trng_primeWord(trng_prime *ctx, uint32_t *out) {
+    uint8_t result = TRNG_OK;
+
+    if (ctx->blockPos >= 4U) {
+        result = trng_read128(ctx->block);
+        if (result == TRNG_OK) {
+            ctx->blockPos = 0U;
+        }
+    }
+    if (result == TRNG_OK) {
+        *out = ctx->block[ctx->blockPos];
+        ctx->block[ctx->blockPos] = 0U;
+        ctx->blockPos++;
+    }
+
+    return result;
+}
+
+/**
+ * @brief  r = a * b / R mod n (CIOS Montgomery product), r < n. @p r may
+ *         alias @p a or @p b.
+ */
+static void trng_primeMontMul(trng_prime *ctx, uint32_t *r, const uint32_t *a, const uint32_t *b, size_t w,
+                              uint32_t n0inv) {
+    uint32_t *t = ctx->t;
+    const uint32_t *n = ctx->n;
+    size_t i;
+    size_t j;
+
+    for (i = 0U; i < (w + 2U); i++) {
+        t[i] = 0U;
+    }
+    for (i = 0U; i < w; i++) {
+        uint64_t uv;
+        uint32_t carry = 0U;
+        uint32_t m;
+
+        for (j = 0U; j < w; j++) {
+            uv = ((uint64_t)a[j] * b[i]) + t[j] + carry;
+            t[j] = (uint32_t)uv;
+            carry = (uint32_t)(uv >> 32U);
+        }
+        uv = (uint64_t)t[w] + carry;
+        t[w] = (uint32_t)uv;
+        t[w + 1U] = (uint32_t)(uv >> 32U);
+
+        m = t[0U] * n0inv;
+        uv = ((uint64_t)m * n[0U]) + t[0U];
+        carry = (uint32_t)(uv >> 32U);
+        for (j = 1U; j < w; j++) {
+            uv = ((uint64_t)m * n[j]) + t[j] + carry;
+            t[j - 1U] = (uint32_t)uv;
+            carry = (uint32_t)(uv >> 32U);
+        }
+        uv = (uint64_t)t[w] + carry;
+        t[w - 1U] = (uint32_t)uv;
+        t[w] = t[w + 1U] + (uint32_t)(uv >> 32U);
+    }
+    if ((t[w] != 0U) || (trng_primeCmp(t, n, w) >= 0)) {
+        (void)trng_primeSub(t, t, n, w);
+    }
+    for (i = 0U; i < w; i++) {
+        r[i] = t[i];
+    }
+}
+
+/**
+ * @brief  Montgomery constants of ctx->n: R mod n, -R mod n, R^2 mod n.
+ * @return -n^-1 mod 2^32.
+ */
+static uint32_t trng_primeSetup(trng_prime *ctx, size_t w) {
+    uint32_t inv = ctx->n[0U];
+    size_t i;
+
+    /* Newton: n0 is its own inverse mod 8, each step doubles the bits. */
+    for (i = 0U; i < 4U; i++) {
+        inv *= 2U - (ctx->n[0U] * inv);
+    }
+    for (i = 0U; i < w; i++) {
+        ctx->r2[i] = 0U;
+    }
+    ctx->r2[0U] = 1U;
+    for (i = 0U; i < (64U * w); i++) {
+        if ((trng_primeDouble(ctx->r2, w) != 0U) || (trng_primeCmp(ctx->r2, ctx->n, w) >= 0)) {
+            (void)trng_primeSub(ctx->r2, ctx->r2, ctx->n, w);
+        }
+        if (i == ((32U * w) - 1U)) {
+            size_t k;
+            for (k = 0U; k < w; k++) {
+                ctx->one[k] = ctx->r2[k];
+            }
+        }
+    }
+    (void)trng_primeSub(ctx->minusOne, ctx->n, ctx->one, w);
+
+    return 0U - inv;
+}
+
+/**
+ * @brief  Uniform witness in [2, n - 2] into ctx->a, from the buffered block.
+ *         Only the top word is redrawn while above that of n - 3.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ */
+static uint8_t trng_primeWitness(trng_prime *ctx, size_t w) {
+    uint32_t *m = ctx->x;
+    uint32_t three[TRNG_PRIME_MAX_WORDS];
+    uint8_t result = TRNG_OK;
+    uint8_t done = 0U;
+    uint32_t top;
+    uint32_t k;
+    size_t i;
+
+    for (i = 0U; i < w; i++) {
+        three[i] = 0U;
+    }
+    three[0U] = 3U;
+    /* m = n - 3 >= 2, drawn below, then shifted up by 2. */
+    (void)trng_primeSub(m, ctx->n, three, w);
+    k = trng_primeBitLength(m, w);
+    top = (k - 1U) / 32U;
+    k -= 32U * top;
+
+    while ((result == TRNG_OK) && (done == 0U)) {
+        uint32_t v = 0U;
+        int32_t cmp = 0;
+
+        for (i = 0U; (result == TRNG_OK) && (i < top); i++) {
+            result = trng_primeWord(ctx, &ctx->a[i]);
+        }
+        do {
+            if (result == TRNG_OK) {
+                result = trng_primeWord(ctx, &v);
+                v >>= 32U - k;
+            }
+        } while ((result == TRNG_OK) && (v > m[top]));
+
+        if (result == TRNG_OK) {
+            ctx->a[top] = v;
+            for (i = top + 1U; i < w; i++) {
+                ctx->a[i] = 0U;
+            }
+            cmp = trng_primeCmp(ctx->a, m, w);
+            done = (uint8_t)((cmp < 0) ? 1U : 0U);
+        }
+    }
+    if (result == TRNG_OK) {
+        uint64_t carry = 2U;
+        for (i = 0U; i < w; i++) {
+            carry += ctx->a[i];
+            ctx->a[i] = (uint32_t)carry;
+            carry >>= 32U;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Miller-Rabin on ctx->n (odd, at least 5) with @p rounds random
+ *         witnesses.
+ * @retval TRNG_OK   Success; @p isPrime is set.
+ * @retval TRNG_NOK  Read failed or not initialized.
+ */
+static uint8_t trng_primeMillerRabin(trng_prime *ctx, size_t w, uint32_t rounds, uint8_t *isPrime) {
+    uint32_t n0inv = trng_primeSetup(ctx, w);
+    uint32_t nbits = trng_primeBitLength(ctx->n, w);
+    uint32_t s = 1U;
+    uint8_t result = TRNG_OK;
+    uint8_t prime = 1U;
+    uint32_t r;
+
+    while (trng_primeBit(ctx->n, s) == 0U) {
+        s++;
+    }
+    for (r = 0U; (result == TRNG_OK) && (prime != 0U) && (r < rounds); r++) {
+        result = trng_primeWitness(ctx, w);
+        if (result == TRNG_OK) {
+            uint8_t pass = 0U;
+            uint32_t i;
+            size_t k;
+
+            ctx->stats.rounds++;
+            trng_primeMontMul(ctx, ctx->a, ctx->a, ctx->r2, w, n0inv);
+            for (k = 0U; k < w; k++) {
+                ctx->x[k] = ctx->one[k];
+            }
+            /* x = a^d with d = (n - 1) / 2^s: the bits of n from the top down to s. */
+            for (i = nbits; i > s; i--) {
+                trng_primeMontMul(ctx, ctx->x, ctx->x, ctx->x, w, n0inv);
+                if (trng_primeBit(ctx->n, i - 1U) != 0U) {
+                    trng_primeMontMul(ctx, ctx->x, ctx->x, ctx->a, w, n0inv);
+                }
+            }
+            if ((trng_primeCmp(ctx->x, ctx->one, w) == 0) || (trng_primeCmp(ctx->x, ctx->minusOne, w) == 0)) {
+                pass = 1U;
+            }
+            for (i = 1U; (pass == 0U) && (i < s); i++) {
+                trng_primeMontMul(ctx, ctx->x, ctx->x, ctx->x, w, n0inv);
+                if (trng_primeCmp(ctx->x, ctx->minusOne, w) == 0) {
+                    pass = 1U;
+                } else if (trng_primeCmp(ctx->x, ctx->one, w) == 0) {
+                    i = s;
+                } else {
+                    /* Keep squaring. */
+                }
+            }
+            prime = pass;
+        }
+    }
+    *isPrime = prime;
+
+    return result;
+}
+
+/**
+ * @brief  ctx->residues[i] = x mod (i-th sieve prime), for the first @p count primes.
+ */
+static void trng_primeResidues(trng_prime *ctx, const uint32_t *x, size_t w, uint16_t count) {
+    uint16_t p;
+
+    for (p = 0U; p < count; p++) {
+        uint32_t q = _sievePrimes[p];
+        uint32_t rem = 0U;
+        size_t i = w;
+        while (i > 0U) {
+            i--;
+            rem = ((rem << 16U) | (x[i] >> 16U)) % q;
+            rem = ((rem << 16U) | (x[i] & 0xFFFFU)) % q;
+        }
+        ctx->residues[p] = (uint16_t)rem;
+    }
+}
+
+/**
+ * @brief  Zero the first @p w words of the number workspace and the residues.
+ */
+static void trng_primeClear(trng_prime *ctx, size_t w) {
+    size_t i;
+
+    for (i = 0U; i < w; i++) {
+        ctx->base[i] = 0U;
+        ctx->n[i] = 0U;
+        ctx->x[i] = 0U;
+        ctx->a[i] = 0U;
+        ctx->one[i] = 0U;
+        ctx->minusOne[i] = 0U;
+        ctx->r2[i] = 0U;
+    }
+    for (i = 0U; i < (w + 2U); i++) {
+        ctx->t[i] = 0U;
+    }
+    for (i = 0U; i < TRNG_PRIME_SIEVE; i++) {
+        ctx->residues[i] = 0U;
+    }
+}
+
+/**
+ * @brief  Initialize a context.
+ * @param[out] ctx          Context.
+ * @param      sievePrimes  Number of sieve primes.
+ * @param      clock        Phase clock, or NULL.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Null pointer or @p sievePrimes too large.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_primeInit(trng_prime *ctx, uint16_t sievePrimes, trng_primeClock clock) {
+    uint8_t result = TRNG_NOK;
+
+    if ((ctx != NULL) && (sievePrimes <= TRNG_PRIME_SIEVE)) {
+        uint8_t i;
+        for (i = 0U; i < 4U; i++) {
+            ctx->block[i] = 0U;
+        }
+        ctx->blockPos = 4U;
+        ctx->sievePrimes = sievePrimes;
+        ctx->clock = clock;
+        trng_primeResetStats(ctx);
+        result = TRNG_OK;
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Default Miller-Rabin rounds for a bit length.
+ * @param  bits  Candidate size.
+ * @return Rounds for an error below 2^-80.
+ */
+// cppcheck-suppress unusedFunction
+uint32_t trng_primeRounds(uint32_t bits) {
+    uint32_t rounds;
+
+    if (bits >= 1300U) {
+        rounds = 2U;
+    } else if (bits >= 850U) {
+        rounds = 3U;
+    } else if (bits >= 650U) {
+        rounds = 4U;
+    } else if (bits >= 550U) {
+        rounds = 5U;
+    } else if (bits >= 450U) {
+        rounds = 6U;
+    } else if (bits >= 400U) {
+        rounds = 7U;
+    } else if (bits >= 350U) {
+        rounds = 8U;
+    } else if (bits >= 300U) {
+        rounds = 9U;
+    } else if (bits >= 250U) {
+        rounds = 12U;
+    } else if (bits >= 200U) {
+        rounds = 15U;
+    } else if (bits >= 150U) {
+        rounds = 18U;
+    } else {
+        rounds = 27U;
+    }
+
+    return rounds;
+}
+
+/**
+ * @brief  Wipe the whole workspace and the buffered witness block.
+ * @param  ctx  Context.
+ */
+// cppcheck-suppress unusedFunction
+void trng_primeWipe(trng_prime *ctx) {
+    if (ctx != NULL) {
+        uint8_t i;
+        trng_primeClear(ctx, TRNG_PRIME_MAX_WORDS);
+        for (i = 0U; i < 4U; i++) {
+            ctx->block[i] = 0U;
+        }
+        ctx->blockPos = 4U;
+    }
+}
+
+/**
+ * @brief  Reset the counters and times.
+ * @param  ctx  Context.
+ */
+// cppcheck-suppress unusedFunction
+void trng_primeResetStats(trng_prime *ctx) {
+    if (ctx != NULL) {
+        ctx->stats.candidates = 0U;
+        ctx->stats.sieved = 0U;
+        ctx->stats.tested = 0U;
+        ctx->stats.rounds = 0U;
+        ctx->stats.primes = 0U;
+        ctx->stats.timeDraw = 0U;
+        ctx->stats.timeSieve = 0U;
+        ctx->stats.timeTest = 0U;
+    }
+}
+
+/**
+ * @brief  Test a number by trial division, then Miller-Rabin.
+ * @param      ctx      Context.
+ * @param      n        Number.
+ * @param      words    Words of @p n.
+ * @param      rounds   Miller-Rabin rounds, 0 for the default.
+ * @param[out] isPrime  1 for a (probable) prime, else 0.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, null pointer or size out of range.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_primeTest(trng_prime *ctx, const uint32_t *n, size_t words, uint32_t rounds, uint8_t *isPrime) {
+    uint8_t result = TRNG_NOK;
+
+    if ((ctx != NULL) && (n != NULL) && (isPrime != NULL) && (words != 0U) && (words <= TRNG_PRIME_MAX_WORDS)) {
+        size_t w = words;
+        uint8_t prime = 1U;
+        uint8_t decided = 0U;
+        uint16_t p;
+        size_t i;
+
+        for (i = 0U; i < words; i++) {
+            ctx->n[i] = n[i];
+        }
+        while ((w > 1U) && (ctx->n[w - 1U] == 0U)) {
+            w--;
+        }
+        result = TRNG_OK;
+
+        if ((w == 1U) && (ctx->n[0U] < 4U)) {
+            prime = (ctx->n[0U] >= 2U) ? 1U : 0U;
+            decided = 1U;
+        } else if ((ctx->n[0U] & 1U) == 0U) {
+            prime = 0U;
+            decided = 1U;
+        } else {
+            trng_primeResidues(ctx, ctx->n, w, TRNG_PRIME_SIEVE);
+            for (p = 0U; (decided == 0U) && (p < TRNG_PRIME_SIEVE); p++) {
+                if (ctx->residues[p] == 0U) {
+                    prime = ((w == 1U) && (ctx->n[0U] == _sievePrimes[p])) ? 1U : 0U;
+                    decided = 1U;
+                }
+            }
+            /* No factor up to 1621 and below 1621^2: prime. */
+            if ((decided == 0U) && (w == 1U) && (ctx->n[0U] < (1621U * 1621U))) {
+                decided = 1U;
+            }
+        }
+        if (decided == 0U) {
+            ctx->stats.tested++;
+            result = trng_primeMillerRabin(ctx, w, (rounds != 0U) ? rounds : trng_primeRounds((uint32_t)(32U * w)),
+                                           &prime);
+        }
+        *isPrime = prime;
+        trng_primeClear(ctx, words);
+    }
+
+    return result;
+}
+
+/**
+ * @brief  Generate a random probable prime of @p bits bits.
+ * @param      ctx     Context.
+ * @param[out] out     Prime.
+ * @param      bits    Bit length.
+ * @param      rounds  Miller-Rabin rounds, 0 for the default.
+ * @retval TRNG_OK   Success.
+ * @retval TRNG_NOK  Read failed, not initialized, null pointer or bit length out of range.
+ */
+// cppcheck-suppress unusedFunction
+uint8_t trng_primeGenerate(trng_prime *ctx, uint32_t *out, uint32_t bits, uint32_t rounds) {
+    uint8_t result = TRNG_NOK;
+
+    if ((ctx != NULL) && (out != NULL) && (bits >= 64U) && (bits <= TRNG_PRIME_MAX_BITS)) {
+        size_t w = (size_t)((bits + 31U) / 32U);
+        uint32_t mr = (rounds != 0U) ? rounds : trng_primeRounds(bits);
+        uint32_t mark = (ctx->clock != NULL) ? ctx->clock() : 0U;
+        uint8_t found = 0U;
+        size_t i;
+        result = TRNG_OK;
+
+        while ((result == TRNG_OK) && (found == 0U)) {
+            uint32_t delta = 0U;
+            uint8_t fresh = 0U;
+
+            /* Draw a candidate in whole blocks. */
+            for (i = 0U; (result == TRNG_OK) && (i < w); i += 4U) {
+                uint32_t block[4U];
+                size_t k;
+                result = trng_read128(block);
+                for (k = 0U; (k < 4U) && ((i + k) < w); k++) {
+                    ctx->base[i + k] = block[k];
+                    block[k] = 0U;
+                }
+            }
+            if (result == TRNG_OK) {
+                uint32_t topBits = bits - (uint32_t)(32U * (w - 1U));
+                if (topBits < 32U) {
+                    ctx->base[w - 1U] &= (1U << topBits) - 1U;
+                }
+                ctx->base[(bits - 1U) / 32U] |= 1U << ((bits - 1U) % 32U);
+                ctx->base[(bits - 2U) / 32U] |= 1U << ((bits - 2U) % 32U);
+                ctx->base[0U] |= 1U;
+                ctx->stats.candidates++;
+                trng_primeResidues(ctx, ctx->base, w, ctx->sievePrimes);
+            }
+            trng_primeLap(ctx, &ctx->stats.timeDraw, &mark);
+
+            /* Walk the odd numbers from the candidate. */
+            while ((result == TRNG_OK) && (found == 0U) && (fresh == 0U)) {
+                uint8_t composite = 0U;
+                uint16_t p;
+
+                for (p = 0U; (composite == 0U) && (p < ctx->sievePrimes); p++) {
+                    composite = (ctx->residues[p] == 0U) ? 1U : 0U;
+                }
+                if (composite != 0U) {
+                    ctx->stats.sieved++;
+                } else {
+                    uint64_t carry = delta;
+                    for (i = 0U; i < w; i++) {
+                        carry += ctx->base[i];
+                        ctx->n[i] = (uint32_t)carry;
+                        carry >>= 32U;
+                    }
+                    if ((carry != 0U) || (trng_primeBitLength(ctx->n, w) != bits)) {
+                        /* Ran past the bit length: draw again. */
+                        fresh = 1U;
+                    } else {
+                        trng_primeLap(ctx, &ctx->stats.timeSieve, &mark);
+                        ctx->stats.tested++;
+                        result = trng_primeMillerRabin(ctx, w, mr, &found);
+                        trng_primeLap(ctx, &ctx->stats.timeTest, &mark);
+                    }
+                }
+                if ((result == TRNG_OK) && (found == 0U) && (fresh == 0U)) {
+                    delta += 2U;
+                    if (delta >= TRNG_PRIME_MAX_DELTA) {
+                        fresh = 1U;
+                    }
+                    for (p = 0U; p < ctx->sievePrimes; p++) {
+                        uint32_t r = (uint32_t)ctx->residues[p] + 2U;
+                        ctx->residues[p] = (uint16_t)((r >= _sievePrimes[p]) ? (r - _sievePrimes[p]) : r);
+                    }
+                }
+            }
+            trng_primeLap(ctx, &ctx->stats.timeSieve, &mark);
+        }
+
+        for (i = 0U; i < w; i++) {
+            out[i] = (result == TRNG_OK) ? ctx->n[i] : 0U;
+        }
+        /* The prime and its Montgomery constants stay only in out. */
+        trng_primeClear(ctx, w);
+        if (result == TRNG_OK) {
+            ctx->stats.primes++;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,189 @@
+/*******************************************************************************
+ * @file    trng_prime.h
+ * @brief   Random probable primes: incremental sieve and Miller-Rabin.
+ *
+ * trng_primeGenerate() finds a random prime of a given bit length, e.g. a
+ * factor of an RSA key:
+ * 1. a candidate is drawn in whole 128-bit hardware blocks, with its top
+ *    two bits and its low bit set (so that the product of two such primes
+ *    has exactly twice the bit length);
+ * 2. its residues modulo the first @c sievePrimes odd primes (up to 256,
+ *    3 to 1621) are computed once. The search then walks the odd numbers
+ *    candidate, candidate + 2, ... updating each residue with an add and
+ *    a conditional subtract, and skips every number with a zero residue
+ *    without any multi-precision work. A new candidate is drawn after
+ *    TRNG_PRIME_MAX_DELTA;
+ * 3. numbers that pass the sieve get Miller-Rabin rounds with Montgomery
+ *    arithmetic, witnesses uniform in [2, n - 2] drawn from a buffered
+ *    block in the context. Most composites fail the first round.
+ *
+ * Incremental search favours primes that follow long prime gaps slightly,
+ * as in OpenSSL; the result is still a uniformly drawn region of numbers.
+ *
+ * The context holds all the workspace (about 2 KiB at 1024 bits), so
+ * nothing large is on the stack. trng_primeGenerate() and
+ * trng_primeTest() zero the number workspace before they return, so the
+ * prime and its derived values are left only in the caller's output;
+ * trng_primeWipe() also clears the buffered witness bits, for when the
+ * context is done with. The context counts the candidates, sieve skips
+ * and rounds of each phase. With a clock function (micros() on the board,
+ * any monotonic counter on a host) it also times the phases: drawing and
+ * residues, sieving and Miller-Rabin.
+ *
+ * @code
+ *   #include <trng.h>
+ *   #include <trng_prime.h>
+ *
+ *   static trng_prime gen;
+ *   static uint32_t p[16];
+ *
+ *   static uint32_t now() { return micros(); }
+ *
+ *   void setup() {
+ *       TRNG.begin();
+ *       (void)trng_primeInit(&gen, TRNG_PRIME_SIEVE, now);
+ *       (void)trng_primeGenerate(&gen, p, 512U, 0U);
+ *       trng_primeWipe(&gen);
+ *       ... use p, then wipe it too
+ *   }
+ * @endcode
+ *
+ * Integers are arrays of 32-bit words, least significant word first. The
+ * only hardware dependency is trng_read128(), so the module builds on a
+ * host with any stand-in for it, including a deterministic one.
+ *
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_PRIME_H
+#define TRNG_PRIME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "trng.h"
+
+#ifndef TRNG_PRIME_MAX_BITS
+/** @brief Largest prime size in bits (multiple of 32); 1024 covers RSA-2048. */
+#define TRNG_PRIME_MAX_BITS     1024U
+#endif
+
+/** @brief Words of the largest prime. */
+#define TRNG_PRIME_MAX_WORDS    (TRNG_PRIME_MAX_BITS / 32U)
+
+/** @brief Number of odd primes in the sieve table (3 to 1621). */
+#define TRNG_PRIME_SIEVE        256U
+
+/** @brief Search distance after which a new candidate is drawn. */
+#define TRNG_PRIME_MAX_DELTA    65536U
+
+/** @brief Phase counters and times of a context. */
+typedef struct {
+    uint32_t candidates;    /**< Candidates drawn from the hardware. */
+    uint32_t sieved;        /**< Odd numbers skipped by the sieve. */
+    uint32_t tested;        /**< Numbers that reached Miller-Rabin. */
+    uint32_t rounds;        /**< Miller-Rabin rounds run. */
+    uint32_t primes;        /**< Primes found. */
+    uint32_t timeDraw;      /**< Clock ticks drawing candidates and computing residues. */
+    uint32_t timeSieve;     /**< Clock ticks in the incremental sieve. */
+    uint32_t timeTest;      /**< Clock ticks in Miller-Rabin. */
+} trng_primeStats;
+
+/** @brief Clock for the phase times, e.g. micros(). */
+typedef uint32_t (*trng_primeClock)(void);
+
+/** @brief Prime generator context and workspace. */
+typedef struct {
+    uint32_t base[TRNG_PRIME_MAX_WORDS];            /**< Current candidate. */
+    uint32_t n[TRNG_PRIME_MAX_WORDS];               /**< Number under test. */
+    uint32_t x[TRNG_PRIME_MAX_WORDS];               /**< Miller-Rabin accumulator. */
+    uint32_t a[TRNG_PRIME_MAX_WORDS];               /**< Witness, Montgomery form. */
+    uint32_t one[TRNG_PRIME_MAX_WORDS];             /**< R mod n. */
+    uint32_t minusOne[TRNG_PRIME_MAX_WORDS];        /**< -R mod n. */
+    uint32_t r2[TRNG_PRIME_MAX_WORDS];              /**< R^2 mod n. */
+    uint32_t t[TRNG_PRIME_MAX_WORDS + 2U];          /**< Montgomery product. */
+    uint16_t residues[TRNG_PRIME_SIEVE];            /**< base mod each sieve prime. */
+    uint32_t block[4U];                             /**< Buffered block for witnesses. */
+    uint8_t  blockPos;                              /**< Next unused word of @c block, 4 when empty. */
+    uint16_t sievePrimes;                           /**< Sieve primes used, 0 to TRNG_PRIME_SIEVE. */
+    trng_primeClock clock;                          /**< Phase clock, or NULL. */
+    trng_primeStats stats;                          /**< Counters since init or reset. */
+} trng_prime;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Initialize a context.
+ *
+ * @param[out] ctx          Context.
+ * @param      sievePrimes  Odd primes to sieve with, 0 (no sieve) to
+ *                          TRNG_PRIME_SIEVE.
+ * @param      clock        Clock for the phase times, or NULL for counts
+ *                          only.
+ *
+ * @retval  0   Success.
+ * @retval  1   Null pointer or @p sievePrimes too large.
+ */
+uint8_t trng_primeInit(trng_prime *ctx, uint16_t sievePrimes, trng_primeClock clock);
+
+/**
+ * @brief   Generate a random probable prime of exactly @p bits bits.
+ *
+ * @param      ctx     Context.
+ * @param[out] out     (bits + 31) / 32 words.
+ * @param      bits    Bit length, 64 to TRNG_PRIME_MAX_BITS. The top two
+ *                     bits are set.
+ * @param      rounds  Miller-Rabin rounds, 0 for trng_primeRounds(bits).
+ *
+ * The workspace in @p ctx is zeroed before returning, so the prime is
+ * left only in @p out.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, null pointer or bit length
+ *              out of range; @p out is zeroed.
+ */
+uint8_t trng_primeGenerate(trng_prime *ctx, uint32_t *out, uint32_t bits, uint32_t rounds);
+
+/**
+ * @brief   Test a number: trial division by the sieve primes, then
+ *          Miller-Rabin with random witnesses.
+ *
+ * @param      ctx      Context.
+ * @param      n        Number, @p words words.
+ * @param      words    1 to TRNG_PRIME_MAX_WORDS.
+ * @param      rounds   Miller-Rabin rounds, 0 for trng_primeRounds().
+ * @param[out] isPrime  1 if @p n is prime or a probable prime, else 0.
+ *
+ * The copy of @p n and the values derived from it in @p ctx are zeroed
+ * before returning.
+ *
+ * @retval  0   Success.
+ * @retval  1   Read failed, not initialized, null pointer or size out
+ *              of range.
+ */
+uint8_t trng_primeTest(trng_prime *ctx, const uint32_t *n, size_t words, uint32_t rounds, uint8_t *isPrime);
+
+/**
+ * @brief   Default Miller-Rabin rounds for random @p bits-bit candidates,
+ *          for an error below 2^-80 (Damgard, Landrock and Pomerance; the
+ *          table of OpenSSL's BN_prime_checks_for_size()).
+ */
+uint32_t trng_primeRounds(uint32_t bits);
+
+/**
+ * @brief   Wipe the workspace and the buffered witness block of a context
+ *          that is no longer needed. The counters and settings are kept,
+ *          so the context can be used again.
+ */
+void trng_primeWipe(trng_prime *ctx);
+
+/**
+ * @brief   Reset the counters and times.
+ */
+void trng_primeResetStats(trng_prime *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRNG_PRIME_H */
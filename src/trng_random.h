@@ -0,0 +1,121 @@
+/*******************************************************************************
+ * @file    trng_random.h
+ * @brief   Opt-in replacement of the Arduino random() functions by the TRNG.
+ *
+ * The core's random(max) and random(min, max) reduce the output of the C
+ * library's linear congruential generator modulo the range, and every
+ * library on the board calls them. Defining TRNG_REPLACE_RANDOM before
+ * including this header in exactly one .ino or .cpp file of a sketch
+ * replaces them for the whole program at link time:
+ *
+ * @code
+ *   #define TRNG_REPLACE_RANDOM
+ *   #include <trng_random.h>
+ *
+ *   void setup() {
+ *       TRNG.begin();
+ *       long die = random(1, 7);    // also inside every library
+ *   }
+ * @endcode
+ *
+ * The definitions below keep the core's signatures and results for every
+ * argument, but draw from trng_randomBounded(): only the bits the range
+ * needs come from the buffered reservoir, out-of-range values are redrawn
+ * instead of reduced modulo the range, and the SCE5 is read once per 128
+ * bits consumed. The C library's random() and srandom() are replaced too,
+ * so code calling random() directly gets 31 TRNG bits.
+ *
+ * The core defines random(), randomSeed(), map() and makeWord() in one
+ * module (WMath.cpp), which the linker would still pull in for map(). All
+ * of them are therefore defined here, map() and makeWord() with the
+ * core's own code, and the core module is never linked.
+ *
+ * @note    randomSeed() and srandom() are accepted and ignored: a TRNG
+ *          cannot replay a sequence. Code that seeds with a constant to get
+ *          a repeatable sequence should use trng_fast.h instead.
+ * @note    If the TRNG was not started, the first call starts it. Should
+ *          the hardware fail, random() returns 0 and random(min, max)
+ *          returns min.
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_RANDOM_H
+#define TRNG_RANDOM_H
+
+#include "trng.h"
+
+#if defined(__cplusplus) && defined(TRNG_REPLACE_RANDOM)
+
+/**
+ * @brief  Uniform value in [0, bound), 0 if the TRNG cannot be started.
+ */
+static uint32_t trng_arduinoBounded(uint32_t bound) {
+    uint32_t val = 0U;
+
+    if (trng_randomBounded(&val, bound) != TRNG_OK) {
+        if ((trng_begin() != TRNG_OK) || (trng_randomBounded(&val, bound) != TRNG_OK)) {
+            val = 0U;
+        }
+    }
+
+    return val;
+}
+
+/** @brief C library random(): 31 TRNG bits. */
+extern "C" long random(void) {
+    return (long)trng_arduinoBounded(0x80000000UL);
+}
+
+/** @brief C library srandom(): ignored. */
+extern "C" void srandom(unsigned int seed) {
+    (void)seed;
+}
+
+/** @brief Arduino randomSeed(): ignored. */
+void randomSeed(unsigned long seed) {
+    (void)seed;
+}
+
+/** @brief Arduino random(max): [0, |max|), 0 for max == 0. */
+long random(long howbig) {
+    long result = 0;
+
+    if (howbig != 0) {
+        /* As in the core, a negative bound gives [0, -howbig). */
+        uint32_t bound = (howbig < 0) ? (0U - (uint32_t)howbig) : (uint32_t)howbig;
+        result = (long)trng_arduinoBounded(bound);
+    }
+
+    return result;
+}
+
+/** @brief Arduino random(min, max): [min, max), min if min >= max. */
+long random(long howsmall, long howbig) {
+    long result = howsmall;
+
+    if (howsmall < howbig) {
+        /* Unsigned difference: no overflow for ranges wider than LONG_MAX. */
+        uint32_t diff = (uint32_t)howbig - (uint32_t)howsmall;
+        result = (long)((uint32_t)howsmall + trng_arduinoBounded(diff));
+    }
+
+    return result;
+}
+
+/** @brief Arduino map(), as in the core. */
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    return (((x - in_min) * (out_max - out_min)) / (in_max - in_min)) + out_min;
+}
+
+/** @brief Arduino makeWord(w), as in the core. */
+uint16_t makeWord(uint16_t w) {
+    return w;
+}
+
+/** @brief Arduino makeWord(h, l), as in the core. */
+uint16_t makeWord(uint8_t h, uint8_t l) {
+    return (uint16_t)((h << 8) | l);
+}
+
+#endif /* __cplusplus && TRNG_REPLACE_RANDOM */
+
+#endif /* TRNG_RANDOM_H */
@@ -0,0 +1,239 @@
+/*******************************************************************************
+ * @file    trng_random_device.h
+ * @brief   std::random_device-compatible adaptor for the hardware TRNG.
+ *
+ * trng::random_device has the interface of std::random_device, so generic
+ * C++ code (distributions, seed_seq, shuffles) can draw from the SCE5:
+ *
+ * @code
+ *   #include <random>
+ *   #include <trng_random_device.h>
+ *
+ *   trng::random_device rd;
+ *   std::uniform_int_distribution<int> die(1, 6);
+ *   int roll = die(rd);
+ * @endcode
+ *
+ * operator() serves words from a prefetch buffer of TRNG_DEVICE_BUFFER
+ * words, refilled TRNG_DEVICE_BUFFER / 4 hardware blocks at a time, so the
+ * hardware is not read on every call. Each refill of 256 bytes or more is
+ * checked with trng_frameHealth(), the repetition count and adaptive
+ * proportion tests of the export frames; a buffer that fails is discarded
+ * and read again.
+ *
+ * entropy() reports, in bits per result (0 to 32), one of:
+ * - "estimate" (default): an SP 800-90B most-common-value estimate over
+ *   the bytes of the last TRNG_DEVICE_WINDOW refilled bytes, at 99%
+ *   confidence, so it converges to just under 32 on healthy output; 0
+ *   until the first window is complete;
+ * - "health": 32 if the last refill passed the health tests at the first
+ *   read, else 0;
+ * - "full": always 32, the vendor's full-entropy claim for the
+ *   conditioned output.
+ * Select it with the token constructor, e.g. random_device("health").
+ *
+ * @note    Exceptions are usually disabled on the board, so failures are
+ *          not thrown as std::random_device would. If a hardware read
+ *          fails, e.g. because the call preempted another read in an
+ *          interrupt, operator() returns 0 for that call, counts it in
+ *          readFailures() and reads again on the next call; entropy()
+ *          reports 0 until a read succeeds. If four
+ *          buffers in a row fail the health tests, failed() becomes true
+ *          for good, operator() returns 0 from then on and entropy()
+ *          reports 0. Start the TRNG with TRNG.begin() first.
+ * @note    Not thread-safe; one instance per thread or task.
+ * @license LGPL-3.0
+ ******************************************************************************/
+#ifndef TRNG_RANDOM_DEVICE_H
+#define TRNG_RANDOM_DEVICE_H
+
+#include "trng.h"
+
+#ifdef __cplusplus
+
+#include <math.h>
+#include <string.h>
+
+#ifndef TRNG_DEVICE_BUFFER
+/** @brief Prefetch buffer size in 32-bit words (multiple of 4, 64 = one health window). */
+#define TRNG_DEVICE_BUFFER  64U
+#endif
+
+#ifndef TRNG_DEVICE_WINDOW
+/** @brief Bytes per entropy estimate (at most 65535). */
+#define TRNG_DEVICE_WINDOW  65535U
+#endif
+
+namespace trng {
+
+/**
+ * @class   random_device
+ * @brief   Uniform random bit generator reading the SCE5 through a buffer.
+ */
+class random_device {
+public:
+    typedef unsigned int result_type;
+
+    /** @brief Source of the entropy() report. */
+    enum entropy_report { estimate, health, full };
+
+    /** @brief Device with an estimated entropy() report. */
+    random_device() : random_device(estimate) {}
+
+    /** @brief Device with the given entropy() report. */
+    explicit random_device(entropy_report report) : _report(report) {}
+
+    /** @brief Device selected by token: "estimate", "health" or "full"; others give "estimate". */
+    explicit random_device(const char *token) : _report(estimate) {
+        if (token != nullptr) {
+            if (strcmp(token, "health") == 0) {
+                _report = health;
+            } else if (strcmp(token, "full") == 0) {
+                _report = full;
+            }
+        }
+    }
+
+    random_device(const random_device &) = delete;
+    random_device &operator=(const random_device &) = delete;
+
+    /** @brief Wipe the unread words. */
+    ~random_device() {
+        for (uint32_t i = 0U; i < TRNG_DEVICE_BUFFER; i++) {
+            _buf[i] = 0U;
+        }
+    }
+
+    static constexpr result_type min() { return 0U; }
+    static constexpr result_type max() { return 0xFFFFFFFFU; }
+
+    /** @brief Next 32-bit value, 0 if the read failed or the device has failed(). */
+    result_type operator()() {
+        result_type result = 0U;
+
+        if ((_pos < TRNG_DEVICE_BUFFER) || refill()) {
+            result = (result_type)_buf[_pos];
+            _buf[_pos] = 0U;
+            _pos++;
+        }
+
+        return result;
+    }
+
+    /** @brief Entropy per result in bits, as selected at construction. */
+    double entropy() const noexcept {
+        double bits = 0.0;
+
+        if ((!_failed) && (!_readFailed)) {
+            if (_report == full) {
+                bits = 32.0;
+            } else if (_report == health) {
+                bits = _lastHealthy ? 32.0 : 0.0;
+            } else {
+                bits = _estimate;
+            }
+        }
+
+        return bits;
+    }
+
+    /** @brief true once four buffers in a row failed the health tests. */
+    bool failed() const { return _failed; }
+
+    /** @brief Refills discarded by the health tests. */
+    uint32_t healthFailures() const { return _healthFailures; }
+
+    /** @brief Calls that returned 0 because a hardware read failed. */
+    uint32_t readFailures() const { return _readFailures; }
+
+private:
+    static_assert((TRNG_DEVICE_BUFFER % 4U) == 0U, "TRNG_DEVICE_BUFFER must be a multiple of 4");
+    static_assert(TRNG_DEVICE_WINDOW <= 65535U, "TRNG_DEVICE_WINDOW must fit the uint16_t counts");
+
+    /** @brief Retries of a refill rejected by the health tests. */
+    static const uint8_t kHealthRetries = 3U;
+
+    /**
+     * @brief  Read a new buffer, discarding buffers that fail the health
+     *         tests, and feed the estimator. A failed read is not
+     *         latched: the next call tries again.
+     * @return true if the buffer is ready.
+     */
+    bool refill() {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(_buf);
+        bool ok = false;
+        bool read = true;
+
+        for (uint8_t attempt = 0U; (!ok) && read && (!_failed) && (attempt <= kHealthRetries); attempt++) {
+            for (uint32_t w = 0U; read && (w < TRNG_DEVICE_BUFFER); w += 4U) {
+                read = (trng_read128(&_buf[w]) == TRNG_OK);
+            }
+            if (!read) {
+                _readFailures++;
+            } else if ((TRNG_DEVICE_BUFFER >= 64U) && (trng_frameHealth(bytes, TRNG_DEVICE_BUFFER * 4U) != 0U)) {
+                _healthFailures++;
+            } else {
+                ok = true;
+                _lastHealthy = (attempt == 0U);
+            }
+        }
+        _readFailed = !read;
+        if (ok) {
+            if (_report == estimate) {
+                observe(bytes, TRNG_DEVICE_BUFFER * 4U);
+            }
+            _pos = 0U;
+        } else {
+            for (uint32_t i = 0U; i < TRNG_DEVICE_BUFFER; i++) {
+                _buf[i] = 0U;
+            }
+            /* Only a persistent health failure disables the device. */
+            if (read) {
+                _failed = true;
+            }
+        }
+
+        return ok;
+    }
+
+    /**
+     * @brief  Count byte values; at the end of each window, update the
+     *         most-common-value estimate (SP 800-90B, 6.3.1).
+     */
+    void observe(const uint8_t *bytes, uint32_t len) {
+        for (uint32_t i = 0U; i < len; i++) {
+            _counts[bytes[i]]++;
+            _samples++;
+            if (_samples == TRNG_DEVICE_WINDOW) {
+                uint16_t top = 0U;
+                for (uint32_t v = 0U; v < 256U; v++) {
+                    top = (_counts[v] > top) ? _counts[v] : top;
+                    _counts[v] = 0U;
+                }
+                double n = (double)_samples;
+                double p = (double)top / n;
+                double pu = p + (2.576 * sqrt((p * (1.0 - p)) / (n - 1.0)));
+                pu = (pu > 1.0) ? 1.0 : pu;
+                _estimate = -log2(pu) * 4.0;
+                _samples = 0U;
+            }
+        }
+    }
+
+    uint32_t _buf[TRNG_DEVICE_BUFFER] = {};
+    uint32_t _pos = TRNG_DEVICE_BUFFER;
+    entropy_report _report;
+    bool _failed = false;
+    bool _readFailed = false;
+    bool _lastHealthy = true;
+    uint32_t _healthFailures = 0U;
+    uint32_t _readFailures = 0U;
+    uint16_t _counts[256U] = {};
+    uint16_t _samples = 0U;
+    double _estimate = 0.0;
+};
+
+} /* namespace trng */
+
+#endif /* __cplusplus */
+#endif /* TRNG_RANDOM_DEVICE_H */